@@ -0,0 +1,369 @@
+#include "AssetPack.hpp"
+#include "TextureCache.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+const std::string assetRootDir = "src/assets/";
+
+AssetPack assetPack;
+
+namespace {
+
+const char packMagic[8] = {'F', 'S', 'A', 'S', 'S', 'E', 'T', '\0'};
+
+// LZ4 block format: a match is at least 4 bytes and at most 64 KB back, the last 5 bytes are always
+// literals and no match starts within the last 12 bytes
+const size_t lz4MinMatch = 4;
+const size_t lz4LastLiterals = 5;
+const size_t lz4MatchStartLimit = 12;
+const size_t lz4MaxOffset = 65535;
+const uint32_t lz4HashBits = 16;
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t tocOffset;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(AssetPackEntry) == 56, "AssetPackEntry is stored as is");
+
+struct PackSource {
+    std::string path;
+    std::vector<uint8_t> stored;
+    AssetPackEntry entry;
+};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+uint32_t read32(const uint8_t *bytes) {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+// Length continuation: 255 while at least that much is left, then the remainder
+void writeLength(std::vector<uint8_t> &out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+// One sequence: literals followed by a match; matchLength 0 is the closing literal-only sequence
+void writeSequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literalLength, size_t offset,
+                   size_t matchLength) {
+    size_t matchCode = matchLength > 0 ? matchLength - lz4MinMatch : 0;
+    out.push_back(static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4 | std::min<size_t>(matchCode, 15)));
+    if (literalLength >= 15) writeLength(out, literalLength - 15);
+    out.insert(out.end(), literals, literals + literalLength);
+    if (matchLength == 0) return;
+    out.push_back(static_cast<uint8_t>(offset & 0xff));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+bool readLength(const uint8_t *&in, const uint8_t *end, size_t &length) {
+    uint8_t byte;
+    do {
+        if (in == end) return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+std::string normalizedAssetPath(const std::string &path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+// Read, stamp and (when it pays) compress one loose file
+bool loadPackSource(const std::string &path, PackSource &source) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open: " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    source.path = normalizedAssetPath(path);
+    source.entry = {};
+    source.entry.pathHash = hashAssetPath(source.path);
+    source.entry.size = bytes.size();
+    if (!sourceStamp(path, source.entry.sourceSize, source.entry.sourceTime)) {
+        std::cerr << "Cannot stat: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> compressed = lz4Compress(bytes.data(), bytes.size());
+    if (compressed.size() <= bytes.size() * (1.0 - ASSET_PACK_MIN_SAVING)) {
+        source.entry.compression = ASSET_LZ4;
+        source.stored = std::move(compressed);
+    } else {
+        source.entry.compression = ASSET_STORED;
+        source.stored = std::move(bytes);
+    }
+    source.entry.storedSize = source.stored.size();
+    return true;
+}
+
+bool validatePack(const AssetPack &pack) {
+    PackHeader header;
+    if (pack.file.size < sizeof(header)) return false;
+    std::memcpy(&header, pack.file.data, sizeof(header));
+    if (std::memcmp(header.magic, packMagic, sizeof(packMagic)) != 0 || header.version != ASSET_PACK_VERSION) {
+        return false;
+    }
+    if (header.tocOffset % alignof(AssetPackEntry) != 0 || header.tocOffset > pack.file.size
+        || header.entryCount > (pack.file.size - header.tocOffset) / sizeof(AssetPackEntry)) {
+        return false;
+    }
+
+    const AssetPackEntry *entries = reinterpret_cast<const AssetPackEntry *>(pack.file.data + header.tocOffset);
+    uint64_t blobsStart = header.tocOffset + static_cast<uint64_t>(header.entryCount) * sizeof(AssetPackEntry);
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        const AssetPackEntry &entry = entries[i];
+        if (i > 0 && entry.pathHash <= entries[i - 1].pathHash) return false;
+        if (entry.offset < blobsStart || entry.offset > pack.file.size
+            || entry.storedSize > pack.file.size - entry.offset) {
+            return false;
+        }
+        if (entry.compression == ASSET_STORED ? entry.storedSize != entry.size : entry.compression != ASSET_LZ4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+/**
+ * hashAssetPath: 64-bit FNV-1a of the normalised path, the key of the pack's table of contents
+ */
+uint64_t hashAssetPath(const std::string &path) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : normalizedAssetPath(path)) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * lz4Compress: Compress into the LZ4 block format with a greedy single-probe hash table
+ * Fast rather than tight; the packer keeps the stored bytes when this doesn't save enough.
+ */
+std::vector<uint8_t> lz4Compress(const uint8_t *source, size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(size + size / 255 + 16);
+    size_t anchor = 0;
+
+    if (size > lz4MatchStartLimit) {
+        std::vector<uint32_t> table(size_t(1) << lz4HashBits, UINT32_MAX);
+        size_t matchEnd = size - lz4LastLiterals;
+        size_t position = 0;
+        while (position + lz4MatchStartLimit <= size) {
+            uint32_t sequence = read32(source + position);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - lz4HashBits);
+            uint32_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(position);
+
+            if (candidate == UINT32_MAX || position - candidate > lz4MaxOffset || read32(source + candidate) != sequence) {
+                position++;
+                continue;
+            }
+            size_t length = lz4MinMatch;
+            while (position + length < matchEnd && source[candidate + length] == source[position + length]) length++;
+            writeSequence(out, source + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+    }
+    writeSequence(out, source + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+/**
+ * lz4Decompress: Decode an LZ4 block into exactly size bytes, rejecting anything that would read or write out of bounds
+ */
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t size) {
+    const uint8_t *in = source;
+    const uint8_t *inEnd = source + sourceSize;
+    uint8_t *out = destination;
+    uint8_t *outEnd = destination + size;
+
+    while (in < inEnd) {
+        uint8_t token = *in++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, inEnd, literalLength)) return false;
+        if (literalLength > static_cast<size_t>(inEnd - in) || literalLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+        if (literalLength > 0) std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+        if (in == inEnd) break;
+
+        if (inEnd - in < 2) return false;
+        size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - destination)) return false;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength)) return false;
+        matchLength += lz4MinMatch;
+        if (matchLength > static_cast<size_t>(outEnd - out)) return false;
+        // Byte by byte: a match may overlap the bytes it is producing
+        const uint8_t *match = out - offset;
+        for (size_t i = 0; i < matchLength; i++) out[i] = match[i];
+        out += matchLength;
+    }
+    return out == outEnd;
+}
+
+/**
+ * buildAssetPack: Pack every file under rootDir into one archive: header, table of contents sorted by
+ * path hash, then each blob on an ASSET_PACK_ALIGNMENT boundary, LZ4-compressed when that pays
+ */
+bool buildAssetPack(const std::string &packPath, const std::string &rootDir) {
+    std::error_code ec;
+    std::vector<std::string> paths;
+    for (auto it = std::filesystem::recursive_directory_iterator(rootDir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec)) paths.push_back(it->path().string());
+    }
+    if (ec || paths.empty()) {
+        std::cerr << "No assets found under " << rootDir << std::endl;
+        return false;
+    }
+
+    std::vector<PackSource> sources(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!loadPackSource(paths[i], sources[i])) return false;
+    }
+    std::sort(sources.begin(), sources.end(), [](const PackSource &a, const PackSource &b) {
+        return a.entry.pathHash < b.entry.pathHash;
+    });
+    for (size_t i = 1; i < sources.size(); i++) {
+        if (sources[i].entry.pathHash == sources[i - 1].entry.pathHash) {
+            std::cerr << "Asset path hash collision: " << sources[i - 1].path << " and " << sources[i].path << std::endl;
+            return false;
+        }
+    }
+
+    PackHeader header = {};
+    std::memcpy(header.magic, packMagic, sizeof(packMagic));
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(sources.size());
+    header.tocOffset = alignUp(sizeof(header));
+    uint64_t offset = alignUp(header.tocOffset + sources.size() * sizeof(AssetPackEntry));
+    uint64_t sourceBytes = 0;
+    for (PackSource &source : sources) {
+        source.entry.offset = offset;
+        offset = alignUp(offset + source.entry.storedSize);
+        sourceBytes += source.entry.size;
+    }
+
+    std::ofstream file(packPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Cannot write " << packPath << std::endl;
+        return false;
+    }
+    const char padding[ASSET_PACK_ALIGNMENT] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(padding, static_cast<std::streamsize>(header.tocOffset - sizeof(header)));
+    for (const PackSource &source : sources) {
+        file.write(reinterpret_cast<const char *>(&source.entry), sizeof(source.entry));
+    }
+    for (const PackSource &source : sources) {
+        file.write(padding, static_cast<std::streamsize>(source.entry.offset - static_cast<uint64_t>(file.tellp())));
+        file.write(reinterpret_cast<const char *>(source.stored.data()), static_cast<std::streamsize>(source.stored.size()));
+    }
+    file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+    if (!file) {
+        std::cerr << "Cannot write " << packPath << std::endl;
+        return false;
+    }
+
+    for (const PackSource &source : sources) {
+        std::cout << "  " << source.path << ": " << source.entry.size << " bytes"
+                  << (source.entry.compression == ASSET_LZ4 ? ", LZ4 " + std::to_string(source.entry.storedSize) : std::string(", stored"))
+                  << std::endl;
+    }
+    std::cout << "Asset pack: " << sources.size() << " files, " << sourceBytes << " bytes packed into " << offset
+              << " bytes at " << packPath << std::endl;
+    return true;
+}
+
+/**
+ * openAssetPack: Map a pack and check its header and table of contents; entries are then read in place
+ */
+bool openAssetPack(const std::string &packPath) {
+    closeAssetPack();
+    if (!mapFile(packPath, assetPack.file)) return false;
+    if (!validatePack(assetPack)) {
+        std::cerr << "Not a valid asset pack: " << packPath << std::endl;
+        closeAssetPack();
+        return false;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, assetPack.file.data, sizeof(header));
+    assetPack.path = packPath;
+    assetPack.entries = reinterpret_cast<const AssetPackEntry *>(assetPack.file.data + header.tocOffset);
+    assetPack.entryCount = header.entryCount;
+    LOG_INFO("Asset pack: {} entries, {} bytes mapped from {}", assetPack.entryCount, assetPack.file.size, packPath);
+    return true;
+}
+
+/**
+ * closeAssetPack: Unmap the pack; views into it must no longer be in use
+ */
+void closeAssetPack() {
+    unmapFile(assetPack.file);
+    assetPack = AssetPack();
+}
+
+/**
+ * findPackedAsset: The pack's entry for a path, or nullptr when no pack is open or it doesn't hold the path
+ */
+const AssetPackEntry *findPackedAsset(const std::string &path) {
+    if (assetPack.entryCount == 0) return nullptr;
+    uint64_t hash = hashAssetPath(path);
+    const AssetPackEntry *end = assetPack.entries + assetPack.entryCount;
+    const AssetPackEntry *entry = std::lower_bound(assetPack.entries, end, hash,
+        [](const AssetPackEntry &e, uint64_t value) { return e.pathHash < value; });
+    return entry != end && entry->pathHash == hash ? entry : nullptr;
+}
+
+/**
+ * readPackedAsset: View a packed asset's bytes; false when it isn't packed (callers then read the loose file)
+ * Stored entries are viewed in place without copying. Safe from any thread while the pack is open.
+ */
+bool readPackedAsset(const std::string &path, AssetView &view) {
+    const AssetPackEntry *entry = findPackedAsset(path);
+    if (!entry) return false;
+
+    const uint8_t *stored = assetPack.file.data + entry->offset;
+    if (entry->compression == ASSET_STORED) {
+        view.data = stored;
+        view.size = entry->size;
+        return true;
+    }
+    view.decompressed.resize(entry->size);
+    if (!lz4Decompress(stored, entry->storedSize, view.decompressed.data(), view.decompressed.size())) {
+        LOG_ERROR("Corrupt LZ4 data for {} in {}", path, assetPack.path);
+        view.decompressed.clear();
+        return false;
+    }
+    view.data = view.decompressed.data();
+    view.size = view.decompressed.size();
+    return true;
+}
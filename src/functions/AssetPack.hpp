@@ -0,0 +1,68 @@
+#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+
+const uint32_t ASSET_PACK_VERSION = 1;
+const uint64_t ASSET_PACK_ALIGNMENT = 64;
+// Entries are only stored compressed when that saves at least this fraction of their size
+const double ASSET_PACK_MIN_SAVING = 0.1;
+
+extern const std::string assetRootDir;
+
+enum AssetCompression : uint32_t {
+    ASSET_STORED = 0,
+    ASSET_LZ4 = 1
+};
+
+// Table of contents entry, sorted by pathHash. Only the hash of the path is kept; the source size and
+// modification time let caches keyed on the loose file (the texture cache) stay valid when reading the pack
+struct AssetPackEntry {
+    uint64_t pathHash;
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t size;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+// Bytes of one asset: a view straight into the mapping for stored entries, or into decompressed for LZ4 ones.
+// Moving keeps data valid (the vector's buffer moves with it); copying would not, so it is disallowed
+struct AssetView {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> decompressed;
+
+    AssetView() = default;
+    AssetView(AssetView &&) = default;
+    AssetView &operator=(AssetView &&) = default;
+    AssetView(const AssetView &) = delete;
+    AssetView &operator=(const AssetView &) = delete;
+};
+
+// The pack opened with --asset-pack: header, table of contents and blobs in one read-only mapping
+struct AssetPack {
+    MappedFile file;
+    std::string path;
+    const AssetPackEntry *entries = nullptr;
+    uint32_t entryCount = 0;
+};
+
+extern AssetPack assetPack;
+
+uint64_t hashAssetPath(const std::string &path);
+std::vector<uint8_t> lz4Compress(const uint8_t *source, size_t size);
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t size);
+bool buildAssetPack(const std::string &packPath, const std::string &rootDir);
+bool openAssetPack(const std::string &packPath);
+void closeAssetPack();
+const AssetPackEntry *findPackedAsset(const std::string &path);
+bool readPackedAsset(const std::string &path, AssetView &view);
+
+#endif
@@ -0,0 +1,63 @@
+#include "Benchmark.hpp"
+#include "MainFunctions.hpp"
+#include <algorithm>
+#include <iostream>
+
+Benchmark benchmark;
+
+namespace {
+
+const float orbitDegreesPerFrame = 0.5f;
+const float cruiseSpeed = 2.0f;
+
+double percentile(const std::vector<double> &sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}
+
+/**
+ * startBenchmark: Reset the recorded frame times for a run on the named backend
+ */
+void startBenchmark(const std::string &backend, int width, int height, uint32_t frames) {
+    benchmark = Benchmark();
+    benchmark.backend = backend;
+    benchmark.width = width;
+    benchmark.height = height;
+    benchmark.frameMs.reserve(frames);
+}
+
+/**
+ * scriptBenchmarkFrame: Deterministic flight for a frame: orbit the camera while cruising forward
+ */
+void scriptBenchmarkFrame(uint32_t frame) {
+    camera.rotationX = 20.0f;
+    camera.rotationY = static_cast<float>(frame) * orbitDegreesPerFrame;
+    planeState().speed = cruiseSpeed;
+}
+
+/**
+ * recordBenchmarkFrame: Add one frame's render time (CPU submission through finished rendering)
+ */
+void recordBenchmarkFrame(double frameMs) {
+    benchmark.frameMs.push_back(frameMs);
+}
+
+/**
+ * reportBenchmark: Print average and percentile frame times for the run
+ */
+void reportBenchmark() {
+    if (benchmark.frameMs.empty()) return;
+
+    std::vector<double> sorted = benchmark.frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : sorted) total += ms;
+    double average = total / sorted.size();
+
+    std::cout << "Benchmark (" << benchmark.backend << ", " << benchmark.width << "x" << benchmark.height << "): "
+              << sorted.size() << " frames, avg " << average << " ms (" << 1000.0 / average << " fps)"
+              << " | p50 " << percentile(sorted, 0.50) << " ms | p95 " << percentile(sorted, 0.95)
+              << " ms | p99 " << percentile(sorted, 0.99) << " ms | max " << sorted.back() << " ms" << std::endl;
+}
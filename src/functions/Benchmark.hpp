@@ -0,0 +1,25 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scripted runs always build the same world so frames and captures are comparable between runs
+const unsigned BENCHMARK_WORLD_SEED = 1;
+
+// Per-frame render times of a fixed-step run, reported as percentiles at the end
+struct Benchmark {
+    std::string backend;
+    int width = 0, height = 0;
+    std::vector<double> frameMs;
+};
+
+extern Benchmark benchmark;
+
+void startBenchmark(const std::string &backend, int width, int height, uint32_t frames);
+void scriptBenchmarkFrame(uint32_t frame);
+void recordBenchmarkFrame(double frameMs);
+void reportBenchmark();
+
+#endif
@@ -0,0 +1,311 @@
+#include "Capture.hpp"
+#include "MemoryTracker.hpp"
+#include "Renderer.hpp"
+#include "SoftwareRenderer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+FrameCapture frameCapture;
+
+namespace {
+
+// Per-pixel YIQ color distance threshold (as a fraction of the largest possible distance)
+const double pixelThreshold = 0.1;
+const double maxYiqDelta = 35215.0;
+
+std::string frameFileName(uint32_t frame) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05u", frame);
+    return name;
+}
+
+// Perceptual distance between two RGB colors, weighting brightness over chroma
+double yiqDelta(const uint8_t *a, const uint8_t *b) {
+    double dr = static_cast<double>(a[0]) - b[0];
+    double dg = static_cast<double>(a[1]) - b[1];
+    double db = static_cast<double>(a[2]) - b[2];
+    double y = dr * 0.29889531 + dg * 0.58662247 + db * 0.11448223;
+    double i = dr * 0.59597799 - dg * 0.27417610 - db * 0.32180189;
+    double q = dr * 0.21147017 - dg * 0.52261711 + db * 0.31114694;
+    return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+// GL reads the bottom row first; captures and PPM files store the top row first
+CaptureImage imageFromRgba(uint32_t frame, int width, int height, const uint8_t *rgba) {
+    CaptureImage image;
+    image.frame = frame;
+    image.width = width;
+    image.height = height;
+    image.rgb.resize(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; y++) {
+        const uint8_t *src = rgba + static_cast<size_t>(height - 1 - y) * width * 4;
+        uint8_t *dst = image.rgb.data() + static_cast<size_t>(y) * width * 3;
+        for (int x = 0; x < width; x++) {
+            dst[x * 3 + 0] = src[x * 4 + 0];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+    return image;
+}
+
+// Write the capture, then either refresh its golden image or compare against it
+void storeCapture(const CaptureImage &image) {
+    FrameCapture &capture = frameCapture;
+    std::string name = frameFileName(image.frame);
+    if (writePpm(capture.outputDir + "/" + name + ".ppm", image)) capture.written++;
+    if (capture.goldenDir.empty()) return;
+
+    std::string goldenPath = capture.goldenDir + "/" + name + ".ppm";
+    if (capture.updateGolden) {
+        writePpm(goldenPath, image);
+        return;
+    }
+
+    CaptureImage golden;
+    capture.compared++;
+    if (!readPpm(goldenPath, golden)) {
+        std::cerr << "Golden image missing or unreadable: " << goldenPath << std::endl;
+        capture.failed++;
+        return;
+    }
+
+    CaptureImage diff;
+    double percent = compareImages(image, golden, &diff);
+    bool passed = percent >= 0.0 && percent <= capture.tolerancePercent;
+    if (!passed) {
+        capture.failed++;
+        writePpm(capture.outputDir + "/" + name + "_diff.ppm", diff);
+    }
+    std::cout << "Capture " << name << ": ";
+    if (percent < 0.0) {
+        std::cout << "size mismatch with golden image, FAILED" << std::endl;
+    } else {
+        std::cout << percent << "% of pixels differ (tolerance " << capture.tolerancePercent << "%), "
+                  << (passed ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+// Map a finished readback into a capture and release its fence
+void resolveReadback(const PendingReadback &readback) {
+    FrameCapture &capture = frameCapture;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    size_t bytes = static_cast<size_t>(capture.width) * capture.height * 4;
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (pixels) {
+        capture.ready.push_back(imageFromRgba(readback.frame, capture.width, capture.height,
+                                              static_cast<const uint8_t *>(pixels)));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cerr << "Failed to map readback buffer for frame " << readback.frame << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteSync(readback.fence);
+}
+
+}
+
+/**
+ * writePpm: Save an image as binary PPM (P6)
+ */
+bool writePpm(const std::string &path, const CaptureImage &image) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot write image: " << path << std::endl;
+        return false;
+    }
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char *>(image.rgb.data()), image.rgb.size());
+    return static_cast<bool>(file);
+}
+
+/**
+ * readPpm: Load a binary PPM (P6, 8-bit) written by writePpm or an image tool
+ */
+bool readPpm(const std::string &path, CaptureImage &image) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::string magic;
+    int maxValue = 0;
+    file >> magic;
+    auto skipComments = [&]() {
+        file >> std::ws;
+        while (file.peek() == '#') {
+            std::string line;
+            std::getline(file, line);
+            file >> std::ws;
+        }
+    };
+    skipComments();
+    file >> image.width;
+    skipComments();
+    file >> image.height;
+    skipComments();
+    file >> maxValue;
+    if (magic != "P6" || maxValue != 255 || image.width <= 0 || image.height <= 0) return false;
+    file.get();
+
+    image.rgb.resize(static_cast<size_t>(image.width) * image.height * 3);
+    file.read(reinterpret_cast<char *>(image.rgb.data()), image.rgb.size());
+    return static_cast<bool>(file);
+}
+
+/**
+ * compareImages: Percentage of pixels whose perceptual color difference exceeds the threshold
+ * Returns -1 when the sizes differ. diff, when given, gets the failing pixels in red over a dimmed golden.
+ */
+double compareImages(const CaptureImage &image, const CaptureImage &golden, CaptureImage *diff) {
+    if (image.width != golden.width || image.height != golden.height) return -1.0;
+
+    if (diff) {
+        *diff = golden;
+        diff->frame = image.frame;
+    }
+
+    double limit = maxYiqDelta * pixelThreshold * pixelThreshold;
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    size_t different = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        const uint8_t *a = image.rgb.data() + i * 3;
+        const uint8_t *b = golden.rgb.data() + i * 3;
+        bool differs = yiqDelta(a, b) > limit;
+        if (differs) different++;
+        if (!diff) continue;
+
+        uint8_t *out = diff->rgb.data() + i * 3;
+        if (differs) {
+            out[0] = 255;
+            out[1] = 0;
+            out[2] = 0;
+        } else {
+            uint8_t gray = static_cast<uint8_t>((b[0] * 77 + b[1] * 150 + b[2] * 29) >> 10);
+            out[0] = out[1] = out[2] = gray;
+        }
+    }
+    return 100.0 * static_cast<double>(different) / static_cast<double>(pixels);
+}
+
+/**
+ * initFrameCapture: Take the capture settings from options and create the readback buffers
+ */
+bool initFrameCapture(const Options &options, int width, int height) {
+    MemoryScope scope(MEMORY_RECORDER);
+    FrameCapture &capture = frameCapture;
+    capture.frames = options.captureFrames;
+    std::sort(capture.frames.begin(), capture.frames.end());
+    capture.outputDir = options.captureDir;
+    capture.goldenDir = options.goldenDir;
+    capture.updateGolden = options.updateGolden;
+    capture.tolerancePercent = options.tolerancePercent;
+    capture.width = width;
+    capture.height = height;
+    if (capture.frames.empty()) return true;
+
+    std::error_code error;
+    std::filesystem::create_directories(capture.outputDir, error);
+    if (!capture.goldenDir.empty() && capture.updateGolden) std::filesystem::create_directories(capture.goldenDir, error);
+    if (error) {
+        std::cerr << "Cannot create capture directory: " << error.message() << std::endl;
+        return false;
+    }
+
+    if (renderer.backend == BACKEND_OPENGL) {
+        glGenBuffers(CAPTURE_PBO_COUNT, capture.pbos);
+        for (GLuint pbo : capture.pbos) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<size_t>(width) * height * 4, nullptr, GL_STREAM_READ);
+            trackGpuMemory(GPU_BUFFER, pbo, MEMORY_RECORDER, static_cast<size_t>(width) * height * 4);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    std::cout << "Capture: " << capture.frames.size() << " frames into " << capture.outputDir;
+    if (!capture.goldenDir.empty()) {
+        std::cout << (capture.updateGolden ? ", updating golden images in " : ", comparing against ")
+                  << capture.goldenDir;
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+/**
+ * captureRequested: True when the scripted run should capture this frame
+ */
+bool captureRequested(uint32_t frame) {
+    return std::binary_search(frameCapture.frames.begin(), frameCapture.frames.end(), frame);
+}
+
+/**
+ * captureFrame: Queue a copy of the finished frame (call after endFrame, before swapping)
+ * On GL the copy goes into a pixel pack buffer and is read back frames later without stalling.
+ */
+void captureFrame(uint32_t frame) {
+    MemoryScope scope(MEMORY_RECORDER);
+    FrameCapture &capture = frameCapture;
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        capture.ready.push_back(imageFromRgba(frame, softwareRenderer.width, softwareRenderer.height,
+                                              reinterpret_cast<const uint8_t *>(softwareRenderer.color.data())));
+        return;
+    }
+
+    // Every buffer in flight: the oldest readback has to finish first
+    if (capture.pending.size() == CAPTURE_PBO_COUNT) {
+        PendingReadback oldest = capture.pending.front();
+        capture.pending.pop_front();
+        glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        resolveReadback(oldest);
+    }
+
+    GLuint pbo = capture.pbos[capture.nextPbo];
+    capture.nextPbo = (capture.nextPbo + 1) % CAPTURE_PBO_COUNT;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, capture.width, capture.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture.pending.push_back({frame, pbo, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+}
+
+/**
+ * processFrameCaptures: Resolve readbacks whose fences have signaled and write finished captures
+ * With flush, waits for everything still in flight.
+ */
+void processFrameCaptures(bool flush) {
+    MemoryScope scope(MEMORY_RECORDER);
+    FrameCapture &capture = frameCapture;
+    while (!capture.pending.empty()) {
+        PendingReadback readback = capture.pending.front();
+        GLenum status = glClientWaitSync(readback.fence, flush ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         flush ? GL_TIMEOUT_IGNORED : 0);
+        if (status == GL_TIMEOUT_EXPIRED) break;
+        capture.pending.pop_front();
+        resolveReadback(readback);
+    }
+
+    for (const CaptureImage &image : capture.ready) storeCapture(image);
+    capture.ready.clear();
+}
+
+/**
+ * finishFrameCapture: Flush outstanding captures, release the buffers and print a summary
+ * Returns false when any comparison against the golden images failed.
+ */
+bool finishFrameCapture() {
+    FrameCapture &capture = frameCapture;
+    if (capture.frames.empty()) return true;
+
+    processFrameCaptures(true);
+    for (GLuint pbo : capture.pbos) releaseGpuMemory(GPU_BUFFER, pbo);
+    if (capture.pbos[0]) glDeleteBuffers(CAPTURE_PBO_COUNT, capture.pbos);
+    std::fill(capture.pbos, capture.pbos + CAPTURE_PBO_COUNT, 0);
+
+    std::cout << "Capture: " << capture.written << " of " << capture.frames.size() << " frames written";
+    if (capture.compared > 0) {
+        std::cout << ", " << capture.compared - capture.failed << " of " << capture.compared << " match the golden images";
+    }
+    std::cout << std::endl;
+    return capture.failed == 0;
+}
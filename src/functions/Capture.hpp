@@ -0,0 +1,55 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "Options.hpp"
+
+const int CAPTURE_PBO_COUNT = 3;
+
+// 8-bit RGB image with the top row first, as stored in PPM files
+struct CaptureImage {
+    uint32_t frame = 0;
+    int width = 0, height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+// Framebuffer copy queued into a pixel pack buffer; mapped once its fence has signaled
+struct PendingReadback {
+    uint32_t frame;
+    GLuint pbo;
+    GLsync fence;
+};
+
+// Scripted-flight captures: frames to grab, where to write them and the golden set to compare against
+struct FrameCapture {
+    std::vector<uint32_t> frames;
+    std::string outputDir;
+    std::string goldenDir;
+    bool updateGolden = false;
+    double tolerancePercent = 0.5;
+    int width = 0, height = 0;
+    GLuint pbos[CAPTURE_PBO_COUNT] = {};
+    uint32_t nextPbo = 0;
+    std::deque<PendingReadback> pending;
+    std::vector<CaptureImage> ready;
+    uint32_t written = 0;
+    uint32_t compared = 0;
+    uint32_t failed = 0;
+};
+
+extern FrameCapture frameCapture;
+
+bool writePpm(const std::string &path, const CaptureImage &image);
+bool readPpm(const std::string &path, CaptureImage &image);
+double compareImages(const CaptureImage &image, const CaptureImage &golden, CaptureImage *diff);
+bool initFrameCapture(const Options &options, int width, int height);
+bool captureRequested(uint32_t frame);
+void captureFrame(uint32_t frame);
+void processFrameCaptures(bool flush);
+bool finishFrameCapture();
+
+#endif
@@ -0,0 +1,362 @@
+#include "Ecs.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+EcsWorld world;
+
+namespace {
+
+struct ComponentInfo {
+    uint32_t size;
+    uint32_t alignment;
+};
+
+ComponentInfo componentInfo[ECS_MAX_COMPONENTS];
+uint32_t componentCount = 0;
+std::mutex componentMutex;
+
+const uint32_t entityColumnOffset = 0;
+
+uint32_t alignUp(uint32_t offset, uint32_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Most rows that fit a chunk with every column aligned, laid out entity column first, then by component id
+void layoutArchetype(Archetype &archetype) {
+    uint32_t rowBytes = sizeof(uint32_t);
+    for (uint32_t id = 0; id < componentCount; id++) {
+        if (archetype.mask & (ComponentMask(1) << id)) rowBytes += componentInfo[id].size;
+    }
+
+    for (uint32_t rows = static_cast<uint32_t>(ECS_CHUNK_BYTES / rowBytes); rows > 0; rows--) {
+        uint32_t offset = rows * sizeof(uint32_t);
+        for (uint32_t id = 0; id < componentCount; id++) {
+            if (!(archetype.mask & (ComponentMask(1) << id))) continue;
+            offset = alignUp(offset, componentInfo[id].alignment);
+            archetype.columnOffset[id] = offset;
+            offset += rows * componentInfo[id].size;
+        }
+        if (offset <= ECS_CHUNK_BYTES) {
+            archetype.capacity = rows;
+            return;
+        }
+    }
+}
+
+uint32_t findArchetype(EcsWorld &world, ComponentMask mask) {
+    for (uint32_t i = 0; i < world.archetypes.size(); i++) {
+        if (world.archetypes[i].mask == mask) return i;
+    }
+    Archetype archetype;
+    archetype.mask = mask;
+    layoutArchetype(archetype);
+    world.archetypes.push_back(std::move(archetype));
+    return static_cast<uint32_t>(world.archetypes.size() - 1);
+}
+
+std::byte *rowData(const Archetype &archetype, uint32_t offset, uint32_t size, uint32_t row) {
+    return archetype.chunks[row / archetype.capacity]->bytes + offset + static_cast<size_t>(row % archetype.capacity) * size;
+}
+
+uint32_t &rowEntity(const Archetype &archetype, uint32_t row) {
+    return *reinterpret_cast<uint32_t *>(rowData(archetype, entityColumnOffset, sizeof(uint32_t), row));
+}
+
+std::byte *rowComponent(const Archetype &archetype, uint32_t id, uint32_t row) {
+    return rowData(archetype, archetype.columnOffset[id], componentInfo[id].size, row);
+}
+
+uint32_t appendRow(Archetype &archetype, uint32_t entityIndex) {
+    uint32_t row = archetype.count++;
+    if (row / archetype.capacity == archetype.chunks.size()) archetype.chunks.emplace_back(new EcsChunk);
+    rowEntity(archetype, row) = entityIndex;
+    return row;
+}
+
+// Fill the hole at row with the archetype's last row, so the rows stay packed
+void removeRow(EcsWorld &world, Archetype &archetype, uint32_t row) {
+    uint32_t last = --archetype.count;
+    if (row == last) return;
+    uint32_t moved = rowEntity(archetype, last);
+    rowEntity(archetype, row) = moved;
+    for (uint32_t id = 0; id < componentCount; id++) {
+        if (!(archetype.mask & (ComponentMask(1) << id))) continue;
+        std::memcpy(rowComponent(archetype, id, row), rowComponent(archetype, id, last), componentInfo[id].size);
+    }
+    world.entities[moved].row = row;
+}
+
+}
+
+/**
+ * registerComponent: Assign the next component id (see componentId)
+ */
+uint32_t registerComponent(size_t size, size_t alignment) {
+    std::lock_guard<std::mutex> lock(componentMutex);
+    if (componentCount == ECS_MAX_COMPONENTS) {
+        std::cerr << "Too many ECS component types (at most " << ECS_MAX_COMPONENTS << ")" << std::endl;
+        std::abort();
+    }
+    componentInfo[componentCount] = {static_cast<uint32_t>(size), static_cast<uint32_t>(alignment)};
+    return componentCount++;
+}
+
+/**
+ * createEntity: Create an entity with zeroed components for every bit of mask
+ */
+Entity createEntity(EcsWorld &world, ComponentMask mask) {
+    uint32_t index;
+    if (!world.freeEntities.empty()) {
+        index = world.freeEntities.back();
+        world.freeEntities.pop_back();
+    } else {
+        index = static_cast<uint32_t>(world.entities.size());
+        world.entities.push_back({1, 0, 0});
+    }
+
+    uint32_t archetypeIndex = findArchetype(world, mask);
+    Archetype &archetype = world.archetypes[archetypeIndex];
+    uint32_t row = appendRow(archetype, index);
+    for (uint32_t id = 0; id < componentCount; id++) {
+        if (mask & (ComponentMask(1) << id)) std::memset(rowComponent(archetype, id, row), 0, componentInfo[id].size);
+    }
+
+    EntityRecord &record = world.entities[index];
+    record.archetype = archetypeIndex;
+    record.row = row;
+    world.liveEntities++;
+    return {index, record.generation};
+}
+
+/**
+ * destroyEntity: Remove an entity and its components; false if it was already gone
+ */
+bool destroyEntity(EcsWorld &world, Entity entity) {
+    if (!isAlive(world, entity)) return false;
+    EntityRecord &record = world.entities[entity.index];
+    removeRow(world, world.archetypes[record.archetype], record.row);
+    if (++record.generation == 0) record.generation = 1;
+    world.freeEntities.push_back(entity.index);
+    world.liveEntities--;
+    return true;
+}
+
+/**
+ * isAlive: True while the entity has not been destroyed
+ */
+bool isAlive(const EcsWorld &world, Entity entity) {
+    return entity.generation != 0 && entity.index < world.entities.size()
+        && world.entities[entity.index].generation == entity.generation;
+}
+
+/**
+ * changeComponents: Add and remove components, moving the entity's row to the matching archetype
+ * Components it keeps are copied over and new ones start zeroed.
+ */
+bool changeComponents(EcsWorld &world, Entity entity, ComponentMask add, ComponentMask remove) {
+    if (!isAlive(world, entity)) return false;
+    EntityRecord &record = world.entities[entity.index];
+    ComponentMask oldMask = world.archetypes[record.archetype].mask;
+    ComponentMask newMask = (oldMask | add) & ~remove;
+    if (newMask == oldMask) return true;
+
+    uint32_t targetIndex = findArchetype(world, newMask);
+    Archetype &source = world.archetypes[record.archetype];
+    Archetype &target = world.archetypes[targetIndex];
+    uint32_t row = appendRow(target, entity.index);
+    for (uint32_t id = 0; id < componentCount; id++) {
+        ComponentMask bit = ComponentMask(1) << id;
+        if (!(newMask & bit)) continue;
+        if (oldMask & bit) {
+            std::memcpy(rowComponent(target, id, row), rowComponent(source, id, record.row), componentInfo[id].size);
+        } else {
+            std::memset(rowComponent(target, id, row), 0, componentInfo[id].size);
+        }
+    }
+    removeRow(world, source, record.row);
+    record.archetype = targetIndex;
+    record.row = row;
+    return true;
+}
+
+/**
+ * componentData: Pointer to an entity's component, or nullptr if it is dead or lacks the component
+ */
+void *componentData(EcsWorld &world, Entity entity, uint32_t component) {
+    if (!isAlive(world, entity)) return nullptr;
+    const EntityRecord &record = world.entities[entity.index];
+    const Archetype &archetype = world.archetypes[record.archetype];
+    if (!(archetype.mask & (ComponentMask(1) << component))) return nullptr;
+    return rowComponent(archetype, component, record.row);
+}
+
+/**
+ * clearWorld: Destroy every entity and free the chunks
+ */
+void clearWorld(EcsWorld &world) {
+    world = EcsWorld();
+}
+
+/**
+ * chunkRows: Number of rows in use in one chunk of an archetype
+ */
+uint32_t chunkRows(const Archetype &archetype, uint32_t chunk) {
+    return std::min(archetype.capacity, archetype.count - chunk * archetype.capacity);
+}
+
+/**
+ * gatherChunks: List the chunks matching mask in world.queryChunks, reusing its storage
+ */
+void gatherChunks(EcsWorld &world, ComponentMask mask) {
+    world.queryChunks.clear();
+    for (uint32_t i = 0; i < world.archetypes.size(); i++) {
+        const Archetype &archetype = world.archetypes[i];
+        if ((archetype.mask & mask) != mask) continue;
+        for (uint32_t chunk = 0; chunk * archetype.capacity < archetype.count; chunk++) {
+            world.queryChunks.push_back({i, chunk});
+        }
+    }
+}
+
+/**
+ * buildSchedule: Group systems into phases, keeping their order
+ * A system starts a new phase when it writes something the current phase touches or reads something it writes.
+ */
+EcsSchedule buildSchedule(const std::vector<EcsSystem> &systems) {
+    EcsSchedule schedule;
+    schedule.systems = systems;
+    ComponentMask phaseReads = 0, phaseWrites = 0;
+    for (uint32_t i = 0; i < systems.size(); i++) {
+        const EcsSystem &system = systems[i];
+        bool conflicts = (system.writes & (phaseReads | phaseWrites)) || (system.reads & phaseWrites);
+        if (i == 0 || conflicts) {
+            schedule.phaseStarts.push_back(i);
+            phaseReads = phaseWrites = 0;
+        }
+        phaseReads |= system.reads;
+        phaseWrites |= system.writes;
+    }
+    return schedule;
+}
+
+/**
+ * runSchedule: Run each phase in turn, the systems of a phase side by side on the thread pool
+ * A phase with a single system runs on the calling thread, so that system may use parallelForEach.
+ */
+void runSchedule(EcsWorld &world, const EcsSchedule &schedule) {
+    for (uint32_t phase = 0; phase < schedule.phaseStarts.size(); phase++) {
+        uint32_t first = schedule.phaseStarts[phase];
+        uint32_t end = phase + 1 < schedule.phaseStarts.size() ? schedule.phaseStarts[phase + 1]
+                                                               : static_cast<uint32_t>(schedule.systems.size());
+        if (end - first == 1) {
+            schedule.systems[first].run(world, schedule.systems[first].context);
+            continue;
+        }
+        parallelFor(end - first, [&](uint32_t index) {
+            const EcsSystem &system = schedule.systems[first + index];
+            system.run(world, system.context);
+        });
+    }
+}
+
+namespace {
+
+struct BenchmarkPosition {
+    float x, y, z;
+};
+
+struct BenchmarkVelocity {
+    float x, y, z;
+};
+
+struct BenchmarkLifetime {
+    float seconds;
+};
+
+const uint32_t benchmarkPasses = 10;
+const float benchmarkStep = 1.0f / 60.0f;
+
+void moveSystem(EcsWorld &world, void *) {
+    forEach<BenchmarkPosition, const BenchmarkVelocity>(world, [](BenchmarkPosition &position, const BenchmarkVelocity &velocity) {
+        position.x += velocity.x * benchmarkStep;
+        position.y += velocity.y * benchmarkStep;
+        position.z += velocity.z * benchmarkStep;
+    });
+}
+
+void ageSystem(EcsWorld &world, void *) {
+    forEach<BenchmarkLifetime>(world, [](BenchmarkLifetime &lifetime) { lifetime.seconds += benchmarkStep; });
+}
+
+template <typename Fn>
+double timePasses(Fn &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < benchmarkPasses; pass++) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / benchmarkPasses;
+}
+
+}
+
+/**
+ * runEcsBenchmark: Time position += velocity over entityCount entities as plain arrays and through ECS queries
+ * Every other entity also carries a lifetime, so the queries span two archetypes; the results must match.
+ */
+void runEcsBenchmark(uint32_t entityCount) {
+    EcsWorld bench;
+    std::vector<Entity> entities(entityCount);
+    std::vector<BenchmarkPosition> positions(entityCount);
+    std::vector<BenchmarkVelocity> velocities(entityCount);
+    for (uint32_t i = 0; i < entityCount; i++) {
+        positions[i] = {static_cast<float>(i % 1000), 0.0f, static_cast<float>(i / 1000)};
+        velocities[i] = {1.0f + (i % 7), 0.5f, -1.0f - (i % 3)};
+        entities[i] = i % 2 ? createEntity(bench, positions[i], velocities[i], BenchmarkLifetime{0.0f})
+                            : createEntity(bench, positions[i], velocities[i]);
+    }
+
+    auto arrayPass = [&]() {
+        for (uint32_t i = 0; i < entityCount; i++) {
+            positions[i].x += velocities[i].x * benchmarkStep;
+            positions[i].y += velocities[i].y * benchmarkStep;
+            positions[i].z += velocities[i].z * benchmarkStep;
+        }
+    };
+    auto move = [](BenchmarkPosition &position, const BenchmarkVelocity &velocity) {
+        position.x += velocity.x * benchmarkStep;
+        position.y += velocity.y * benchmarkStep;
+        position.z += velocity.z * benchmarkStep;
+    };
+    EcsSchedule schedule = buildSchedule({makeSystem<BenchmarkPosition, const BenchmarkVelocity>("move", moveSystem),
+                                          makeSystem<BenchmarkLifetime>("age", ageSystem)});
+
+    arrayPass();
+    double arrayMs = timePasses(arrayPass);
+    forEach<BenchmarkPosition, const BenchmarkVelocity>(bench, move);
+    double serialMs = timePasses([&]() { forEach<BenchmarkPosition, const BenchmarkVelocity>(bench, move); });
+    double parallelMs = timePasses([&]() { parallelForEach<BenchmarkPosition, const BenchmarkVelocity>(bench, move); });
+    double scheduleMs = timePasses([&]() { runSchedule(bench, schedule); });
+    // The ECS copy took two more sets of passes than the timed array loop
+    for (uint32_t pass = 0; pass < 2 * benchmarkPasses; pass++) arrayPass();
+
+    bool identical = true;
+    for (uint32_t i = 0; i < entityCount && identical; i++) {
+        identical = std::memcmp(getComponent<BenchmarkPosition>(bench, entities[i]), &positions[i], sizeof(BenchmarkPosition)) == 0;
+    }
+
+    // Each pass reads a position and a velocity and writes the position back
+    double megabytes = entityCount * (2.0 * sizeof(BenchmarkPosition) + sizeof(BenchmarkVelocity)) / (1024.0 * 1024.0);
+    auto rate = [&](double ms) { return megabytes / 1024.0 / (ms / 1000.0); };
+    std::cout << "ECS iteration: " << entityCount << " entities in " << bench.archetypes.size() << " archetypes, "
+              << megabytes << " MB moved per pass, average of " << benchmarkPasses << " passes\n"
+              << "  plain arrays:      " << arrayMs << " ms (" << rate(arrayMs) << " GB/s)\n"
+              << "  forEach:           " << serialMs << " ms (" << rate(serialMs) << " GB/s, "
+              << 100.0 * arrayMs / serialMs << "% of plain array speed)\n"
+              << "  parallelForEach:   " << parallelMs << " ms (" << rate(parallelMs) << " GB/s on " << threadPoolSize()
+              << " threads)\n"
+              << "  schedule:          " << scheduleMs << " ms for " << schedule.systems.size() << " systems in "
+              << schedule.phaseStarts.size() << (schedule.phaseStarts.size() == 1 ? " phase\n" : " phases\n")
+              << "  ECS positions " << (identical ? "identical to" : "DIFFER from") << " the plain arrays" << std::endl;
+}
@@ -0,0 +1,225 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "ThreadPool.hpp"
+
+const uint32_t ECS_MAX_COMPONENTS = 32;
+const size_t ECS_CHUNK_BYTES = 16 * 1024;
+
+typedef uint32_t ComponentMask;
+
+// Index into the world's entity table plus the generation it had when created; a destroyed entity's
+// handle stops resolving once its slot is reused. Generation 0 is never live, so Entity() is null
+struct Entity {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+};
+
+// One fixed-size block of an archetype: the entity column followed by one column per component
+struct alignas(64) EcsChunk {
+    std::byte bytes[ECS_CHUNK_BYTES];
+};
+
+// Every entity with exactly the components in mask. Rows are packed: row r lives in chunk r / capacity,
+// and removing a row moves the last one into its place. Chunks are kept once allocated
+struct Archetype {
+    ComponentMask mask = 0;
+    uint32_t capacity = 0;
+    uint32_t columnOffset[ECS_MAX_COMPONENTS] = {};
+    uint32_t count = 0;
+    std::vector<std::unique_ptr<EcsChunk>> chunks;
+};
+
+struct EntityRecord {
+    uint32_t generation = 0;
+    uint32_t archetype = 0;
+    uint32_t row = 0;
+};
+
+// Matching chunk handed to a parallel query
+struct EcsChunkRef {
+    uint32_t archetype;
+    uint32_t chunk;
+};
+
+// Entities and their components in archetype chunks. Not thread safe: entities are created and
+// destroyed on one thread, and systems running together may only touch component data
+struct EcsWorld {
+    std::vector<Archetype> archetypes;
+    std::vector<EntityRecord> entities;
+    std::vector<uint32_t> freeEntities;
+    uint32_t liveEntities = 0;
+    std::vector<EcsChunkRef> queryChunks;
+};
+
+// What a system reads and writes, for scheduling; run must not create or destroy entities
+struct EcsSystem {
+    const char *name;
+    ComponentMask reads;
+    ComponentMask writes;
+    void (*run)(EcsWorld &world, void *context);
+    void *context;
+};
+
+// Systems split into phases: each phase holds consecutive systems whose accesses don't conflict
+struct EcsSchedule {
+    std::vector<EcsSystem> systems;
+    std::vector<uint32_t> phaseStarts;
+};
+
+extern EcsWorld world;
+
+uint32_t registerComponent(size_t size, size_t alignment);
+Entity createEntity(EcsWorld &world, ComponentMask mask);
+bool destroyEntity(EcsWorld &world, Entity entity);
+bool isAlive(const EcsWorld &world, Entity entity);
+bool changeComponents(EcsWorld &world, Entity entity, ComponentMask add, ComponentMask remove);
+void *componentData(EcsWorld &world, Entity entity, uint32_t component);
+void clearWorld(EcsWorld &world);
+uint32_t chunkRows(const Archetype &archetype, uint32_t chunk);
+void gatherChunks(EcsWorld &world, ComponentMask mask);
+EcsSchedule buildSchedule(const std::vector<EcsSystem> &systems);
+void runSchedule(EcsWorld &world, const EcsSchedule &schedule);
+void runEcsBenchmark(uint32_t entityCount);
+
+/**
+ * componentId: The bit of component type T in a ComponentMask, assigned on first use
+ * Components are moved with memcpy and dropped without destructors, so they must be plain data.
+ */
+template <typename T>
+uint32_t componentId() {
+    if constexpr (std::is_const_v<T>) {
+        return componentId<std::remove_const_t<T>>();
+    } else {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "ECS components must be plain data");
+        static_assert(alignof(T) <= alignof(EcsChunk), "ECS components cannot be aligned beyond a cache line");
+        static const uint32_t id = registerComponent(sizeof(T), alignof(T));
+        return id;
+    }
+}
+
+/**
+ * componentMask: The mask of a list of component types (const or not)
+ */
+template <typename... Ts>
+ComponentMask componentMask() {
+    return (ComponentMask(0) | ... | (ComponentMask(1) << componentId<Ts>()));
+}
+
+/**
+ * createEntity: Create an entity holding exactly the given components
+ */
+template <typename... Ts>
+Entity createEntity(EcsWorld &world, const Ts &...components) {
+    Entity entity = createEntity(world, componentMask<Ts...>());
+    ((*static_cast<Ts *>(componentData(world, entity, componentId<Ts>())) = components), ...);
+    return entity;
+}
+
+/**
+ * getComponent: An entity's component T, or nullptr if it is dead or has no T
+ * The pointer stays valid until an entity of the same archetype is destroyed or changes components.
+ */
+template <typename T>
+T *getComponent(EcsWorld &world, Entity entity) {
+    return static_cast<T *>(componentData(world, entity, componentId<T>()));
+}
+
+/**
+ * addComponent: Give an entity a component T (overwriting it if present), moving it to a new archetype
+ */
+template <typename T>
+bool addComponent(EcsWorld &world, Entity entity, const T &component) {
+    if (!changeComponents(world, entity, componentMask<T>(), 0)) return false;
+    *getComponent<T>(world, entity) = component;
+    return true;
+}
+
+/**
+ * removeComponent: Take component T away from an entity
+ */
+template <typename T>
+bool removeComponent(EcsWorld &world, Entity entity) {
+    return changeComponents(world, entity, 0, componentMask<T>());
+}
+
+/**
+ * chunkColumn: A chunk's column of component T
+ */
+template <typename T>
+T *chunkColumn(const Archetype &archetype, uint32_t chunk) {
+    return reinterpret_cast<T *>(archetype.chunks[chunk]->bytes + archetype.columnOffset[componentId<T>()]);
+}
+
+/**
+ * forEachChunk: Call fn(rows, T1 *, T2 *, ...) with the columns of every chunk whose archetype has all of Ts
+ * Chunks come in archetype creation order, then row order.
+ */
+template <typename... Ts, typename Fn>
+void forEachChunk(EcsWorld &world, Fn &&fn) {
+    ComponentMask mask = componentMask<Ts...>();
+    for (const Archetype &archetype : world.archetypes) {
+        if ((archetype.mask & mask) != mask || archetype.count == 0) continue;
+        for (uint32_t chunk = 0; chunk * archetype.capacity < archetype.count; chunk++) {
+            fn(chunkRows(archetype, chunk), chunkColumn<Ts>(archetype, chunk)...);
+        }
+    }
+}
+
+/**
+ * forEach: Call fn(T1 &, T2 &, ...) for every entity that has all of Ts
+ */
+template <typename... Ts, typename Fn>
+void forEach(EcsWorld &world, Fn &&fn) {
+    forEachChunk<Ts...>(world, [&](uint32_t rows, Ts *...columns) {
+        for (uint32_t row = 0; row < rows; row++) fn(columns[row]...);
+    });
+}
+
+/**
+ * parallelForEach: forEach with the matching chunks spread over the thread pool
+ * Only from the thread that owns the pool: not from a system that runs next to others in its phase.
+ */
+template <typename... Ts, typename Fn>
+void parallelForEach(EcsWorld &world, Fn &&fn) {
+    auto visitRows = [&](uint32_t rows, Ts *...columns) {
+        for (uint32_t row = 0; row < rows; row++) fn(columns[row]...);
+    };
+    gatherChunks(world, componentMask<Ts...>());
+    parallelFor(static_cast<uint32_t>(world.queryChunks.size()), [&](uint32_t index) {
+        EcsChunkRef ref = world.queryChunks[index];
+        const Archetype &archetype = world.archetypes[ref.archetype];
+        visitRows(chunkRows(archetype, ref.chunk), chunkColumn<Ts>(archetype, ref.chunk)...);
+    });
+}
+
+/**
+ * countEntities: Number of live entities that have all of Ts
+ */
+template <typename... Ts>
+uint32_t countEntities(const EcsWorld &world) {
+    ComponentMask mask = componentMask<Ts...>();
+    uint32_t total = 0;
+    for (const Archetype &archetype : world.archetypes) {
+        if ((archetype.mask & mask) == mask) total += archetype.count;
+    }
+    return total;
+}
+
+/**
+ * makeSystem: A system accessing Ts: const components are read, the others written
+ */
+template <typename... Ts>
+EcsSystem makeSystem(const char *name, void (*run)(EcsWorld &world, void *context), void *context = nullptr) {
+    ComponentMask reads = (ComponentMask(0) | ... | (std::is_const_v<Ts> ? componentMask<Ts>() : 0));
+    ComponentMask writes = (ComponentMask(0) | ... | (std::is_const_v<Ts> ? 0 : componentMask<Ts>()));
+    return {name, reads, writes, run, context};
+}
+
+#endif
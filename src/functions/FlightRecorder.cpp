@@ -0,0 +1,379 @@
+#include "FlightRecorder.hpp"
+#include "MemoryTracker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+FlightRecorder flightRecorder;
+
+namespace {
+
+const char flightLogMagic[4] = {'F', 'R', 'E', 'C'};
+const char flightIndexMagic[4] = {'F', 'I', 'D', 'X'};
+const uint32_t flightLogVersion = 3;
+const uint32_t firstVersionWithSectors = 3;
+const size_t writeBufferBytes = 1024 * 1024;
+const int stateFieldCount = 7;
+const uint8_t inputsChangedBit = 0x80;
+
+static_assert(offsetof(PlaneState, sectorX) == stateFieldCount * sizeof(float)
+              && sizeof(PlaneState) == offsetof(PlaneState, sectorX) + 3 * sizeof(int32_t),
+              "PlaneState must be seven packed floats followed by the sector");
+
+// File layout: header, blocks (header + payload), block index, footer pointing at the index
+struct FlightLogHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t aircraftCount;
+    uint32_t keyframeInterval;
+    uint32_t worldSeed;
+    uint32_t tickRate;
+    uint32_t flags;
+};
+
+struct FlightBlockHeader {
+    uint32_t firstTick;
+    uint32_t tickCount;
+    uint32_t payloadBytes;
+};
+
+struct FlightIndexEntry {
+    uint32_t firstTick;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+struct FlightLogFooter {
+    uint64_t indexOffset;
+    uint32_t blockCount;
+    char magic[4];
+};
+
+// Block being encoded on the writer thread; previous/beforePrevious feed the predictor
+struct BlockEncoder {
+    std::vector<uint8_t> payload;
+    std::vector<FlightIndexEntry> index;
+    uint32_t firstTick = 0, tickCount = 0, lastTick = 0, lastInputs = 0;
+    float previous[stateFieldCount] = {};
+    float beforePrevious[stateFieldCount] = {};
+    int32_t sector[3] = {};
+    uint64_t offset = 0;
+};
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Linear extrapolation from the last two ticks; the decoder repeats it exactly, so any residual is lossless
+float predictField(float previous, float beforePrevious) {
+    return previous + (previous - beforePrevious);
+}
+
+// Residual in float bit space: nearby values of the same sign differ by a few ULPs, so the zigzagged
+// integer difference stays small where an XOR would spill into the exponent bits
+uint32_t encodeResidual(float actual, float predicted) {
+    uint32_t difference = floatBits(actual) - floatBits(predicted);
+    return (difference << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(difference) >> 31);
+}
+
+float decodeResidual(uint32_t residual, float predicted) {
+    uint32_t difference = (residual >> 1) ^ (0u - (residual & 1));
+    return bitsFloat(floatBits(predicted) + difference);
+}
+
+void putVarint(std::vector<uint8_t> &out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t *&cursor, const uint8_t *end, uint32_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void flushBlock(BlockEncoder &encoder) {
+    FlightRecorder &recorder = flightRecorder;
+    if (encoder.tickCount == 0) return;
+
+    FlightBlockHeader header = {encoder.firstTick, encoder.tickCount, static_cast<uint32_t>(encoder.payload.size())};
+    std::fwrite(&header, sizeof(header), 1, recorder.file);
+    std::fwrite(encoder.payload.data(), 1, encoder.payload.size(), recorder.file);
+    encoder.index.push_back({encoder.firstTick, 0, encoder.offset});
+    encoder.offset += sizeof(header) + encoder.payload.size();
+
+    recorder.blocksWritten++;
+    recorder.ticksWritten += encoder.tickCount;
+    encoder.payload.clear();
+    encoder.tickCount = 0;
+}
+
+// A block opens with the raw tick and sector as its keyframe; every later tick is a field mask plus varint
+// residuals. Moving to another sector starts a new block, so residuals never span a rebase
+void encodeTick(BlockEncoder &encoder, const FlightTick &tick) {
+    const int32_t sector[3] = {tick.state.sectorX, tick.state.sectorY, tick.state.sectorZ};
+    bool contiguous = encoder.tickCount > 0 && tick.tick == encoder.lastTick + 1
+                   && std::equal(sector, sector + 3, encoder.sector);
+    if (!contiguous || encoder.tickCount == FLIGHT_KEYFRAME_INTERVAL) flushBlock(encoder);
+
+    float fields[stateFieldCount];
+    std::memcpy(fields, &tick.state, sizeof(fields));
+
+    if (encoder.tickCount == 0) {
+        encoder.firstTick = tick.tick;
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(&tick.inputs);
+        encoder.payload.insert(encoder.payload.end(), raw, raw + sizeof(tick.inputs));
+        raw = reinterpret_cast<const uint8_t *>(fields);
+        encoder.payload.insert(encoder.payload.end(), raw, raw + sizeof(fields));
+        raw = reinterpret_cast<const uint8_t *>(sector);
+        encoder.payload.insert(encoder.payload.end(), raw, raw + sizeof(sector));
+        std::copy(sector, sector + 3, encoder.sector);
+        std::copy(fields, fields + stateFieldCount, encoder.beforePrevious);
+    } else {
+        size_t maskAt = encoder.payload.size();
+        encoder.payload.push_back(0);
+        uint8_t mask = 0;
+        if (tick.inputs != encoder.lastInputs) {
+            mask |= inputsChangedBit;
+            putVarint(encoder.payload, tick.inputs);
+        }
+        for (int i = 0; i < stateFieldCount; i++) {
+            uint32_t residual = encodeResidual(fields[i], predictField(encoder.previous[i], encoder.beforePrevious[i]));
+            if (residual == 0) continue;
+            mask |= static_cast<uint8_t>(1u << i);
+            putVarint(encoder.payload, residual);
+        }
+        encoder.payload[maskAt] = mask;
+        std::copy(encoder.previous, encoder.previous + stateFieldCount, encoder.beforePrevious);
+    }
+
+    std::copy(fields, fields + stateFieldCount, encoder.previous);
+    encoder.lastTick = tick.tick;
+    encoder.lastInputs = tick.inputs;
+    encoder.tickCount++;
+}
+
+void writerLoop() {
+    MemoryScope scope(MEMORY_RECORDER);
+    excludeThreadFromFrameMemory();
+    FlightRecorder &recorder = flightRecorder;
+    BlockEncoder encoder;
+    encoder.offset = sizeof(FlightLogHeader);
+    encoder.payload.reserve(FLIGHT_KEYFRAME_INTERVAL * 16);
+
+    for (;;) {
+        // Read stopping before draining so ticks pushed just before the stop are still written
+        bool stopping = recorder.stopping.load(std::memory_order_acquire);
+        uint32_t tail = recorder.tail.load(std::memory_order_relaxed);
+        uint32_t head = recorder.head.load(std::memory_order_acquire);
+        if (tail == head) {
+            if (stopping) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        for (; tail != head; tail++) encodeTick(encoder, recorder.ring[tail % FLIGHT_RING_CAPACITY]);
+        recorder.tail.store(tail, std::memory_order_release);
+    }
+    flushBlock(encoder);
+
+    FlightLogFooter footer = {encoder.offset, static_cast<uint32_t>(encoder.index.size()), {}};
+    std::memcpy(footer.magic, flightIndexMagic, sizeof(footer.magic));
+    std::fwrite(encoder.index.data(), sizeof(FlightIndexEntry), encoder.index.size(), recorder.file);
+    std::fwrite(&footer, sizeof(footer), 1, recorder.file);
+    recorder.bytesWritten = encoder.offset + encoder.index.size() * sizeof(FlightIndexEntry) + sizeof(footer);
+}
+
+// Decode one block, keeping the ticks at or after fromTick; keyframes before version 3 have no sector
+bool decodeBlock(const FlightBlockHeader &header, const std::vector<uint8_t> &payload,
+                 std::vector<FlightTick> &ticks, uint32_t fromTick, bool hasSector) {
+    const uint8_t *cursor = payload.data();
+    const uint8_t *end = cursor + payload.size();
+    float previous[stateFieldCount], beforePrevious[stateFieldCount], fields[stateFieldCount];
+    int32_t sector[3] = {};
+    FlightTick tick = {header.firstTick, 0, {}};
+
+    size_t keyframeBytes = sizeof(uint32_t) + sizeof(fields) + (hasSector ? sizeof(sector) : 0);
+    if (header.tickCount == 0 || payload.size() < keyframeBytes) return false;
+    std::memcpy(&tick.inputs, cursor, sizeof(tick.inputs));
+    cursor += sizeof(tick.inputs);
+    std::memcpy(fields, cursor, sizeof(fields));
+    cursor += sizeof(fields);
+    if (hasSector) {
+        std::memcpy(sector, cursor, sizeof(sector));
+        cursor += sizeof(sector);
+    }
+    std::copy(fields, fields + stateFieldCount, beforePrevious);
+
+    for (uint32_t i = 0; i < header.tickCount; i++) {
+        if (i > 0) {
+            if (cursor >= end) return false;
+            uint8_t mask = *cursor++;
+            if ((mask & inputsChangedBit) && !getVarint(cursor, end, tick.inputs)) return false;
+            for (int f = 0; f < stateFieldCount; f++) {
+                uint32_t residual = 0;
+                if ((mask & (1u << f)) && !getVarint(cursor, end, residual)) return false;
+                fields[f] = decodeResidual(residual, predictField(previous[f], beforePrevious[f]));
+            }
+            std::copy(previous, previous + stateFieldCount, beforePrevious);
+            tick.tick = header.firstTick + i;
+        }
+        std::copy(fields, fields + stateFieldCount, previous);
+        if (tick.tick >= fromTick) {
+            std::memcpy(&tick.state, fields, sizeof(fields));
+            tick.state.sectorX = sector[0];
+            tick.state.sectorY = sector[1];
+            tick.state.sectorZ = sector[2];
+            ticks.push_back(tick);
+        }
+    }
+    return cursor == end;
+}
+
+}
+
+/**
+ * startFlightRecorder: Open a flight log and start the thread that encodes and writes it
+ */
+bool startFlightRecorder(const std::string &path, const FlightLogInfo &info) {
+    MemoryScope scope(MEMORY_RECORDER);
+    FlightRecorder &recorder = flightRecorder;
+    recorder.file = std::fopen(path.c_str(), "wb");
+    if (!recorder.file) {
+        std::cerr << "Cannot open flight log: " << path << std::endl;
+        return false;
+    }
+    recorder.writeBuffer.resize(writeBufferBytes);
+    std::setvbuf(recorder.file, recorder.writeBuffer.data(), _IOFBF, recorder.writeBuffer.size());
+
+    FlightLogHeader header = {{}, flightLogVersion, 1, FLIGHT_KEYFRAME_INTERVAL, info.worldSeed, info.tickRate, info.flags};
+    std::memcpy(header.magic, flightLogMagic, sizeof(header.magic));
+    std::fwrite(&header, sizeof(header), 1, recorder.file);
+
+    recorder.head.store(0, std::memory_order_relaxed);
+    recorder.tail.store(0, std::memory_order_relaxed);
+    recorder.stopping.store(false, std::memory_order_relaxed);
+    recorder.droppedTicks = recorder.ticksWritten = recorder.blocksWritten = recorder.bytesWritten = 0;
+    recorder.active = true;
+    recorder.writer = std::thread(writerLoop);
+    std::cout << "Flight log: recording to " << path << " (keyframe every " << FLIGHT_KEYFRAME_INTERVAL
+              << " ticks)" << std::endl;
+    return true;
+}
+
+/**
+ * recordFlightTick: Push one tick into the ring for the writer thread (sim thread only, never blocks)
+ */
+void recordFlightTick(uint32_t tick, uint32_t inputs, const PlaneState &state) {
+    FlightRecorder &recorder = flightRecorder;
+    if (!recorder.active) return;
+
+    uint32_t head = recorder.head.load(std::memory_order_relaxed);
+    if (head - recorder.tail.load(std::memory_order_acquire) == FLIGHT_RING_CAPACITY) {
+        recorder.droppedTicks++;
+        return;
+    }
+    recorder.ring[head % FLIGHT_RING_CAPACITY] = {tick, inputs, state};
+    recorder.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * stopFlightRecorder: Write out the queued ticks, the block index and the footer, then report the log size
+ */
+void stopFlightRecorder() {
+    FlightRecorder &recorder = flightRecorder;
+    if (!recorder.active) return;
+
+    recorder.stopping.store(true, std::memory_order_release);
+    recorder.writer.join();
+    std::fclose(recorder.file);
+    recorder.file = nullptr;
+    recorder.writeBuffer.clear();
+    recorder.active = false;
+
+    double perTick = recorder.ticksWritten ? static_cast<double>(recorder.bytesWritten) / recorder.ticksWritten : 0.0;
+    std::cout << "Flight log: " << recorder.ticksWritten << " ticks in " << recorder.blocksWritten << " blocks, "
+              << recorder.bytesWritten << " bytes (" << perTick << " bytes/tick), "
+              << recorder.droppedTicks << " dropped on a full ring" << std::endl;
+}
+
+/**
+ * loadFlightLog: Decode a flight log from the keyframe at or before fromTick onwards
+ * The block index is used to seek when the footer is intact; a log cut short by a crash is scanned from the start.
+ */
+bool loadFlightLog(const std::string &path, FlightLogInfo &info, std::vector<FlightTick> &ticks, uint32_t fromTick) {
+    MemoryScope scope(MEMORY_RECORDER);
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Cannot open flight log: " << path << std::endl;
+        return false;
+    }
+
+    FlightLogHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, flightLogMagic, 4) != 0
+        || header.version < 2 || header.version > flightLogVersion || header.aircraftCount != 1) {
+        std::cerr << "Not a flight log or unsupported version: " << path << std::endl;
+        std::fclose(file);
+        return false;
+    }
+    info.worldSeed = header.worldSeed;
+    info.tickRate = header.tickRate;
+    info.flags = header.flags;
+
+    // Without an index the blocks run until the end of the file
+    uint64_t start = sizeof(header);
+    uint64_t blocksEnd = UINT64_MAX;
+    FlightLogFooter footer;
+    if (std::fseek(file, -static_cast<long>(sizeof(footer)), SEEK_END) == 0
+        && std::fread(&footer, sizeof(footer), 1, file) == 1
+        && std::memcmp(footer.magic, flightIndexMagic, 4) == 0) {
+        std::vector<FlightIndexEntry> index(footer.blockCount);
+        if (std::fseek(file, static_cast<long>(footer.indexOffset), SEEK_SET) == 0
+            && std::fread(index.data(), sizeof(FlightIndexEntry), index.size(), file) == index.size()) {
+            blocksEnd = footer.indexOffset;
+            for (const FlightIndexEntry &entry : index) {
+                if (entry.firstTick <= fromTick) start = entry.offset;
+            }
+        }
+    }
+
+    std::fseek(file, static_cast<long>(start), SEEK_SET);
+    uint64_t offset = start;
+    std::vector<uint8_t> payload;
+    bool valid = true;
+    while (offset < blocksEnd) {
+        FlightBlockHeader block;
+        if (std::fread(&block, sizeof(block), 1, file) != 1) {
+            valid = blocksEnd == UINT64_MAX;
+            break;
+        }
+        payload.resize(block.payloadBytes);
+        if (std::fread(payload.data(), 1, payload.size(), file) != payload.size()
+            || !decodeBlock(block, payload, ticks, fromTick, header.version >= firstVersionWithSectors)) {
+            valid = false;
+            break;
+        }
+        offset += sizeof(block) + payload.size();
+    }
+    std::fclose(file);
+
+    if (!valid) std::cerr << "Flight log is truncated or corrupt after tick " << (ticks.empty() ? fromTick : ticks.back().tick)
+                          << ": " << path << std::endl;
+    return valid;
+}
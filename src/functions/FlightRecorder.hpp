@@ -0,0 +1,58 @@
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MainFunctions.hpp"
+
+const uint32_t FLIGHT_RING_CAPACITY = 4096;
+const uint32_t FLIGHT_KEYFRAME_INTERVAL = 600;
+
+// FlightLogInfo flags
+const uint32_t FLIGHT_LOG_SCRIPTED = 1;
+
+// What a replay needs besides the ticks: the world seed, the fixed tick rate and whether the scripted
+// benchmark flight drove the camera and speed
+struct FlightLogInfo {
+    uint32_t worldSeed = 0;
+    uint32_t tickRate = 0;
+    uint32_t flags = 0;
+};
+
+// One sim tick of one aircraft: the inputs applied on that tick and the state they produced
+struct FlightTick {
+    uint32_t tick;
+    uint32_t inputs;
+    PlaneState state;
+};
+
+// Flight data recorder: the sim thread pushes fixed-size ticks into a single-producer/single-consumer
+// ring and a writer thread delta-encodes them into blocks that each open with a raw keyframe, so a log
+// can be read from any block. Recording never allocates or locks; a full ring drops the tick and counts it.
+struct FlightRecorder {
+    FlightTick ring[FLIGHT_RING_CAPACITY];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<bool> stopping{false};
+    std::FILE *file = nullptr;
+    std::vector<char> writeBuffer;
+    std::thread writer;
+    bool active = false;
+    uint64_t droppedTicks = 0;
+    uint64_t ticksWritten = 0;
+    uint64_t blocksWritten = 0;
+    uint64_t bytesWritten = 0;
+};
+
+extern FlightRecorder flightRecorder;
+
+bool startFlightRecorder(const std::string &path, const FlightLogInfo &info);
+void recordFlightTick(uint32_t tick, uint32_t inputs, const PlaneState &state);
+void stopFlightRecorder();
+bool loadFlightLog(const std::string &path, FlightLogInfo &info, std::vector<FlightTick> &ticks, uint32_t fromTick = 0);
+
+#endif
@@ -0,0 +1,136 @@
+#include "FrameMemory.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <iostream>
+
+FrameMemory frameMemory;
+
+/**
+ * FrameArena::reset: Free everything; if the last use overflowed, regrow the block to hold all of it
+ */
+void FrameArena::reset() {
+    for (const auto &[pointer, alignment] : overflowBlocks) ::operator delete(pointer, std::align_val_t(alignment));
+    overflowBlocks.clear();
+    if (!block || overflowBytes > 0) {
+        capacity = std::max({FRAME_ARENA_BYTES, capacity * 2, used + overflowBytes});
+        block.reset(new std::byte[capacity]);
+    }
+    used = 0;
+    overflowBytes = 0;
+    allocations = 0;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    allocations++;
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    uintptr_t start = (base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (block && start + bytes <= base + capacity) {
+        used = start + bytes - base;
+        return reinterpret_cast<void *>(start);
+    }
+
+    void *pointer = ::operator new(bytes, std::align_val_t(alignment));
+    overflowBlocks.push_back({pointer, alignment});
+    overflowBytes += bytes + alignment;
+    return pointer;
+}
+
+FixedPool::FixedPool(size_t size, size_t perChunk)
+    : blockSize((std::max(size, sizeof(void *)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)),
+      blocksPerChunk(perChunk) {}
+
+void *FixedPool::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > blockSize || alignment > alignof(std::max_align_t)) {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    if (!freeList) {
+        chunks.emplace_back(new std::byte[blockSize * blocksPerChunk]);
+        std::byte *chunk = chunks.back().get();
+        for (size_t i = blocksPerChunk; i-- > 0;) {
+            void *block = chunk + i * blockSize;
+            *static_cast<void **>(block) = freeList;
+            freeList = block;
+        }
+    }
+
+    void *block = freeList;
+    freeList = *static_cast<void **>(block);
+    blocksInUse++;
+    peakBlocks = std::max(peakBlocks, blocksInUse);
+    return block;
+}
+
+void FixedPool::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+    if (bytes > blockSize || alignment > alignof(std::max_align_t)) {
+        ::operator delete(pointer, std::align_val_t(alignment));
+        return;
+    }
+    *static_cast<void **>(pointer) = freeList;
+    freeList = pointer;
+    blocksInUse--;
+}
+
+/**
+ * beginFrameMemory: Switch to the other frame arena and free what it held two frames ago
+ * Allocations on every thread count towards the frame, thread pool workers included, except on the
+ * background threads that opted out with excludeThreadFromFrameMemory.
+ */
+void beginFrameMemory() {
+    FrameMemory &memory = frameMemory;
+    memory.heapAtFrameStart = frameHeapAllocations.load(std::memory_order_relaxed);
+    memory.current ^= 1;
+    MemoryScope scope(MEMORY_RENDERER);
+    memory.arenas[memory.current].reset();
+}
+
+/**
+ * endFrameMemory: Count the frame's heap allocations and arena use into frameStats and the run totals
+ */
+void endFrameMemory() {
+    FrameMemory &memory = frameMemory;
+    const FrameArena &arena = memory.arenas[memory.current];
+    uint64_t allocated = frameHeapAllocations.load(std::memory_order_relaxed) - memory.heapAtFrameStart;
+    size_t arenaBytes = arena.used + arena.overflowBytes;
+    memory.peakArenaBytes = std::max(memory.peakArenaBytes, arenaBytes);
+
+    if (memory.frames >= FRAME_MEMORY_WARMUP_FRAMES) {
+        memory.steadyFrames++;
+        if (allocated > 0) memory.steadyFramesAllocating++;
+        memory.steadyAllocations += allocated;
+    }
+    memory.frames++;
+
+    frameStats.heapAllocations = static_cast<uint32_t>(allocated);
+    frameStats.arenaBytes = arenaBytes;
+}
+
+/**
+ * frameArena: The arena for data that only has to live until the end of the next frame
+ */
+std::pmr::memory_resource *frameArena() {
+    return &frameMemory.arenas[frameMemory.current];
+}
+
+/**
+ * reportFrameMemory: Print the arena high-water mark and the heap allocations after the warm-up frames
+ * With check set, any steady-state frame that allocated from the heap fails the run.
+ */
+bool reportFrameMemory(bool check) {
+    const FrameMemory &memory = frameMemory;
+    if (memory.frames == 0) return true;
+
+    size_t reserved = memory.arenas[0].capacity + memory.arenas[1].capacity;
+    std::cout << "Frame memory: arena peak " << memory.peakArenaBytes / 1024 << " KB per frame (" << reserved / 1024
+              << " KB reserved for 2 frames)";
+    if (memory.steadyFrames > 0) {
+        std::cout << ", " << memory.steadyFramesAllocating << " of " << memory.steadyFrames << " frames after the first "
+                  << FRAME_MEMORY_WARMUP_FRAMES << " allocated from the heap (" << memory.steadyAllocations
+                  << " allocations)";
+    }
+    if (memory.steadyFrames == 0) std::cout << ", no frames after the first " << FRAME_MEMORY_WARMUP_FRAMES;
+    bool passed = !check || (memory.steadyFrames > 0 && memory.steadyFramesAllocating == 0);
+    if (check) std::cout << (passed ? ", PASSED" : ", FAILED");
+    std::cout << std::endl;
+    return passed;
+}
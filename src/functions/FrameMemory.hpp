@@ -0,0 +1,84 @@
+#ifndef FRAME_MEMORY_HPP
+#define FRAME_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "MemoryTracker.hpp"
+
+const size_t FRAME_ARENA_BYTES = 4 << 20;
+const uint32_t FRAME_MEMORY_WARMUP_FRAMES = 30;
+
+// Bump allocator over one block: deallocate does nothing and reset frees everything at once.
+// Requests past the end get overflow blocks from the heap; the next reset grows the block to cover them
+struct FrameArena : std::pmr::memory_resource {
+    std::unique_ptr<std::byte[]> block;
+    size_t capacity = 0;
+    size_t used = 0;
+    std::vector<std::pair<void *, size_t>> overflowBlocks;
+    size_t overflowBytes = 0;
+    uint64_t allocations = 0;
+
+    void reset();
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// Free list of equally sized blocks carved from chunks that are kept until the pool is destroyed.
+// Not thread safe; requests larger than the block size go to the heap
+struct FixedPool : std::pmr::memory_resource {
+    size_t blockSize;
+    size_t blocksPerChunk;
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    void *freeList = nullptr;
+    size_t blocksInUse = 0;
+    size_t peakBlocks = 0;
+
+    FixedPool(size_t blockSize, size_t blocksPerChunk);
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// Two frame arenas used in turn, so what a frame allocates stays valid through the next frame, and
+// the heap allocation counts of every frame after the warm-up
+struct FrameMemory {
+    FrameArena arenas[2];
+    uint32_t current = 0;
+    uint64_t frames = 0;
+    uint64_t heapAtFrameStart = 0;
+    uint64_t steadyFrames = 0;
+    uint64_t steadyFramesAllocating = 0;
+    uint64_t steadyAllocations = 0;
+    size_t peakArenaBytes = 0;
+};
+
+extern FrameMemory frameMemory;
+
+void beginFrameMemory();
+void endFrameMemory();
+std::pmr::memory_resource *frameArena();
+bool reportFrameMemory(bool check);
+
+/**
+ * resetFrameVector: Empty a vector and rebind it to the current frame arena with room for capacity elements
+ * Its old storage is simply abandoned to the arena it came from, which is why T must be trivially destructible.
+ */
+template <typename T>
+void resetFrameVector(std::pmr::vector<T> &vector, size_t capacity) {
+    static_assert(std::is_trivially_destructible_v<T>, "frame vectors are dropped without destroying elements");
+    std::destroy_at(&vector);
+    std::construct_at(&vector, frameArena());
+    vector.reserve(capacity);
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include "FramePacing.hpp"
+#include "Stats.hpp"
+#include "Log.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+FramePacing framePacing;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double toMs(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Clock::duration fromMs(double ms) {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+// One turn of the final spin: a pause hint on x86, elsewhere give the core to anything else runnable
+void spinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Swap intervals of -1 (swap late frames immediately instead of waiting a whole refresh) need this extension
+bool adaptiveVsyncSupported() {
+    return glfwExtensionSupported("GLX_EXT_swap_control_tear") || glfwExtensionSupported("WGL_EXT_swap_control_tear");
+}
+
+}
+
+/**
+ * parsePacingMode: vsync, adaptive, uncapped or limit
+ */
+bool parsePacingMode(const std::string &name, PacingMode &mode) {
+    for (PacingMode candidate : {PACING_VSYNC, PACING_ADAPTIVE, PACING_UNCAPPED, PACING_LIMIT}) {
+        if (name == pacingModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * pacingModeName: The --pacing name of a mode
+ */
+const char *pacingModeName(PacingMode mode) {
+    switch (mode) {
+        case PACING_VSYNC: return "vsync";
+        case PACING_ADAPTIVE: return "adaptive";
+        case PACING_UNCAPPED: return "uncapped";
+        case PACING_LIMIT: return "limit";
+    }
+    return "unknown";
+}
+
+/**
+ * initFramePacing: Set the swap interval for mode; the limiter runs at fpsLimit, or the monitor's refresh rate when 0
+ * Without a window nothing is presented, so the vsync modes fall back to uncapped.
+ */
+void initFramePacing(PacingMode mode, double fpsLimit, GLFWwindow *window) {
+    FramePacing &p = framePacing;
+    p.presents = window != nullptr;
+    if (window) {
+        GLFWmonitor *monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode *videoMode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+        if (videoMode && videoMode->refreshRate > 0) p.refreshMs = 1000.0 / videoMode->refreshRate;
+    }
+
+    if (!window && (mode == PACING_VSYNC || mode == PACING_ADAPTIVE)) mode = PACING_UNCAPPED;
+    if (mode == PACING_ADAPTIVE && !adaptiveVsyncSupported()) {
+        LOG_WARN("Pacing: adaptive vsync is not supported here, using vsync");
+        mode = PACING_VSYNC;
+    }
+    p.mode = mode;
+    if (window) glfwSwapInterval(mode == PACING_VSYNC ? 1 : mode == PACING_ADAPTIVE ? -1 : 0);
+
+    if (mode == PACING_LIMIT) {
+        double targetMs = fpsLimit > 0.0 ? 1000.0 / fpsLimit : p.refreshMs;
+        p.period = fromMs(targetMs);
+        p.deadline = Clock::now();
+        LOG_INFO("Pacing: limited to {} fps by sleeping and spinning", 1000.0 / targetMs);
+    } else {
+        LOG_INFO("Pacing: {}", pacingModeName(mode));
+    }
+}
+
+/**
+ * waitForFrameStart: In limit mode, hold the frame until its slot; sleep while the deadline is far, spin close to it
+ * A frame that misses its slot by more than a period starts the schedule afresh instead of rushing to catch up.
+ */
+void waitForFrameStart() {
+    FramePacing &p = framePacing;
+    if (p.mode != PACING_LIMIT) return;
+
+    Clock::time_point now = Clock::now();
+    p.limitedFrames++;
+    if (now - p.deadline > p.period) {
+        p.lateFrames++;
+        p.deadline = now;
+    }
+
+    Clock::duration spin = fromMs(p.spinMs);
+    if (p.deadline - now > spin) {
+        Clock::duration request = p.deadline - now - spin;
+        std::this_thread::sleep_for(request);
+        Clock::time_point woke = Clock::now();
+        // Track the worst recent oversleep, decaying slowly, so the spin covers the scheduler's wake-up jitter
+        double oversleepMs = toMs(woke - now - request);
+        p.spinMs = std::clamp(std::max(oversleepMs + PACING_MIN_SPIN_MS, p.spinMs * 0.99), PACING_MIN_SPIN_MS,
+                              PACING_MAX_SPIN_MS);
+        now = woke;
+    }
+    while (now < p.deadline) {
+        spinPause();
+        now = Clock::now();
+    }
+    p.deadline += p.period;
+}
+
+/**
+ * markInputSampled: Note when this frame's input was polled; called right before the simulation
+ */
+void markInputSampled() {
+    framePacing.inputSampled = Clock::now();
+}
+
+/**
+ * recordPresent: After the swap (or at the end of a headless frame), record the present interval and the
+ * estimated input latency: input sample to swap return, plus half a refresh of scanout when presenting
+ */
+void recordPresent() {
+    FramePacing &p = framePacing;
+    Clock::time_point now = Clock::now();
+    double latencyMs = toMs(now - p.inputSampled) + (p.presents ? p.refreshMs * 0.5 : 0.0);
+    double intervalMs = p.hasPresented ? toMs(now - p.lastPresent) : 0.0;
+    recordPresentStats(intervalMs, latencyMs, p.hasPresented);
+    p.lastPresent = now;
+    p.hasPresented = true;
+}
+
+/**
+ * reportFramePacing: Print the pacing mode and, for the limiter, how often it missed its slot
+ */
+void reportFramePacing() {
+    FramePacing &p = framePacing;
+    std::cout << "Pacing: " << pacingModeName(p.mode);
+    if (p.mode == PACING_LIMIT) {
+        std::cout << " at " << 1000.0 / toMs(p.period) << " fps, " << p.lateFrames << " of " << p.limitedFrames
+                  << " frames missed their slot, spinning the last " << p.spinMs << " ms";
+    }
+    std::cout << std::endl;
+}
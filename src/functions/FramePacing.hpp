@@ -0,0 +1,49 @@
+#ifndef FRAME_PACING_HPP
+#define FRAME_PACING_HPP
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// The limiter sleeps until this much before its deadline on the first frame, then learns how late the
+// scheduler actually wakes it and spins that final stretch
+const double PACING_INITIAL_SPIN_MS = 2.0;
+const double PACING_MIN_SPIN_MS = 0.25;
+const double PACING_MAX_SPIN_MS = 4.0;
+const double PACING_DEFAULT_REFRESH_HZ = 60.0;
+
+enum PacingMode : uint32_t {
+    PACING_VSYNC,
+    PACING_ADAPTIVE,
+    PACING_UNCAPPED,
+    PACING_LIMIT
+};
+
+// How frames are paced and when input is sampled. Input is polled as late as possible, right before the
+// simulation, and the time from then until the frame is presented is the latency estimate
+struct FramePacing {
+    PacingMode mode = PACING_VSYNC;
+    bool presents = false;
+    double refreshMs = 1000.0 / PACING_DEFAULT_REFRESH_HZ;
+    std::chrono::steady_clock::duration period{};
+    std::chrono::steady_clock::time_point deadline;
+    double spinMs = PACING_INITIAL_SPIN_MS;
+    std::chrono::steady_clock::time_point inputSampled;
+    std::chrono::steady_clock::time_point lastPresent;
+    bool hasPresented = false;
+    uint64_t lateFrames = 0;
+    uint64_t limitedFrames = 0;
+};
+
+extern FramePacing framePacing;
+
+bool parsePacingMode(const std::string &name, PacingMode &mode);
+const char *pacingModeName(PacingMode mode);
+void initFramePacing(PacingMode mode, double fpsLimit, GLFWwindow *window);
+void waitForFrameStart();
+void markInputSampled();
+void recordPresent();
+void reportFramePacing();
+
+#endif
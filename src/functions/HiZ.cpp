@@ -0,0 +1,187 @@
+#include "HiZ.hpp"
+#include "MemoryTracker.hpp"
+#include "Shader.hpp"
+#include <algorithm>
+#include <iostream>
+
+HiZPyramid hiZ;
+bool useOcclusionCulling = true;
+
+namespace {
+
+const GLuint HIZ_GROUP_SIZE = 8;
+
+// Depth-only pass over the static occluder instances (same VAO layout as the static world)
+const char *occluderVertexShader = R"(#version 430 core
+layout(location = 0) in vec3 aPosition;
+layout(location = 3) in mat4 aInstanceModel;
+
+uniform mat4 uViewProjection;
+
+void main() {
+    gl_Position = uViewProjection * aInstanceModel * vec4(aPosition, 1.0);
+}
+)";
+
+const char *occluderFragmentShader = R"(#version 430 core
+void main() {
+}
+)";
+
+// Level 0: depth attachments cannot be bound as images, so fetch through a sampler
+const char *copyComputeShader = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D uDepth;
+layout(r32f, binding = 0) writeonly uniform image2D uTarget;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(uTarget)))) return;
+    imageStore(uTarget, texel, vec4(texelFetch(uDepth, texel, 0).r));
+}
+)";
+
+// Each texel keeps the farthest depth of the 2x2 texels below it
+const char *reduceComputeShader = R"(#version 430 core
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) readonly uniform image2D uSource;
+layout(r32f, binding = 1) writeonly uniform image2D uTarget;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, imageSize(uTarget)))) return;
+    ivec2 source = texel * 2;
+    float depth = max(max(imageLoad(uSource, source).r, imageLoad(uSource, source + ivec2(1, 0)).r),
+                      max(imageLoad(uSource, source + ivec2(0, 1)).r, imageLoad(uSource, source + ivec2(1, 1)).r));
+    imageStore(uTarget, texel, vec4(depth));
+}
+)";
+
+GLint savedViewport[4];
+GLint savedFramebuffer = 0;
+
+GLuint groupCount(GLsizei texels) {
+    return (static_cast<GLuint>(texels) + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE;
+}
+
+}
+
+/**
+ * createHiZ: Allocate the occluder depth target and pyramid (size must be a power of two)
+ */
+bool createHiZ(GLsizei size) {
+    destroyHiZ();
+    if (!GLAD_GL_VERSION_4_3) return false;
+
+    hiZ.occluderProgram = createProgram(occluderVertexShader, occluderFragmentShader);
+    hiZ.copyProgram = createComputeProgram(copyComputeShader);
+    hiZ.reduceProgram = createComputeProgram(reduceComputeShader);
+    if (!hiZ.occluderProgram || !hiZ.copyProgram || !hiZ.reduceProgram) {
+        destroyHiZ();
+        return false;
+    }
+    hiZ.occluderViewProjection = glGetUniformLocation(hiZ.occluderProgram, "uViewProjection");
+
+    hiZ.size = size;
+    hiZ.levels = 1;
+    while ((size >> hiZ.levels) > 0) hiZ.levels++;
+
+    glGenTextures(1, &hiZ.depthTexture);
+    glBindTexture(GL_TEXTURE_2D, hiZ.depthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, size, size);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &hiZ.pyramidTexture);
+    glBindTexture(GL_TEXTURE_2D, hiZ.pyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, hiZ.levels, GL_R32F, size, size);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    size_t pyramidBytes = 0;
+    for (GLsizei level = 0; level < hiZ.levels; level++) {
+        size_t levelSize = static_cast<size_t>(std::max(size >> level, 1));
+        pyramidBytes += levelSize * levelSize * sizeof(float);
+    }
+    trackGpuMemory(GPU_TEXTURE, hiZ.depthTexture, MEMORY_RENDERER, static_cast<size_t>(size) * size * sizeof(float));
+    trackGpuMemory(GPU_TEXTURE, hiZ.pyramidTexture, MEMORY_RENDERER, pyramidBytes);
+
+    glGenFramebuffers(1, &hiZ.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, hiZ.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, hiZ.depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Hi-Z framebuffer incomplete: 0x" << std::hex << status << std::dec << std::endl;
+        destroyHiZ();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * destroyHiZ: Release the pyramid textures, framebuffer and programs
+ */
+void destroyHiZ() {
+    if (hiZ.framebuffer) glDeleteFramebuffers(1, &hiZ.framebuffer);
+    for (GLuint *texture : {&hiZ.depthTexture, &hiZ.pyramidTexture}) {
+        if (!*texture) continue;
+        releaseGpuMemory(GPU_TEXTURE, *texture);
+        glDeleteTextures(1, texture);
+    }
+    if (hiZ.occluderProgram) glDeleteProgram(hiZ.occluderProgram);
+    if (hiZ.copyProgram) glDeleteProgram(hiZ.copyProgram);
+    if (hiZ.reduceProgram) glDeleteProgram(hiZ.reduceProgram);
+    hiZ = HiZPyramid();
+}
+
+/**
+ * beginOccluderPass: Bind and clear the occluder depth target; the caller then draws occluders
+ */
+void beginOccluderPass(const Mat4 &viewProjection) {
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &savedFramebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, hiZ.framebuffer);
+    glViewport(0, 0, hiZ.size, hiZ.size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(hiZ.occluderProgram);
+    glUniformMatrix4fv(hiZ.occluderViewProjection, 1, GL_FALSE, viewProjection.m);
+}
+
+/**
+ * endOccluderPass: Restore the main framebuffer and reduce the occluder depth into the pyramid
+ */
+void endOccluderPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, savedFramebuffer);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+
+    glUseProgram(hiZ.copyProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, hiZ.depthTexture);
+    glBindImageTexture(0, hiZ.pyramidTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(groupCount(hiZ.size), groupCount(hiZ.size), 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glUseProgram(hiZ.reduceProgram);
+    for (GLsizei level = 1; level < hiZ.levels; level++) {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        GLsizei levelSize = std::max(hiZ.size >> level, 1);
+        glBindImageTexture(0, hiZ.pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, hiZ.pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute(groupCount(levelSize), groupCount(levelSize), 1);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glUseProgram(0);
+
+    hiZ.built = true;
+}
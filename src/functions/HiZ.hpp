@@ -0,0 +1,31 @@
+#ifndef HIZ_HPP
+#define HIZ_HPP
+
+#include <glad/glad.h>
+#include "Matrix.hpp"
+
+// Low-resolution depth of the occluders plus a max-reduced mip pyramid of it (GL 4.3)
+struct HiZPyramid {
+    GLuint framebuffer = 0;
+    GLuint depthTexture = 0;
+    GLuint pyramidTexture = 0;
+    GLsizei size = 0;
+    GLsizei levels = 0;
+    GLuint occluderProgram = 0;
+    GLint occluderViewProjection = -1;
+    GLuint copyProgram = 0;
+    GLuint reduceProgram = 0;
+    bool built = false;
+};
+
+extern HiZPyramid hiZ;
+extern bool useOcclusionCulling;
+
+const GLuint HIZ_TEXTURE_UNIT = 1;
+
+bool createHiZ(GLsizei size);
+void destroyHiZ();
+void beginOccluderPass(const Mat4 &viewProjection);
+void endOccluderPass();
+
+#endif
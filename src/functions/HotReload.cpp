@@ -0,0 +1,220 @@
+#include "HotReload.hpp"
+#include "Renderer.hpp"
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+HotReload hotReload;
+
+namespace {
+
+std::string normalizedPath(const std::string &path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::string parentDirectory(const std::string &path) {
+    std::string parent = std::filesystem::path(path).parent_path().generic_string();
+    return parent.empty() ? "." : parent;
+}
+
+// Read every queued event, adding the watched assets they name to changed
+void drainEvents(std::vector<uint32_t> &changed) {
+    HotReload &reload = hotReload;
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(reload.inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) return;
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            auto directory = reload.directories.find(event->wd);
+            if (event->len == 0 || directory == reload.directories.end()) continue;
+
+            std::string path = normalizedPath(directory->second + "/" + event->name);
+            for (uint32_t i = 0; i < reload.assets.size(); i++) {
+                if (reload.assets[i].path == path && std::find(changed.begin(), changed.end(), i) == changed.end()) {
+                    changed.push_back(i);
+                }
+            }
+        }
+    }
+}
+
+// Parse one asset the way startup does; false leaves the current version in place. A half-written file
+// must never take the process down, so anything the parsers throw counts as a failed load too
+bool reparseAsset(uint32_t index, AssetReload &result) {
+    const HotAsset &asset = hotReload.assets[index];
+    auto start = std::chrono::steady_clock::now();
+    result.asset = index;
+    try {
+        if (asset.kind == HOT_ASSET_MESH) {
+            result.mesh = buildMeshData(loadObj(asset.path));
+            if (result.mesh.vertices.empty() || result.mesh.indices.empty()) return false;
+        } else if (!loadCompressedTexture(asset.path, result.texture, result.fromCache)) {
+            return false;
+        }
+    } catch (const std::exception &error) {
+        LOG_ERROR("Hot reload: parsing {} threw: {}", asset.path, error.what());
+        return false;
+    }
+    result.parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void watchLoop() {
+    excludeThreadFromFrameMemory();
+    HotReload &reload = hotReload;
+    pollfd fds[2] = {{reload.inotifyFd, POLLIN, 0}, {reload.wakeFd, POLLIN, 0}};
+    std::vector<uint32_t> changed;
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+
+        changed.clear();
+        drainEvents(changed);
+        int settled;
+        while ((settled = poll(fds, 2, HOT_RELOAD_SETTLE_MS)) != 0) {
+            if (settled < 0 && errno != EINTR) return;
+            if (fds[1].revents) return;
+            drainEvents(changed);
+        }
+
+        for (uint32_t index : changed) {
+            AssetReload result;
+            bool parsed = reparseAsset(index, result);
+            std::lock_guard<std::mutex> lock(reload.mutex);
+            if (!parsed) {
+                reload.failures++;
+                LOG_ERROR("Hot reload: {} did not load, keeping the previous version", reload.assets[index].path);
+                continue;
+            }
+            LOG_INFO("Hot reload: reparsed {} in {} ms", reload.assets[index].path, result.parseMs);
+            reload.ready.push_back(std::move(result));
+        }
+    }
+}
+
+}
+
+/**
+ * watchMeshAsset: Reload mesh and its GPU copy gpu whenever the .obj at path is written (before startHotReload)
+ */
+void watchMeshAsset(const std::string &path, MeshData &mesh, GpuMesh &gpu) {
+    HotAsset asset;
+    asset.path = normalizedPath(path);
+    asset.kind = HOT_ASSET_MESH;
+    asset.mesh = &mesh;
+    asset.gpu = &gpu;
+    hotReload.assets.push_back(asset);
+}
+
+/**
+ * watchTextureAsset: Reload texture whenever the image at path is written (before startHotReload)
+ */
+void watchTextureAsset(const std::string &path, Texture &texture) {
+    HotAsset asset;
+    asset.path = normalizedPath(path);
+    asset.kind = HOT_ASSET_TEXTURE;
+    asset.texture = &texture;
+    hotReload.assets.push_back(asset);
+}
+
+/**
+ * startHotReload: Watch the directories of the registered assets and start the watcher thread
+ * Writes in place and editors' write-then-rename saves are both seen.
+ */
+bool startHotReload() {
+    HotReload &reload = hotReload;
+    reload.inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    reload.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reload.inotifyFd < 0 || reload.wakeFd < 0) {
+        std::cerr << "Cannot start the asset watcher" << std::endl;
+        stopHotReload();
+        return false;
+    }
+
+    for (const HotAsset &asset : reload.assets) {
+        std::string directory = parentDirectory(asset.path);
+        bool watched = std::any_of(reload.directories.begin(), reload.directories.end(),
+                                   [&](const auto &entry) { return entry.second == directory; });
+        if (watched) continue;
+        int wd = inotify_add_watch(reload.inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            std::cerr << "Cannot watch " << directory << std::endl;
+            stopHotReload();
+            return false;
+        }
+        reload.directories[wd] = directory;
+    }
+
+    reload.active = true;
+    reload.watcher = std::thread(watchLoop);
+    LOG_INFO("Hot reload: watching {} assets in {} directories", reload.assets.size(), reload.directories.size());
+    return true;
+}
+
+/**
+ * applyAssetReloads: Swap in the reloads finished since the last frame; call between frames
+ * Returns true when anything changed, so owners of derived data (the static world's fleet) can refresh it.
+ */
+bool applyAssetReloads() {
+    HotReload &reload = hotReload;
+    if (!reload.active) return false;
+    std::vector<AssetReload> finished;
+    {
+        std::unique_lock<std::mutex> lock(reload.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || reload.ready.empty()) return false;
+        finished.swap(reload.ready);
+    }
+
+    for (AssetReload &result : finished) {
+        const HotAsset &asset = reload.assets[result.asset];
+        bool reused;
+        if (asset.kind == HOT_ASSET_MESH) {
+            *asset.mesh = std::move(result.mesh);
+            reused = updateRenderMesh(*asset.gpu, *asset.mesh);
+        } else {
+            reused = updateRenderTexture(*asset.texture, asset.path, result.texture, result.fromCache, result.parseMs);
+        }
+        reload.reloads++;
+        if (reused) reload.storageReused++;
+        LOG_INFO("Hot reload: swapped in {} ({})", asset.path, reused ? "storage reused" : "storage reallocated");
+    }
+    return true;
+}
+
+/**
+ * stopHotReload: Stop the watcher and drop pending reloads; the watched assets stay as they are
+ */
+void stopHotReload() {
+    HotReload &reload = hotReload;
+    if (reload.watcher.joinable()) {
+        uint64_t wake = 1;
+        if (write(reload.wakeFd, &wake, sizeof(wake)) < 0) std::cerr << "Cannot wake the asset watcher" << std::endl;
+        reload.watcher.join();
+    }
+    if (reload.active) {
+        std::cout << "Hot reload: " << reload.reloads << " assets swapped in (" << reload.storageReused
+                  << " reusing their storage), " << reload.failures << " failed to load" << std::endl;
+    }
+    if (reload.inotifyFd >= 0) close(reload.inotifyFd);
+    if (reload.wakeFd >= 0) close(reload.wakeFd);
+    reload.inotifyFd = -1;
+    reload.wakeFd = -1;
+    reload.active = false;
+    reload.directories.clear();
+    reload.ready.clear();
+}
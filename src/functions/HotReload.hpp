@@ -0,0 +1,66 @@
+#ifndef HOT_RELOAD_HPP
+#define HOT_RELOAD_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.hpp"
+#include "TextureCache.hpp"
+
+// How long a changed directory has to stay quiet before its assets are reparsed; editors save in several steps
+const int HOT_RELOAD_SETTLE_MS = 100;
+
+enum HotAssetKind : uint32_t {
+    HOT_ASSET_MESH,
+    HOT_ASSET_TEXTURE
+};
+
+// A watched asset and what a reload replaces: mesh and gpu for meshes, texture for textures
+struct HotAsset {
+    std::string path;
+    HotAssetKind kind;
+    MeshData *mesh = nullptr;
+    GpuMesh *gpu = nullptr;
+    Texture *texture = nullptr;
+};
+
+// One asset reparsed by the watcher thread, waiting for the render thread to swap it in
+struct AssetReload {
+    uint32_t asset;
+    MeshData mesh;
+    CompressedTexture texture;
+    bool fromCache = false;
+    double parseMs = 0.0;
+};
+
+// Assets reloaded when their files change. The watcher thread blocks on inotify and reparses only the
+// assets whose files were written; the render thread try-locks once per frame and swaps finished reloads
+// in between frames, so a reload never stalls rendering.
+struct HotReload {
+    bool active = false;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::vector<HotAsset> assets;
+    std::unordered_map<int, std::string> directories;
+    std::thread watcher;
+
+    std::mutex mutex;
+    std::vector<AssetReload> ready;
+
+    uint32_t reloads = 0;
+    uint32_t storageReused = 0;
+    uint32_t failures = 0;
+};
+
+extern HotReload hotReload;
+
+void watchMeshAsset(const std::string &path, MeshData &mesh, GpuMesh &gpu);
+void watchTextureAsset(const std::string &path, Texture &texture);
+bool startHotReload();
+bool applyAssetReloads();
+void stopHotReload();
+
+#endif
@@ -0,0 +1,268 @@
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+Logger logger;
+
+namespace {
+
+const auto writerPollInterval = std::chrono::milliseconds(1);
+
+// Each thread's queue lives until exit; records made while the logger is stopped are written directly
+thread_local LogQueue *threadQueue = nullptr;
+thread_local LogRecord directRecord;
+thread_local bool directPending = false;
+
+struct PendingRecord {
+    const LogRecord *record;
+    LogQueue *queue;
+};
+
+const char *levelName(LogLevel level) {
+    switch (level) {
+        case LOG_LEVEL_TRACE: return "TRACE";
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO: return "INFO";
+        case LOG_LEVEL_WARN: return "WARN";
+        case LOG_LEVEL_ERROR: return "ERROR";
+    }
+    return "?";
+}
+
+LogQueue *queueForThisThread() {
+    if (!threadQueue) {
+        std::lock_guard<std::mutex> lock(logger.queuesMutex);
+        logger.queues.push_back(std::make_unique<LogQueue>());
+        threadQueue = logger.queues.back().get();
+    }
+    return threadQueue;
+}
+
+// "[seconds] LEVEL message" with the {} placeholders filled in order; INFO lines omit the level
+void formatRecord(const LogRecord &record, std::string &line) {
+    char buffer[64];
+    line.clear();
+    std::snprintf(buffer, sizeof(buffer), "[%9.3f] ", record.timestampNs * 1e-9);
+    line += buffer;
+    if (record.level != LOG_LEVEL_INFO) {
+        line += levelName(record.level);
+        line += ' ';
+    }
+
+    uint8_t arg = 0;
+    for (const char *c = record.format; *c; c++) {
+        if (c[0] != '{' || c[1] != '}' || arg >= record.argCount) {
+            line += *c;
+            continue;
+        }
+        const LogArgValue &value = record.args[arg];
+        switch (record.types[arg]) {
+            case LOG_ARG_INT: std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value.i)); break;
+            case LOG_ARG_UINT: std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value.u)); break;
+            case LOG_ARG_DOUBLE: std::snprintf(buffer, sizeof(buffer), "%g", value.d); break;
+            case LOG_ARG_TEXT: buffer[0] = '\0'; line += record.text + value.textOffset; break;
+        }
+        line += buffer;
+        arg++;
+        c++;
+    }
+    line += '\n';
+}
+
+void writeLine(const LogRecord &record, const std::string &line) {
+    std::fputs(line.c_str(), record.level >= LOG_LEVEL_WARN ? stderr : stdout);
+}
+
+// Scratch space of the writer thread, kept across drains so the writer does not allocate while idle
+struct DrainScratch {
+    std::vector<LogQueue *> queues;
+    std::vector<uint32_t> heads;
+    std::vector<PendingRecord> pending;
+    std::string line;
+};
+
+// Write everything queued so far, merged across threads by timestamp; false when nothing was queued
+bool drainQueues(DrainScratch &scratch) {
+    std::vector<LogQueue *> &queues = scratch.queues;
+    std::vector<PendingRecord> &pending = scratch.pending;
+    {
+        std::lock_guard<std::mutex> lock(logger.queuesMutex);
+        queues.clear();
+        for (const auto &queue : logger.queues) queues.push_back(queue.get());
+    }
+
+    pending.clear();
+    scratch.heads.resize(queues.size());
+    for (size_t i = 0; i < queues.size(); i++) {
+        LogQueue *queue = queues[i];
+        scratch.heads[i] = queue->head.load(std::memory_order_acquire);
+        for (uint32_t tail = queue->tail.load(std::memory_order_relaxed); tail != scratch.heads[i]; tail++) {
+            pending.push_back({&queue->records[tail % LOG_QUEUE_CAPACITY], queue});
+        }
+    }
+    if (pending.empty()) return false;
+
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingRecord &a, const PendingRecord &b) {
+        return a.record->timestampNs < b.record->timestampNs;
+    });
+    // The log benchmark times the callers only; its events are drained without being written
+    if (!logger.discarding.load(std::memory_order_acquire)) {
+        for (const PendingRecord &entry : pending) {
+            formatRecord(*entry.record, scratch.line);
+            writeLine(*entry.record, scratch.line);
+        }
+    }
+    std::fflush(stdout);
+    std::fflush(stderr);
+    for (size_t i = 0; i < queues.size(); i++) queues[i]->tail.store(scratch.heads[i], std::memory_order_release);
+    return true;
+}
+
+void writerLoop() {
+    excludeThreadFromFrameMemory();
+    DrainScratch scratch;
+    for (;;) {
+        bool stopping = logger.stopping.load(std::memory_order_acquire);
+        uint64_t flushRequest = logger.flushRequests.load(std::memory_order_acquire);
+        bool wrote = drainQueues(scratch);
+        logger.flushesDone.store(flushRequest, std::memory_order_release);
+        if (stopping && !wrote) break;
+        if (!wrote) std::this_thread::sleep_for(writerPollInterval);
+    }
+}
+
+}
+
+/**
+ * startLogger: Start the writer thread; queued events are also written out at exit
+ */
+void startLogger() {
+    if (logger.running.load()) return;
+    logger.stopping.store(false);
+    logger.writer = std::thread(writerLoop);
+    logger.running.store(true, std::memory_order_release);
+
+    static bool registered = false;
+    if (!registered) std::atexit(stopLogger);
+    registered = true;
+}
+
+/**
+ * stopLogger: Write out everything queued, stop the writer thread and report dropped events
+ */
+void stopLogger() {
+    if (!logger.running.exchange(false)) return;
+    logger.stopping.store(true, std::memory_order_release);
+    logger.writer.join();
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(logger.queuesMutex);
+        for (const auto &queue : logger.queues) dropped += queue->dropped.load();
+    }
+    if (dropped > 0) std::fprintf(stderr, "Log: %llu events dropped on full queues\n", static_cast<unsigned long long>(dropped));
+}
+
+/**
+ * flushLog: Wait until every event logged before the call has been written
+ * Use before printing straight to stdout so the output stays in order.
+ */
+void flushLog() {
+    if (!logger.running.load(std::memory_order_acquire)) return;
+    uint64_t request = logger.flushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+    while (logger.flushesDone.load(std::memory_order_acquire) < request) std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+/**
+ * beginLogRecord: Claim the next record in this thread's queue; nullptr (and a dropped count) when it is full
+ */
+LogRecord *beginLogRecord(LogLevel level, const char *format) {
+    LogRecord *record;
+    if (logger.running.load(std::memory_order_relaxed)) {
+        LogQueue *queue = queueForThisThread();
+        uint32_t head = queue->head.load(std::memory_order_relaxed);
+        if (head - queue->tail.load(std::memory_order_acquire) == LOG_QUEUE_CAPACITY) {
+            queue->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        record = &queue->records[head % LOG_QUEUE_CAPACITY];
+    } else {
+        record = &directRecord;
+        directPending = true;
+    }
+
+    record->timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - logger.origin).count());
+    record->format = format;
+    record->level = level;
+    record->argCount = 0;
+    record->textUsed = 0;
+    return record;
+}
+
+/**
+ * commitLogRecord: Publish the record claimed by beginLogRecord to the writer thread
+ */
+void commitLogRecord() {
+    if (directPending) {
+        directPending = false;
+        writeLogRecordNow(directRecord);
+        return;
+    }
+    threadQueue->head.store(threadQueue->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * writeLogRecordNow: Format and write a record on the calling thread
+ */
+void writeLogRecordNow(const LogRecord &record) {
+    std::string line;
+    formatRecord(record, line);
+    writeLine(record, line);
+}
+
+/**
+ * runLogBenchmark: Time LOG_INFO calls with a number, a double and a string, as the caller sees them
+ * Events go out in bursts of half a queue with a flush in between, so none is dropped and every call
+ * takes the normal queueing path; the writer discards them instead of printing.
+ */
+void runLogBenchmark(uint32_t events) {
+    const uint32_t burst = LOG_QUEUE_CAPACITY / 2;
+    flushLog();
+    logger.discarding.store(true, std::memory_order_release);
+
+    double totalNs = 0.0, bestNs = 1e30;
+    for (uint32_t first = 0; first < events; first += burst) {
+        uint32_t count = std::min(burst, events - first);
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = first; i < first + count; i++) LOG_INFO("Benchmark event {} at {} ms: {}", i, i * 0.25, "cruise");
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        totalNs += ns;
+        bestNs = std::min(bestNs, ns / count);
+        flushLog();
+    }
+    logger.discarding.store(false, std::memory_order_release);
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(logger.queuesMutex);
+        for (const auto &queue : logger.queues) dropped += queue->dropped.load();
+    }
+    std::printf("Log benchmark: %u events in bursts of %u, %.1f ns per call on average, %.1f ns in the fastest burst, "
+                "%llu dropped\n", events, burst, totalNs / events, bestNs, static_cast<unsigned long long>(dropped));
+}
+
+/**
+ * packLogText: Copy a string argument into the record, truncating once its text buffer is full
+ */
+void packLogText(LogRecord &record, std::string_view text) {
+    size_t room = LOG_TEXT_BYTES - 1 - record.textUsed;
+    size_t length = std::min(text.size(), room);
+    record.types[record.argCount] = LOG_ARG_TEXT;
+    record.args[record.argCount++].textOffset = record.textUsed;
+    std::memcpy(record.text + record.textUsed, text.data(), length);
+    record.text[record.textUsed + length] = '\0';
+    record.textUsed = static_cast<uint8_t>(record.textUsed + length + (room > length ? 1 : 0));
+}
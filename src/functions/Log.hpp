@@ -0,0 +1,134 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum LogLevel : uint8_t {
+    LOG_LEVEL_TRACE = 0,
+    LOG_LEVEL_DEBUG = 1,
+    LOG_LEVEL_INFO = 2,
+    LOG_LEVEL_WARN = 3,
+    LOG_LEVEL_ERROR = 4
+};
+
+// Calls below this level are compiled out (override with -DLOG_COMPILED_LEVEL=0 for trace builds)
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL 2
+#endif
+
+#define LOG_AT(level, ...) \
+    do { \
+        if constexpr ((level) >= LOG_COMPILED_LEVEL) logEvent((level), __VA_ARGS__); \
+    } while (0)
+#define LOG_TRACE(...) LOG_AT(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+const int LOG_MAX_ARGS = 6;
+const int LOG_TEXT_BYTES = 96;
+const uint32_t LOG_QUEUE_CAPACITY = 1024;
+
+enum LogArgType : uint8_t {
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_TEXT
+};
+
+union LogArgValue {
+    int64_t i;
+    uint64_t u;
+    double d;
+    uint32_t textOffset;
+};
+
+// Binary log event: the format is a string literal with {} placeholders, formatted later by the writer
+// thread; numbers are stored raw and strings are copied into text (truncated when it runs out)
+struct LogRecord {
+    uint64_t timestampNs;
+    const char *format;
+    LogLevel level;
+    uint8_t argCount;
+    uint8_t textUsed;
+    LogArgType types[LOG_MAX_ARGS];
+    LogArgValue args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_BYTES];
+};
+
+// Single-producer/single-consumer ring owned by one logging thread; full rings drop and count
+struct LogQueue {
+    LogRecord records[LOG_QUEUE_CAPACITY];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+// Asynchronous logger: every thread gets its own queue on first use, one writer thread drains them all
+struct Logger {
+    std::mutex queuesMutex;
+    std::vector<std::unique_ptr<LogQueue>> queues;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> flushRequests{0};
+    std::atomic<uint64_t> flushesDone{0};
+    std::atomic<bool> discarding{false};
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+extern Logger logger;
+
+void startLogger();
+void stopLogger();
+void flushLog();
+LogRecord *beginLogRecord(LogLevel level, const char *format);
+void commitLogRecord();
+void writeLogRecordNow(const LogRecord &record);
+void runLogBenchmark(uint32_t events);
+
+void packLogText(LogRecord &record, std::string_view text);
+
+template <typename T>
+void packLogArg(LogRecord &record, const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        packLogText(record, value ? "true" : "false");
+    } else if constexpr (std::is_floating_point_v<T>) {
+        record.types[record.argCount] = LOG_ARG_DOUBLE;
+        record.args[record.argCount++].d = static_cast<double>(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        record.types[record.argCount] = LOG_ARG_INT;
+        record.args[record.argCount++].i = static_cast<int64_t>(value);
+    } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        record.types[record.argCount] = LOG_ARG_UINT;
+        record.args[record.argCount++].u = static_cast<uint64_t>(value);
+    } else {
+        packLogText(record, std::string_view(value));
+    }
+}
+
+/**
+ * logEvent: Queue an event for the writer thread without locking, allocating or formatting
+ * Use the LOG_* macros so calls below LOG_COMPILED_LEVEL disappear.
+ */
+template <typename... Args>
+void logEvent(LogLevel level, const char *format, const Args &...args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    LogRecord *record = beginLogRecord(level, format);
+    if (!record) return;
+    (packLogArg(record[0], args), ...);
+    commitLogRecord();
+}
+
+#endif
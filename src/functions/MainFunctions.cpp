@@ -1,16 +1,121 @@
 #include "MainFunctions.hpp"
+#include "Mesh.hpp"
+#include "HiZ.hpp"
+#include "Renderer.hpp"
+#include "Stats.hpp"
+#include "Rewind.hpp"
+#include "WorldGen.hpp"
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include "Terrain.hpp"
+#include "AssetPack.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <spanstream>
 #include <cmath>
 #include <limits>
+#include <algorithm>
 #include <cstdlib>
-#include <ctime>
+#include <charconv>
+#include <string_view>
 
 // Camera and plane initialization
 Camera camera = {20.0f, 0.0f, 0.0, 0.0, false};
-PlaneState planeState = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
-std::vector<Cube> referenceCubes;
+Entity playerPlane;
+
+namespace {
+
+// The plane reset goes through the tick inputs (INPUT_RESET) so recordings capture it
+bool planeResetRequested = false;
+
+// Move whole sectors out of an offset once it leaves (-WORLD_SECTOR_SIZE, WORLD_SECTOR_SIZE). The offset has
+// just crossed a power of two there, so subtracting the sector size from it is exact
+void rebaseAxis(float &offset, int32_t &sector) {
+    if (std::fabs(offset) < WORLD_SECTOR_SIZE) return;
+    int32_t sectors = static_cast<int32_t>(offset / WORLD_SECTOR_SIZE);
+    offset -= static_cast<float>(sectors) * WORLD_SECTOR_SIZE;
+    sector += sectors;
+}
+
+// One .obj index field: 1-based, or negative to count back from the last element read so far.
+// False on anything that isn't a number or doesn't name an existing element
+bool parseObjIndex(std::string_view text, size_t count, int &index) {
+    long value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || value == 0) return false;
+    long resolved = value > 0 ? value - 1 : static_cast<long>(count) + value;
+    if (resolved < 0 || resolved >= static_cast<long>(count)) return false;
+    index = static_cast<int>(resolved);
+    return true;
+}
+
+void rebaseToSector(PlaneState &plane) {
+    rebaseAxis(plane.posX, plane.sectorX);
+    rebaseAxis(plane.posY, plane.sectorY);
+    rebaseAxis(plane.posZ, plane.sectorZ);
+}
+
+void flyPlane(PlaneState &plane, uint32_t inputs, float deltaTime) {
+    float acceleration = 3.0f * deltaTime;
+    float turnSpeed = 80.0f * deltaTime;
+    float maxSpeed = 8.0f;
+    
+    if (inputs & INPUT_RESET) {
+        plane = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0, 0};
+    }
+    
+    // W/S for throttle control
+    if (inputs & INPUT_THROTTLE_UP) {
+        plane.speed += acceleration;
+        if (plane.speed > maxSpeed) plane.speed = maxSpeed;
+    }
+    if (inputs & INPUT_THROTTLE_DOWN) {
+        plane.speed -= acceleration * 0.5f;
+        if (plane.speed < 0.0f) plane.speed = 0.0f;
+    }
+    
+    plane.speed *= 0.995f;
+    
+    if (inputs & INPUT_PITCH_UP) {
+        plane.rotX += turnSpeed;
+    }
+    if (inputs & INPUT_PITCH_DOWN) {
+        plane.rotX -= turnSpeed;
+    }
+    if (inputs & INPUT_ROLL_LEFT) {
+        plane.rotZ += turnSpeed;
+    }
+    if (inputs & INPUT_ROLL_RIGHT) {
+        plane.rotZ -= turnSpeed;
+    }
+    
+    if (inputs & INPUT_YAW_LEFT) {
+        plane.rotY += turnSpeed * 0.8f;
+    }
+    if (inputs & INPUT_YAW_RIGHT) {
+        plane.rotY -= turnSpeed * 0.8f;
+    }
+    
+    if (plane.rotX > 60.0f) plane.rotX = 60.0f;
+    if (plane.rotX < -60.0f) plane.rotX = -60.0f;
+    if (plane.rotZ > 60.0f) plane.rotZ = 60.0f;
+    if (plane.rotZ < -60.0f) plane.rotZ = -60.0f;
+    
+    float pitchRad = plane.rotX * M_PI / 180.0f;
+    float yawRad = plane.rotY * M_PI / 180.0f;
+    
+    float forwardX = sin(yawRad) * cos(pitchRad);
+    float forwardY = -sin(pitchRad);
+    float forwardZ = -cos(yawRad) * cos(pitchRad);
+    
+    plane.posX += forwardX * plane.speed * deltaTime;
+    plane.posY += forwardY * plane.speed * deltaTime;
+    plane.posZ += forwardZ * plane.speed * deltaTime;
+    rebaseToSector(plane);
+}
+
+}
 
 /**
  * createWindow: Create window
@@ -40,14 +145,36 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
         camera.rotationX = 20.0f;
         camera.rotationY = 0.0f;
-        planeState.posX = 0.0f;
-        planeState.posY = 0.0f;
-        planeState.posZ = 0.0f;
-        planeState.rotX = 0.0f;
-        planeState.rotY = 0.0f;
-        planeState.rotZ = 0.0f;
-        planeState.speed = 0.0f;
-        std::cout << "Camera and plane reset" << std::endl;
+        planeResetRequested = true;
+        LOG_INFO("Camera and plane reset");
+        logMemoryCheckpoint("reset");
+    }
+
+    if (key == GLFW_KEY_BACKSPACE && action == GLFW_PRESS) {
+        requestRewind(REWIND_STEP_SECONDS);
+    }
+
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        printStats = !printStats;
+    }
+
+    if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+        usePackedVertices = !usePackedVertices;
+        LOG_INFO("Vertex format: {}", usePackedVertices ? "packed" : "float");
+    }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        if (!gpuCullingAvailable()) {
+            LOG_WARN("GPU culling unavailable (requires OpenGL 4.3 compute shaders)");
+        } else {
+            useGpuCulling = !useGpuCulling;
+            LOG_INFO("Static world culling: {}", useGpuCulling ? "GPU" : "CPU");
+        }
+    }
+
+    if (key == GLFW_KEY_O && action == GLFW_PRESS) {
+        useOcclusionCulling = !useOcclusionCulling;
+        LOG_INFO("Occlusion culling: {}", useOcclusionCulling ? "on" : "off");
     }
 }
 
@@ -84,190 +211,134 @@ void cursorPosCallback(GLFWwindow* /*window*/, double xpos, double ypos) {
     }
 }
 
+namespace {
+
+// Headless runs have no window, so every key reads as released
+bool isKeyDown(GLFWwindow *window, int key) {
+    return window && glfwGetKey(window, key) == GLFW_PRESS;
+}
+
+}
+
 /**
- * updatePlaneControls: Handle WASD and arrow key controls with REAL flight physics
+ * readPlaneInputs: Sample the flight keys into a PlaneInput bitmask
  */
-void updatePlaneControls(GLFWwindow* window, float deltaTime) {
-    float acceleration = 3.0f * deltaTime;
-    float turnSpeed = 80.0f * deltaTime;
-    float maxSpeed = 8.0f;
-    
-    // W/S for throttle control
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        planeState.speed += acceleration;
-        if (planeState.speed > maxSpeed) planeState.speed = maxSpeed;
+uint32_t readPlaneInputs(GLFWwindow* window) {
+    const struct { int key; PlaneInput input; } bindings[] = {
+        {GLFW_KEY_W, INPUT_THROTTLE_UP}, {GLFW_KEY_S, INPUT_THROTTLE_DOWN},
+        {GLFW_KEY_UP, INPUT_PITCH_UP}, {GLFW_KEY_DOWN, INPUT_PITCH_DOWN},
+        {GLFW_KEY_LEFT, INPUT_ROLL_LEFT}, {GLFW_KEY_RIGHT, INPUT_ROLL_RIGHT},
+        {GLFW_KEY_A, INPUT_YAW_LEFT}, {GLFW_KEY_D, INPUT_YAW_RIGHT},
+    };
+    uint32_t inputs = 0;
+    for (const auto &binding : bindings) {
+        if (isKeyDown(window, binding.key)) inputs |= binding.input;
     }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        planeState.speed -= acceleration * 0.5f;
-        if (planeState.speed < 0.0f) planeState.speed = 0.0f;
+    if (planeResetRequested) {
+        inputs |= INPUT_RESET;
+        planeResetRequested = false;
     }
-    
-    planeState.speed *= 0.995f;
-    
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        planeState.rotX += turnSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-        planeState.rotX -= turnSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-        planeState.rotZ += turnSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-        planeState.rotZ -= turnSpeed;
-    }
-    
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        planeState.rotY += turnSpeed * 0.8f;
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        planeState.rotY -= turnSpeed * 0.8f;
-    }
-    
-    if (planeState.rotX > 60.0f) planeState.rotX = 60.0f;
-    if (planeState.rotX < -60.0f) planeState.rotX = -60.0f;
-    if (planeState.rotZ > 60.0f) planeState.rotZ = 60.0f;
-    if (planeState.rotZ < -60.0f) planeState.rotZ = -60.0f;
-    
-    float pitchRad = planeState.rotX * M_PI / 180.0f;
-    float yawRad = planeState.rotY * M_PI / 180.0f;
-    
-    float forwardX = sin(yawRad) * cos(pitchRad);
-    float forwardY = -sin(pitchRad);
-    float forwardZ = -cos(yawRad) * cos(pitchRad);
-    
-    planeState.posX += forwardX * planeState.speed * deltaTime;
-    planeState.posY += forwardY * planeState.speed * deltaTime;
-    planeState.posZ += forwardZ * planeState.speed * deltaTime;
+    return inputs;
 }
 
 /**
- * generateReferenceCubes: Create random cubes in space
+ * spawnPlayerPlane: Create the player's aircraft entity at the origin (before anything reads planeState)
  */
-void generateReferenceCubes() {
-    srand(static_cast<unsigned>(time(0)));
-    referenceCubes.clear();
-    
-    for (int i = 0; i < 80; i++) {
-        Cube cube;
-        cube.x = (rand() % 200 - 100) * 0.5f;
-        cube.y = (rand() % 40 + 2) * 0.3f;
-        cube.z = (rand() % 200 - 100) * 0.5f;
-        cube.size = 0.3f + (rand() % 15) * 0.1f;
-        
-        // More colorful cubes
-        cube.r = 0.4f + (rand() % 60) * 0.01f;
-        cube.g = 0.4f + (rand() % 60) * 0.01f;
-        cube.b = 0.4f + (rand() % 60) * 0.01f;
-        referenceCubes.push_back(cube);
-    }
-    
-    std::cout << "Generated " << referenceCubes.size() << " reference cubes" << std::endl;
+void spawnPlayerPlane() {
+    playerPlane = createEntity(world, PlaneState{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0, 0}, PlaneControls{0});
 }
 
 /**
- * renderGroundGrid: Draw a grid on the ground for spatial reference
+ * planeState: The player's flight state
  */
-void renderGroundGrid() {
-    glColor3f(0.3f, 0.4f, 0.3f);
-    glBegin(GL_LINES);
-    
-    float gridSize = 100.0f;
-    float gridStep = 5.0f;
-    float groundY = -2.0f;
-    
-    for (float z = -gridSize; z <= gridSize; z += gridStep) {
-        float relZ = z - planeState.posZ;
-        glVertex3f(-gridSize - planeState.posX, groundY - planeState.posY, relZ);
-        glVertex3f(gridSize - planeState.posX, groundY - planeState.posY, relZ);
-    }
-    
-    for (float x = -gridSize; x <= gridSize; x += gridStep) {
-        float relX = x - planeState.posX;
-        glVertex3f(relX, groundY - planeState.posY, -gridSize - planeState.posZ);
-        glVertex3f(relX, groundY - planeState.posY, gridSize - planeState.posZ);
-    }
-    
-    glEnd();
+PlaneState &planeState() {
+    return *getComponent<PlaneState>(world, playerPlane);
 }
 
 /**
- * renderCube: Draw a single cube
+ * updatePlaneControls: Apply one tick of flight inputs with REAL flight physics
+ * The player flies with inputs; every other aircraft entity with controls flies with its own.
  */
-void renderCube(const Cube &cube) {
-    float s = cube.size / 2.0f;
-    
-    glColor3f(cube.r, cube.g, cube.b);
-    
-    glBegin(GL_QUADS);
-    
-    // Front face
-    glVertex3f(cube.x - s, cube.y - s, cube.z + s);
-    glVertex3f(cube.x + s, cube.y - s, cube.z + s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z + s);
-    glVertex3f(cube.x - s, cube.y + s, cube.z + s);
-    
-    // Back face
-    glVertex3f(cube.x - s, cube.y - s, cube.z - s);
-    glVertex3f(cube.x - s, cube.y + s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y - s, cube.z - s);
-    
-    // Top face
-    glVertex3f(cube.x - s, cube.y + s, cube.z - s);
-    glVertex3f(cube.x - s, cube.y + s, cube.z + s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z + s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z - s);
-    
-    // Bottom face
-    glVertex3f(cube.x - s, cube.y - s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y - s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y - s, cube.z + s);
-    glVertex3f(cube.x - s, cube.y - s, cube.z + s);
-    
-    // Right face
-    glVertex3f(cube.x + s, cube.y - s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z - s);
-    glVertex3f(cube.x + s, cube.y + s, cube.z + s);
-    glVertex3f(cube.x + s, cube.y - s, cube.z + s);
-    
-    // Left face
-    glVertex3f(cube.x - s, cube.y - s, cube.z - s);
-    glVertex3f(cube.x - s, cube.y - s, cube.z + s);
-    glVertex3f(cube.x - s, cube.y + s, cube.z + s);
-    glVertex3f(cube.x - s, cube.y + s, cube.z - s);
-    
-    glEnd();
+void updatePlaneControls(uint32_t inputs, float deltaTime) {
+    getComponent<PlaneControls>(world, playerPlane)->inputs = inputs;
+    forEach<PlaneState, const PlaneControls>(world, [&](PlaneState &plane, const PlaneControls &controls) {
+        flyPlane(plane, controls.inputs, deltaTime);
+    });
 }
 
 /**
- * renderReferenceCubes: Draw all reference cubes relative to plane position
+ * generateReferenceCubes: Scatter the reference cubes over the regions around the origin (the same cubes for the same seed)
  */
-void renderReferenceCubes() {
-    for (const Cube &cube : referenceCubes) {
-        Cube relativeCube = cube;
-        relativeCube.x -= planeState.posX;
-        relativeCube.y -= planeState.posY;
-        relativeCube.z -= planeState.posZ;
-        renderCube(relativeCube);
+void generateReferenceCubes(unsigned seed) {
+    MemoryScope scope(MEMORY_WORLD);
+    std::vector<Cube> cubes;
+    generateRegionGrid(seed, REFERENCE_REGION_MIN, REFERENCE_REGION_MAX, REFERENCE_CUBES_PER_REGION, cubes);
+    for (const Cube &cube : cubes) createEntity(world, cube);
+    LOG_INFO("Generated {} reference cubes (seed {})", cubes.size(), seed);
+}
+
+/**
+ * sectorToCamera: Translation from the corner of a world sector to the player's aircraft
+ * Worked out in double once per frame, so what is drawn near the camera gets small, exact float coordinates
+ * however far from the origin it is; vertex data and per-object matrices stay float.
+ */
+Mat4 sectorToCamera(int32_t sectorX, int32_t sectorY, int32_t sectorZ) {
+    const PlaneState &plane = planeState();
+    double size = WORLD_SECTOR_SIZE;
+    double x = (static_cast<double>(sectorX) - plane.sectorX) * size - plane.posX;
+    double y = (static_cast<double>(sectorY) - plane.sectorY) * size - plane.posY;
+    double z = (static_cast<double>(sectorZ) - plane.sectorZ) * size - plane.posZ;
+    return mat4Translate(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+}
+
+/**
+ * renderGroundGrid: Draw the streamed elevation tiles when terrain is loaded, else the flat grid chunks
+ */
+void renderGroundGrid(const Mat4 &origin) {
+    if (terrain.active) {
+        renderTerrain();
+        return;
     }
+    submitStaticLayer(STATIC_TERRAIN, modelStack.top() * origin);
 }
 
 /**
- * loadObj: read .obj files
+ * renderReferenceCubes: Draw all reference cubes, origin placing their sector relative to the camera
+ */
+void renderReferenceCubes(const Mat4 &origin) {
+    submitStaticLayer(STATIC_OBSTACLES, modelStack.top() * origin);
+}
+
+/**
+ * renderParkedAircraft: Draw the parked fleet, origin placing its sector relative to the camera
+ */
+void renderParkedAircraft(const Mat4 &origin) {
+    submitStaticLayer(STATIC_FLEET, modelStack.top() * origin);
+}
+
+/**
+ * loadObj: read .obj files, from the asset pack when it holds the path
  */
 Model loadObj(const std::string &filepath) {
-    Model model;
-    std::ifstream file(filepath);
+    MemoryScope scope(MEMORY_LOADER);
+    Model model = {};
+    AssetView packed;
+    bool isPacked = readPackedAsset(filepath, packed);
+    std::ispanstream packedStream(std::span<const char>(reinterpret_cast<const char *>(packed.data), packed.size));
+    std::ifstream file;
+    if (!isPacked) file.open(filepath);
 
-    if (!file.is_open()) {
-        std::cerr << "Cannot open: " << filepath << std::endl;
+    if (!isPacked && !file.is_open()) {
+        LOG_ERROR("Cannot open: {}", filepath);
         return model;
     }
 
+    std::istream &input = isPacked ? static_cast<std::istream &>(packedStream) : file;
     std::string line;
+    size_t lineNumber = 0;
 
-    while (std::getline(file, line)) {
+    while (std::getline(input, line)) {
+        lineNumber++;
         std::istringstream iss(line);
         std::string type;
         iss >> type;
@@ -276,22 +347,49 @@ Model loadObj(const std::string &filepath) {
             Vertex v;
             iss >> v.x >> v.y >> v.z;
             model.vertices.push_back(v);
+        } else if (type == "vt") {
+            TexCoord t = {0.0f, 0.0f};
+            iss >> t.u >> t.v;
+            model.texcoords.push_back(t);
+        } else if (type == "vn") {
+            Vertex n;
+            iss >> n.x >> n.y >> n.z;
+            model.normals.push_back(n);
         } else if (type=="f") {
-            Face f;
-            std::string v1, v2, v3;
-            iss >> v1 >> v2 >> v3;
-            
-            f.v1 = std::stoi(v1.substr(0, v1.find('/'))) - 1;
-            f.v2 = std::stoi(v2.substr(0, v2.find('/'))) - 1;
-            f.v3 = std::stoi(v3.substr(0, v3.find('/'))) - 1;
-            
-            model.faces.push_back(f);
+            // Corners are v, v/vt, v//vn or v/vt/vn; polygons are split into a fan.
+            // A bad corner fails the whole file rather than leaving a model with dangling indices
+            std::vector<int> corners;
+            std::string token;
+            while (iss >> token) {
+                std::string_view text = token;
+                size_t slash1 = text.find('/');
+                size_t slash2 = slash1 == std::string_view::npos ? std::string_view::npos : text.find('/', slash1 + 1);
+                int v = -1, t = -1, n = -1;
+                bool valid = parseObjIndex(text.substr(0, slash1), model.vertices.size(), v);
+                if (valid && slash1 != std::string_view::npos && slash1 + 1 < text.size() && text[slash1 + 1] != '/') {
+                    valid = parseObjIndex(text.substr(slash1 + 1, slash2 - slash1 - 1), model.texcoords.size(), t);
+                }
+                if (valid && slash2 != std::string_view::npos && slash2 + 1 < text.size()) {
+                    valid = parseObjIndex(text.substr(slash2 + 1), model.normals.size(), n);
+                }
+                if (!valid) {
+                    LOG_ERROR("{}:{}: invalid face corner {}", filepath, lineNumber, token);
+                    return Model();
+                }
+                corners.insert(corners.end(), {v, t, n});
+            }
+
+            for (size_t i = 3; i + 3 < corners.size(); i += 3) {
+                Face f = {corners[0], corners[i], corners[i + 3],
+                          corners[1], corners[i + 1], corners[i + 4],
+                          corners[2], corners[i + 2], corners[i + 5]};
+                model.faces.push_back(f);
+            }
         }
     }
 
     file.close();
-    std::cout << "Loaded: " << model.vertices.size() << " vertices, " 
-              << model.faces.size() << " triangles" << std::endl;
+    LOG_INFO("Loaded: {} vertices, {} triangles", model.vertices.size(), model.faces.size());
     
     if (!model.vertices.empty()) {
         float minX = model.vertices[0].x, maxX = model.vertices[0].x;
@@ -318,8 +416,8 @@ Model loadObj(const std::string &filepath) {
         
         float scale = 2.0f / maxSize;
         
-        std::cout << "Model size: " << sizeX << " x " << sizeY << " x " << sizeZ << std::endl;
-        std::cout << "Scaling by: " << scale << std::endl;
+        LOG_INFO("Model size: {} x {} x {}", sizeX, sizeY, sizeZ);
+        LOG_INFO("Scaling by: {}", scale);
         
         for (Vertex &v : model.vertices) {
             v.x = (v.x - centerX) * scale;
@@ -327,27 +425,18 @@ Model loadObj(const std::string &filepath) {
             v.z = (v.z - centerZ) * scale;
         }
         
-        std::cout << "Model normalized and centered" << std::endl;
+        model.boundsMin = {(minX - centerX) * scale, (minY - centerY) * scale, (minZ - centerZ) * scale};
+        model.boundsMax = {(maxX - centerX) * scale, (maxY - centerY) * scale, (maxZ - centerZ) * scale};
+
+        LOG_INFO("Model normalized and centered");
     }
     
     return model;
 }
 
 /**
- * renderModel: draw model
+ * renderModel: draw model with the current model matrix
  */
-void renderModel(const Model &model) {
-    glBegin(GL_TRIANGLES);
-
-    for (const Face &face : model.faces) {
-        const Vertex &v1 = model.vertices[face.v1];
-        const Vertex &v2 = model.vertices[face.v2];
-        const Vertex &v3 = model.vertices[face.v3];
-
-        glVertex3f(v1.x, v1.y, v1.z);
-        glVertex3f(v2.x, v2.y, v2.z);
-        glVertex3f(v3.x, v3.y, v3.z);
-    }
-
-    glEnd();
-}
\ No newline at end of file
+void renderModel(const GpuMesh &mesh, const Texture &texture) {
+    submitMesh(mesh, texture, modelStack.top());
+}
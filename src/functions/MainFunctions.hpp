@@ -1,12 +1,19 @@
 #ifndef MAIN_FUNCTIONS_HPP
 #define MAIN_FUNCTIONS_HPP
 
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <iostream>
 #include <math.h>
+#include "Ecs.hpp"
+#include "Matrix.hpp"
+
+struct GpuMesh;
+struct Texture;
 
 GLFWwindow* createWindow(int width, int height, const std::string &title);
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
@@ -17,13 +24,23 @@ struct Vertex {
     float x, y, z;
 };
 
+struct TexCoord {
+    float u, v;
+};
+
+// Texture coordinate and normal indices are -1 when the .obj omits them
 struct Face {
     int v1, v2, v3;
+    int t1, t2, t3;
+    int n1, n2, n3;
 };
 
 struct Model {
     std::vector<Vertex> vertices;
+    std::vector<TexCoord> texcoords;
+    std::vector<Vertex> normals;
     std::vector<Face> faces;
+    Vertex boundsMin, boundsMax;
 };
 
 struct Camera {
@@ -34,12 +51,40 @@ struct Camera {
     bool isDragging;
 };
 
+// Side of the cubic sectors large-world positions are split into
+const float WORLD_SECTOR_SIZE = 1024.0f;
+
+// Flight state of an aircraft entity. The position is a float offset from the corner of a world sector,
+// so it keeps the same precision however far the aircraft flies from the origin
 struct PlaneState {
     float posX, posY, posZ;
     float rotX, rotY, rotZ;
     float speed;
+    int32_t sectorX, sectorY, sectorZ;
 };
 
+// Tick inputs an aircraft entity flies with; the player's come from the keyboard or a replay
+struct PlaneControls {
+    uint32_t inputs;
+};
+
+// Flight controls sampled once per tick; the bits are stored in flight logs, so keep their values
+enum PlaneInput : uint32_t {
+    INPUT_THROTTLE_UP = 1u << 0,
+    INPUT_THROTTLE_DOWN = 1u << 1,
+    INPUT_PITCH_UP = 1u << 2,
+    INPUT_PITCH_DOWN = 1u << 3,
+    INPUT_ROLL_LEFT = 1u << 4,
+    INPUT_ROLL_RIGHT = 1u << 5,
+    INPUT_YAW_LEFT = 1u << 6,
+    INPUT_YAW_RIGHT = 1u << 7,
+    INPUT_RESET = 1u << 8
+};
+
+// The flight model always advances in fixed ticks so recorded inputs replay to the same states
+const uint32_t SIM_TICKS_PER_SECOND = 60;
+
+// World obstacle entity
 struct Cube {
     float x, y, z;
     float size;
@@ -47,15 +92,18 @@ struct Cube {
 };
 
 extern Camera camera;
-extern PlaneState planeState;
-extern std::vector<Cube> referenceCubes;
+extern Entity playerPlane;
 
 Model loadObj(const std::string &filepath);
-void renderModel(const Model &model);
-void updatePlaneControls(GLFWwindow* window, float deltaTime);
-void generateReferenceCubes();
-void renderCube(const Cube &cube);
-void renderReferenceCubes();
-void renderGroundGrid();
+void renderModel(const GpuMesh &mesh, const Texture &texture);
+uint32_t readPlaneInputs(GLFWwindow* window);
+void spawnPlayerPlane();
+PlaneState &planeState();
+void updatePlaneControls(uint32_t inputs, float deltaTime);
+void generateReferenceCubes(unsigned seed);
+Mat4 sectorToCamera(int32_t sectorX, int32_t sectorY, int32_t sectorZ);
+void renderReferenceCubes(const Mat4 &origin);
+void renderGroundGrid(const Mat4 &origin);
+void renderParkedAircraft(const Mat4 &origin);
 
 #endif
\ No newline at end of file
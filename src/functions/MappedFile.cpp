@@ -0,0 +1,42 @@
+#include "MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+/**
+ * mapFile: Map a file read-only; the descriptor is closed right away, the mapping keeps the file open
+ */
+bool mapFile(const std::string &path, MappedFile &file) {
+    unmapFile(file);
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "Cannot map empty or unreadable file: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Cannot map " << path << std::endl;
+        return false;
+    }
+    file.data = static_cast<const uint8_t *>(data);
+    file.size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+/**
+ * unmapFile: Release a mapping made by mapFile (no-op when nothing is mapped)
+ */
+void unmapFile(MappedFile &file) {
+    if (file.data) munmap(const_cast<uint8_t *>(file.data), file.size);
+    file = MappedFile();
+}
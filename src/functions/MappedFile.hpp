@@ -0,0 +1,18 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only mapping of a whole file: pages are read on first touch and the kernel can drop them again
+// under memory pressure, so files far larger than RAM can be sampled in place
+struct MappedFile {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+bool mapFile(const std::string &path, MappedFile &file);
+void unmapFile(MappedFile &file);
+
+#endif
@@ -0,0 +1,125 @@
+#include "Matrix.hpp"
+#include <cmath>
+
+Mat4 mat4Identity() {
+    Mat4 r = {};
+    r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+    return r;
+}
+
+Mat4 mat4Multiply(const Mat4 &a, const Mat4 &b) {
+    Mat4 r;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            r.m[col * 4 + row] = a.m[row] * b.m[col * 4]
+                               + a.m[4 + row] * b.m[col * 4 + 1]
+                               + a.m[8 + row] * b.m[col * 4 + 2]
+                               + a.m[12 + row] * b.m[col * 4 + 3];
+        }
+    }
+    return r;
+}
+
+Mat4 mat4Translate(float x, float y, float z) {
+    Mat4 r = mat4Identity();
+    r.m[12] = x;
+    r.m[13] = y;
+    r.m[14] = z;
+    return r;
+}
+
+Mat4 mat4Scale(float x, float y, float z) {
+    Mat4 r = mat4Identity();
+    r.m[0] = x;
+    r.m[5] = y;
+    r.m[10] = z;
+    return r;
+}
+
+/**
+ * mat4Rotate: Same convention as glRotatef (degrees, axis normalized here)
+ */
+Mat4 mat4Rotate(float degrees, float x, float y, float z) {
+    float length = std::sqrt(x * x + y * y + z * z);
+    if (length == 0.0f) return mat4Identity();
+    x /= length; y /= length; z /= length;
+
+    float radians = degrees * static_cast<float>(M_PI) / 180.0f;
+    float c = std::cos(radians), s = std::sin(radians), t = 1.0f - c;
+
+    Mat4 r = mat4Identity();
+    r.m[0] = t * x * x + c;     r.m[4] = t * x * y - s * z; r.m[8] = t * x * z + s * y;
+    r.m[1] = t * x * y + s * z; r.m[5] = t * y * y + c;     r.m[9] = t * y * z - s * x;
+    r.m[2] = t * x * z - s * y; r.m[6] = t * y * z + s * x; r.m[10] = t * z * z + c;
+    return r;
+}
+
+Mat4 mat4Ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+    Mat4 r = mat4Identity();
+    r.m[0] = 2.0f / (right - left);
+    r.m[5] = 2.0f / (top - bottom);
+    r.m[10] = -2.0f / (zFar - zNear);
+    r.m[12] = -(right + left) / (right - left);
+    r.m[13] = -(top + bottom) / (top - bottom);
+    r.m[14] = -(zFar + zNear) / (zFar - zNear);
+    return r;
+}
+
+Mat4 mat4Perspective(float fovYDegrees, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovYDegrees * static_cast<float>(M_PI) / 360.0f);
+    Mat4 r = {};
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = (zFar + zNear) / (zNear - zFar);
+    r.m[11] = -1.0f;
+    r.m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+    return r;
+}
+
+void mat4TransformPoint(const Mat4 &m, const float in[3], float out[4]) {
+    for (int row = 0; row < 4; row++) {
+        out[row] = m.m[row] * in[0] + m.m[4 + row] * in[1] + m.m[8 + row] * in[2] + m.m[12 + row];
+    }
+}
+
+/**
+ * frustumFromMatrix: Gribb/Hartmann plane extraction (rows of the clip matrix)
+ */
+Frustum frustumFromMatrix(const Mat4 &m) {
+    Frustum frustum;
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            frustum.planes[i * 2][k] = m.m[k * 4 + 3] + m.m[k * 4 + i];
+            frustum.planes[i * 2 + 1][k] = m.m[k * 4 + 3] - m.m[k * 4 + i];
+        }
+    }
+    return frustum;
+}
+
+/**
+ * frustumIntersectsAabb: Conservative test using the box corner furthest along each plane normal
+ */
+bool frustumIntersectsAabb(const Frustum &frustum, const float boundsMin[3], const float boundsMax[3]) {
+    for (const float *plane : frustum.planes) {
+        float x = plane[0] >= 0.0f ? boundsMax[0] : boundsMin[0];
+        float y = plane[1] >= 0.0f ? boundsMax[1] : boundsMin[1];
+        float z = plane[2] >= 0.0f ? boundsMax[2] : boundsMin[2];
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f) return false;
+    }
+    return true;
+}
+
+/**
+ * transformAabb: Bounds of a transformed box (Arvo's method)
+ */
+void transformAabb(const Mat4 &m, const float boundsMin[3], const float boundsMax[3], float outMin[3], float outMax[3]) {
+    for (int row = 0; row < 3; row++) {
+        outMin[row] = outMax[row] = m.m[12 + row];
+        for (int col = 0; col < 3; col++) {
+            float a = m.m[col * 4 + row] * boundsMin[col];
+            float b = m.m[col * 4 + row] * boundsMax[col];
+            outMin[row] += a < b ? a : b;
+            outMax[row] += a < b ? b : a;
+        }
+    }
+}
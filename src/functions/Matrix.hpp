@@ -0,0 +1,47 @@
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <vector>
+
+// Column-major 4x4 matrix laid out like OpenGL expects it
+struct Mat4 {
+    float m[16];
+};
+
+Mat4 mat4Identity();
+Mat4 mat4Multiply(const Mat4 &a, const Mat4 &b);
+Mat4 mat4Translate(float x, float y, float z);
+Mat4 mat4Scale(float x, float y, float z);
+Mat4 mat4Rotate(float degrees, float x, float y, float z);
+Mat4 mat4Ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+Mat4 mat4Perspective(float fovYDegrees, float aspect, float zNear, float zFar);
+void mat4TransformPoint(const Mat4 &m, const float in[3], float out[4]);
+
+// Six clip planes (ax + by + cz + d >= 0 inside) extracted from a view-projection matrix
+struct Frustum {
+    float planes[6][4];
+};
+
+Frustum frustumFromMatrix(const Mat4 &m);
+bool frustumIntersectsAabb(const Frustum &frustum, const float boundsMin[3], const float boundsMax[3]);
+void transformAabb(const Mat4 &m, const float boundsMin[3], const float boundsMax[3], float outMin[3], float outMax[3]);
+
+inline Mat4 operator*(const Mat4 &a, const Mat4 &b) {
+    return mat4Multiply(a, b);
+}
+
+// CPU replacement for the fixed-function glPushMatrix/glRotatef stack
+struct MatrixStack {
+    std::vector<Mat4> stack = {mat4Identity()};
+
+    const Mat4 &top() const { return stack.back(); }
+    void push() { stack.push_back(stack.back()); }
+    void pop() { if (stack.size() > 1) stack.pop_back(); }
+    void loadIdentity() { stack.back() = mat4Identity(); }
+    void multiply(const Mat4 &m) { stack.back() = stack.back() * m; }
+    void translate(float x, float y, float z) { multiply(mat4Translate(x, y, z)); }
+    void rotate(float degrees, float x, float y, float z) { multiply(mat4Rotate(degrees, x, y, z)); }
+    void scale(float x, float y, float z) { multiply(mat4Scale(x, y, z)); }
+};
+
+#endif
@@ -0,0 +1,299 @@
+#include "MemoryTracker.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+constinit MemoryTracker memoryTracker;
+constinit std::atomic<uint64_t> heapAllocations{0};
+constinit std::atomic<uint64_t> frameHeapAllocations{0};
+
+namespace {
+
+const char *subsystemNames[MEMORY_SUBSYSTEM_COUNT] = {"other", "loader", "world", "renderer", "recorder"};
+const double bytesPerMb = 1024.0 * 1024.0;
+
+constinit thread_local MemorySubsystem currentSubsystem = MEMORY_OTHER;
+constinit thread_local bool countsTowardFrame = true;
+
+// Written in front of every heap block: the size and subsystem to credit back on delete, and how far
+// back the block starts (more than the header for over-aligned allocations)
+struct AllocationHeader {
+    uint64_t size;
+    uint32_t offset;
+    MemorySubsystem subsystem;
+};
+
+static_assert(sizeof(AllocationHeader) <= alignof(std::max_align_t), "the header must keep malloc alignment");
+
+void *heapAllocate(size_t size, size_t alignment) {
+    size_t headerSpace = std::max(alignment, alignof(std::max_align_t));
+    void *base;
+    for (;;) {
+        base = alignment > alignof(std::max_align_t)
+             ? std::aligned_alloc(alignment, (size + headerSpace + alignment - 1) & ~(alignment - 1))
+             : std::malloc(size + headerSpace);
+        if (base) break;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+
+    std::byte *pointer = static_cast<std::byte *>(base) + headerSpace;
+    AllocationHeader *header = reinterpret_cast<AllocationHeader *>(pointer) - 1;
+    header->size = size;
+    header->offset = static_cast<uint32_t>(headerSpace);
+    header->subsystem = currentSubsystem;
+
+    SubsystemMemory &memory = memoryTracker.subsystems[header->subsystem];
+    int64_t now = memory.heapBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+    int64_t peak = memory.peakHeapBytes.load(std::memory_order_relaxed);
+    while (now > peak && !memory.peakHeapBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    memory.allocations.fetch_add(1, std::memory_order_relaxed);
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (countsTowardFrame) frameHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return pointer;
+}
+
+void heapRelease(void *pointer) {
+    if (!pointer) return;
+    const AllocationHeader *header = static_cast<const AllocationHeader *>(pointer) - 1;
+    memoryTracker.subsystems[header->subsystem].heapBytes.fetch_sub(static_cast<int64_t>(header->size),
+                                                                      std::memory_order_relaxed);
+    std::free(static_cast<std::byte *>(pointer) - header->offset);
+}
+
+struct GpuObject {
+    MemorySubsystem subsystem;
+    size_t bytes;
+};
+
+// GL objects by (kind, name); every lookup and update holds gpuObjectsMutex. The per-subsystem gpuBytes
+// totals are atomics, so reports read them without taking the lock
+std::mutex gpuObjectsMutex;
+
+std::unordered_map<uint64_t, GpuObject> &gpuObjects() {
+    static std::unordered_map<uint64_t, GpuObject> objects;
+    return objects;
+}
+
+uint64_t gpuObjectKey(GpuObjectKind kind, uint32_t id) {
+    return (static_cast<uint64_t>(kind) << 32) | id;
+}
+
+double subsystemMb(const SubsystemMemory &memory) {
+    return (memory.heapBytes.load(std::memory_order_relaxed) + memory.gpuBytes.load(std::memory_order_relaxed)) / bytesPerMb;
+}
+
+}
+
+// The replaced global allocation functions count and tag every heap allocation, whichever container,
+// thread or library made it; the array and nothrow forms of the standard library forward to these
+void *operator new(size_t size) {
+    return heapAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return heapAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+    heapRelease(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    heapRelease(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    heapRelease(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+    heapRelease(pointer);
+}
+
+MemoryScope::MemoryScope(MemorySubsystem subsystem) : previous(currentSubsystem) {
+    currentSubsystem = subsystem;
+}
+
+MemoryScope::~MemoryScope() {
+    currentSubsystem = previous;
+}
+
+/**
+ * memorySubsystemName: Lower-case name used in logs, budgets and the JSON report
+ */
+const char *memorySubsystemName(MemorySubsystem subsystem) {
+    return subsystem < MEMORY_SUBSYSTEM_COUNT ? subsystemNames[subsystem] : "?";
+}
+
+/**
+ * excludeThreadFromFrameMemory: Stop counting the calling thread's allocations towards frames
+ * For background threads that allocate on their own schedule (logger, watchers, encoders, streamers).
+ */
+void excludeThreadFromFrameMemory() {
+    countsTowardFrame = false;
+}
+
+/**
+ * parseMemoryBudgets: Set budgets from a list like "renderer=256,world=64" (megabytes of heap plus GPU)
+ */
+bool parseMemoryBudgets(const std::string &list) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string entry = list.substr(start, end - start);
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) return false;
+
+        std::string name = entry.substr(0, equals);
+        char *parsed = nullptr;
+        double megabytes = std::strtod(entry.c_str() + equals + 1, &parsed);
+        if (*parsed != '\0' || !(megabytes > 0.0)) return false;
+
+        const char **found = std::find_if(std::begin(subsystemNames), std::end(subsystemNames),
+                                          [&](const char *known) { return name == known; });
+        if (found == std::end(subsystemNames)) return false;
+        memoryTracker.subsystems[found - std::begin(subsystemNames)].budgetBytes = static_cast<int64_t>(megabytes * bytesPerMb);
+        start = end + 1;
+    }
+    return true;
+}
+
+/**
+ * trackGpuMemory: Credit a buffer or texture's storage to a subsystem (re-tracking a name replaces its size)
+ */
+void trackGpuMemory(GpuObjectKind kind, uint32_t id, MemorySubsystem subsystem, size_t bytes) {
+    if (id == 0) return;
+    std::lock_guard<std::mutex> lock(gpuObjectsMutex);
+    GpuObject &object = gpuObjects()[gpuObjectKey(kind, id)];
+    if (object.bytes > 0) memoryTracker.subsystems[object.subsystem].gpuBytes -= static_cast<int64_t>(object.bytes);
+    object = {subsystem, bytes};
+    memoryTracker.subsystems[subsystem].gpuBytes += static_cast<int64_t>(bytes);
+}
+
+/**
+ * releaseGpuMemory: Forget a buffer or texture that is being deleted
+ */
+void releaseGpuMemory(GpuObjectKind kind, uint32_t id) {
+    std::lock_guard<std::mutex> lock(gpuObjectsMutex);
+    auto found = gpuObjects().find(gpuObjectKey(kind, id));
+    if (found == gpuObjects().end()) return;
+    memoryTracker.subsystems[found->second.subsystem].gpuBytes -= static_cast<int64_t>(found->second.bytes);
+    gpuObjects().erase(found);
+}
+
+/**
+ * totalHeapBytes: Live heap bytes over all subsystems
+ */
+int64_t totalHeapBytes() {
+    int64_t total = 0;
+    for (const SubsystemMemory &memory : memoryTracker.subsystems) total += memory.heapBytes.load(std::memory_order_relaxed);
+    return total;
+}
+
+/**
+ * totalGpuBytes: Tracked GPU bytes over all subsystems
+ */
+int64_t totalGpuBytes() {
+    int64_t total = 0;
+    for (const SubsystemMemory &memory : memoryTracker.subsystems) total += memory.gpuBytes.load(std::memory_order_relaxed);
+    return total;
+}
+
+/**
+ * checkMemoryBudgets: Warn once when a subsystem goes over its budget, and again once it is back under
+ */
+void checkMemoryBudgets() {
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        SubsystemMemory &memory = memoryTracker.subsystems[i];
+        if (memory.budgetBytes == 0) continue;
+        double usedMb = subsystemMb(memory), budgetMb = memory.budgetBytes / bytesPerMb;
+        bool over = usedMb > budgetMb;
+        if (over == memory.overBudget) continue;
+        memory.overBudget = over;
+        if (over) {
+            LOG_WARN("Memory budget exceeded: {} uses {} MB of {} MB", subsystemNames[i], usedMb, budgetMb);
+        } else {
+            LOG_INFO("Memory back within budget: {} uses {} MB of {} MB", subsystemNames[i], usedMb, budgetMb);
+        }
+    }
+}
+
+/**
+ * logMemoryUsage: Live totals for the stats output (F3)
+ */
+void logMemoryUsage() {
+    const SubsystemMemory *memory = memoryTracker.subsystems;
+    LOG_INFO("Stats: memory {} MB heap, {} MB GPU | loader {} MB, world {} MB, renderer {} MB, recorder {} MB",
+             totalHeapBytes() / bytesPerMb, totalGpuBytes() / bytesPerMb, subsystemMb(memory[MEMORY_LOADER]),
+             subsystemMb(memory[MEMORY_WORLD]), subsystemMb(memory[MEMORY_RENDERER]), subsystemMb(memory[MEMORY_RECORDER]));
+}
+
+/**
+ * logMemoryCheckpoint: Log the totals and how much they moved since the previous checkpoint
+ * Taken at every reset, so memory that keeps growing across resets shows up as a leak.
+ */
+void logMemoryCheckpoint(const char *label) {
+    MemoryTracker &tracker = memoryTracker;
+    int64_t heap = totalHeapBytes(), gpu = totalGpuBytes();
+    LOG_INFO("Memory at {}: {} KB heap, {} KB GPU ({} KB heap, {} KB GPU since the last checkpoint)", label,
+             heap / 1024, gpu / 1024, (heap - tracker.checkpointHeapBytes) / 1024, (gpu - tracker.checkpointGpuBytes) / 1024);
+    tracker.checkpointHeapBytes = heap;
+    tracker.checkpointGpuBytes = gpu;
+}
+
+/**
+ * reportMemoryUsage: Print peak and live heap plus GPU bytes of every subsystem at the end of a run
+ */
+void reportMemoryUsage() {
+    std::cout << "Memory (peak heap / live heap / GPU):" << std::endl;
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        const SubsystemMemory &memory = memoryTracker.subsystems[i];
+        char line[160];
+        int length = std::snprintf(line, sizeof(line), "  %-9s %9.2f / %9.2f / %9.2f MB, %llu allocations", subsystemNames[i],
+                                   memory.peakHeapBytes.load() / bytesPerMb, memory.heapBytes.load() / bytesPerMb,
+                                   memory.gpuBytes.load() / bytesPerMb, static_cast<unsigned long long>(memory.allocations.load()));
+        if (memory.budgetBytes > 0 && length > 0 && length < static_cast<int>(sizeof(line))) {
+            std::snprintf(line + length, sizeof(line) - length, " (budget %.0f MB)", memory.budgetBytes / bytesPerMb);
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+/**
+ * writeMemoryReport: Dump the per-subsystem counters as JSON
+ */
+bool writeMemoryReport(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Cannot write memory report: " << path << std::endl;
+        return false;
+    }
+
+    file << "{\n"
+         << "  \"heapBytes\": " << totalHeapBytes() << ",\n"
+         << "  \"gpuBytes\": " << totalGpuBytes() << ",\n"
+         << "  \"heapAllocations\": " << heapAllocations.load() << ",\n"
+         << "  \"subsystems\": {\n";
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        const SubsystemMemory &memory = memoryTracker.subsystems[i];
+        file << "    \"" << subsystemNames[i] << "\": {"
+             << "\"heapBytes\": " << memory.heapBytes.load()
+             << ", \"peakHeapBytes\": " << memory.peakHeapBytes.load()
+             << ", \"allocations\": " << memory.allocations.load()
+             << ", \"gpuBytes\": " << memory.gpuBytes.load()
+             << ", \"budgetBytes\": " << memory.budgetBytes
+             << ", \"overBudget\": " << (memory.overBudget ? "true" : "false") << "}"
+             << (i + 1 < MEMORY_SUBSYSTEM_COUNT ? ",\n" : "\n");
+    }
+    file << "  }\n}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,71 @@
+#ifndef MEMORY_TRACKER_HPP
+#define MEMORY_TRACKER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum MemorySubsystem : uint8_t {
+    MEMORY_OTHER = 0,
+    MEMORY_LOADER = 1,
+    MEMORY_WORLD = 2,
+    MEMORY_RENDERER = 3,
+    MEMORY_RECORDER = 4,
+    MEMORY_SUBSYSTEM_COUNT = 5
+};
+
+enum GpuObjectKind : uint8_t {
+    GPU_BUFFER,
+    GPU_TEXTURE
+};
+
+// Live and peak bytes of one subsystem; heap bytes come from the global operator new, GPU bytes
+// from the buffers and textures registered with trackGpuMemory. budgetBytes = 0 means no budget
+struct SubsystemMemory {
+    std::atomic<int64_t> heapBytes{0};
+    std::atomic<int64_t> peakHeapBytes{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<int64_t> gpuBytes{0};
+    int64_t budgetBytes = 0;
+    bool overBudget = false;
+};
+
+// Constant-initialized, so allocations made before main are already counted
+struct MemoryTracker {
+    SubsystemMemory subsystems[MEMORY_SUBSYSTEM_COUNT];
+    int64_t checkpointHeapBytes = 0;
+    int64_t checkpointGpuBytes = 0;
+};
+
+extern MemoryTracker memoryTracker;
+
+// Every global operator new on any thread
+extern std::atomic<uint64_t> heapAllocations;
+// Every global operator new on threads that can do frame work: all but the background service threads
+extern std::atomic<uint64_t> frameHeapAllocations;
+
+// Tags the calling thread's heap allocations with a subsystem until the scope ends
+struct MemoryScope {
+    MemorySubsystem previous;
+
+    explicit MemoryScope(MemorySubsystem subsystem);
+    ~MemoryScope();
+    MemoryScope(const MemoryScope &) = delete;
+    MemoryScope &operator=(const MemoryScope &) = delete;
+};
+
+const char *memorySubsystemName(MemorySubsystem subsystem);
+void excludeThreadFromFrameMemory();
+bool parseMemoryBudgets(const std::string &list);
+void trackGpuMemory(GpuObjectKind kind, uint32_t id, MemorySubsystem subsystem, size_t bytes);
+void releaseGpuMemory(GpuObjectKind kind, uint32_t id);
+int64_t totalHeapBytes();
+int64_t totalGpuBytes();
+void checkMemoryBudgets();
+void logMemoryUsage();
+void logMemoryCheckpoint(const char *label);
+void reportMemoryUsage();
+bool writeMemoryReport(const std::string &path);
+
+#endif
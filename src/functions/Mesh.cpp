@@ -0,0 +1,356 @@
+#include "Mesh.hpp"
+#include "Shader.hpp"
+#include "MemoryTracker.hpp"
+#include "Log.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+bool usePackedVertices = true;
+
+namespace {
+
+// Vertex indices must exist; texcoord and normal indices may also be -1 (absent)
+bool validModelIndices(const Model &model) {
+    auto inRange = [](int index, size_t count, bool optional) {
+        return (optional && index == -1) || (index >= 0 && static_cast<size_t>(index) < count);
+    };
+    for (const Face &face : model.faces) {
+        for (int v : {face.v1, face.v2, face.v3}) {
+            if (!inRange(v, model.vertices.size(), false)) return false;
+        }
+        for (int t : {face.t1, face.t2, face.t3}) {
+            if (!inRange(t, model.texcoords.size(), true)) return false;
+        }
+        if (model.normals.empty()) continue;
+        for (int n : {face.n1, face.n2, face.n3}) {
+            if (!inRange(n, model.normals.size(), true)) return false;
+        }
+    }
+    return true;
+}
+
+struct CornerKey {
+    int v, t, n;
+    bool operator==(const CornerKey &other) const {
+        return v == other.v && t == other.t && n == other.n;
+    }
+};
+
+struct CornerKeyHash {
+    size_t operator()(const CornerKey &key) const {
+        size_t h = static_cast<size_t>(key.v) * 73856093u;
+        h ^= static_cast<size_t>(key.t + 1) * 19349663u;
+        h ^= static_cast<size_t>(key.n + 1) * 83492791u;
+        return h;
+    }
+};
+
+uint16_t quantizeUnorm16(float value, float minValue, float extent) {
+    float t = extent > 0.0f ? (value - minValue) / extent : 0.0f;
+    return static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+}
+
+int16_t quantizeSnorm16(float value) {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+}
+
+/**
+ * buildMeshData: Flatten an indexed .obj model into unique position/normal/uv vertices
+ */
+MeshData buildMeshData(const Model &model) {
+    MemoryScope scope(MEMORY_LOADER);
+    MeshData mesh;
+    if (!validModelIndices(model)) {
+        LOG_ERROR("Model has face indices outside its vertex, texcoord or normal lists");
+        return mesh;
+    }
+    mesh.boundsMin = model.boundsMin;
+    mesh.boundsMax = model.boundsMax;
+
+    // Smooth per-position normals for models exported without vn records
+    std::vector<Vertex> generatedNormals;
+    if (model.normals.empty()) {
+        generatedNormals.assign(model.vertices.size(), {0.0f, 0.0f, 0.0f});
+        for (const Face &face : model.faces) {
+            const Vertex &a = model.vertices[face.v1];
+            const Vertex &b = model.vertices[face.v2];
+            const Vertex &c = model.vertices[face.v3];
+            float ex = b.x - a.x, ey = b.y - a.y, ez = b.z - a.z;
+            float fx = c.x - a.x, fy = c.y - a.y, fz = c.z - a.z;
+            Vertex n = {ey * fz - ez * fy, ez * fx - ex * fz, ex * fy - ey * fx};
+            for (int index : {face.v1, face.v2, face.v3}) {
+                generatedNormals[index].x += n.x;
+                generatedNormals[index].y += n.y;
+                generatedNormals[index].z += n.z;
+            }
+        }
+    }
+    const std::vector<Vertex> &normals = model.normals.empty() ? generatedNormals : model.normals;
+
+    std::unordered_map<CornerKey, uint32_t, CornerKeyHash> lookup;
+    lookup.reserve(model.faces.size() * 3);
+    mesh.indices.reserve(model.faces.size() * 3);
+
+    for (const Face &face : model.faces) {
+        const CornerKey corners[3] = {
+            {face.v1, face.t1, model.normals.empty() ? face.v1 : face.n1},
+            {face.v2, face.t2, model.normals.empty() ? face.v2 : face.n2},
+            {face.v3, face.t3, model.normals.empty() ? face.v3 : face.n3},
+        };
+
+        for (const CornerKey &key : corners) {
+            auto [it, inserted] = lookup.try_emplace(key, static_cast<uint32_t>(mesh.vertices.size()));
+            if (inserted) {
+                MeshVertex vertex = {};
+                const Vertex &p = model.vertices[key.v];
+                vertex.position[0] = p.x;
+                vertex.position[1] = p.y;
+                vertex.position[2] = p.z;
+
+                Vertex n = key.n >= 0 ? normals[key.n] : Vertex{0.0f, 1.0f, 0.0f};
+                float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+                if (length < 1e-12f) n = {0.0f, 1.0f, 0.0f}, length = 1.0f;
+                vertex.normal[0] = n.x / length;
+                vertex.normal[1] = n.y / length;
+                vertex.normal[2] = n.z / length;
+
+                // .obj puts v=0 at the bottom of the image, our textures store the top row first
+                if (key.t >= 0) {
+                    vertex.uv[0] = model.texcoords[key.t].u;
+                    vertex.uv[1] = 1.0f - model.texcoords[key.t].v;
+                }
+                mesh.vertices.push_back(vertex);
+            }
+            mesh.indices.push_back(it->second);
+        }
+    }
+
+    return mesh;
+}
+
+/**
+ * floatToHalf: IEEE 754 binary16 conversion with round-to-nearest (denormals flush to zero)
+ */
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    if (exponent <= 0) return static_cast<uint16_t>(sign);
+    if (exponent >= 31) return static_cast<uint16_t>(sign | 0x7C00u);
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if ((mantissa & 0x1FFFu) > 0x1000u || ((mantissa & 0x1FFFu) == 0x1000u && (half & 1u))) half++;
+    return static_cast<uint16_t>(half);
+}
+
+/**
+ * encodeOctahedral: Map a unit normal onto the octahedron and unfold it into [-1, 1]^2
+ */
+void encodeOctahedral(const float normal[3], int16_t out[2]) {
+    float l1 = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    float x = normal[0] / l1, y = normal[1] / l1;
+    if (normal[2] < 0.0f) {
+        float ox = x, oy = y;
+        x = (1.0f - std::fabs(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::fabs(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+    }
+    out[0] = quantizeSnorm16(x);
+    out[1] = quantizeSnorm16(y);
+}
+
+/**
+ * packVertices: Quantize positions against the model bounds and compress normals/uvs
+ */
+std::vector<PackedVertex> packVertices(const MeshData &mesh) {
+    const float minValue[3] = {mesh.boundsMin.x, mesh.boundsMin.y, mesh.boundsMin.z};
+    const float extent[3] = {mesh.boundsMax.x - mesh.boundsMin.x,
+                             mesh.boundsMax.y - mesh.boundsMin.y,
+                             mesh.boundsMax.z - mesh.boundsMin.z};
+
+    std::vector<PackedVertex> packed(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const MeshVertex &v = mesh.vertices[i];
+        PackedVertex &p = packed[i];
+        for (int k = 0; k < 3; k++) p.position[k] = quantizeUnorm16(v.position[k], minValue[k], extent[k]);
+        p.padding = 0;
+        encodeOctahedral(v.normal, p.normal);
+        p.uv[0] = floatToHalf(v.uv[0]);
+        p.uv[1] = floatToHalf(v.uv[1]);
+    }
+
+    return packed;
+}
+
+/**
+ * uploadMesh: Create VAO/VBO/IBO in either the float or the packed vertex layout
+ */
+GpuMesh uploadMesh(const MeshData &mesh, bool packed) {
+    GpuMesh gpu;
+    gpu.packed = packed;
+    gpu.indexCount = static_cast<GLsizei>(mesh.indices.size());
+    gpu.boundsMin = mesh.boundsMin;
+    gpu.boundsExtent = {mesh.boundsMax.x - mesh.boundsMin.x,
+                        mesh.boundsMax.y - mesh.boundsMin.y,
+                        mesh.boundsMax.z - mesh.boundsMin.z};
+
+    glGenVertexArrays(1, &gpu.vao);
+    glGenBuffers(1, &gpu.vbo);
+    glGenBuffers(1, &gpu.ibo);
+    glBindVertexArray(gpu.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+
+    if (packed) {
+        std::vector<PackedVertex> vertices = packVertices(mesh);
+        gpu.vertexBytes = vertices.size() * sizeof(PackedVertex);
+        glBufferData(GL_ARRAY_BUFFER, gpu.vertexBytes, vertices.data(), GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(ATTRIB_POSITION);
+        glVertexAttribPointer(ATTRIB_POSITION, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              reinterpret_cast<void *>(offsetof(PackedVertex, position)));
+        glEnableVertexAttribArray(ATTRIB_NORMAL);
+        glVertexAttribPointer(ATTRIB_NORMAL, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              reinterpret_cast<void *>(offsetof(PackedVertex, normal)));
+        glEnableVertexAttribArray(ATTRIB_TEXCOORD);
+        glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex),
+                              reinterpret_cast<void *>(offsetof(PackedVertex, uv)));
+    } else {
+        gpu.vertexBytes = mesh.vertices.size() * sizeof(MeshVertex);
+        glBufferData(GL_ARRAY_BUFFER, gpu.vertexBytes, mesh.vertices.data(), GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(ATTRIB_POSITION);
+        glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                              reinterpret_cast<void *>(offsetof(MeshVertex, position)));
+        glEnableVertexAttribArray(ATTRIB_NORMAL);
+        glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                              reinterpret_cast<void *>(offsetof(MeshVertex, normal)));
+        glEnableVertexAttribArray(ATTRIB_TEXCOORD);
+        glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                              reinterpret_cast<void *>(offsetof(MeshVertex, uv)));
+    }
+
+    // Packed meshes also drop to 16-bit indices whenever the vertex count allows it
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.ibo);
+    if (packed && mesh.vertices.size() <= 65536) {
+        std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+        gpu.indexType = GL_UNSIGNED_SHORT;
+        gpu.indexBytes = indices.size() * sizeof(uint16_t);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, gpu.indexBytes, indices.data(), GL_STATIC_DRAW);
+    } else {
+        gpu.indexType = GL_UNSIGNED_INT;
+        gpu.indexBytes = mesh.indices.size() * sizeof(uint32_t);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, gpu.indexBytes, mesh.indices.data(), GL_STATIC_DRAW);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, gpu.vbo, MEMORY_RENDERER, gpu.vertexBytes);
+    trackGpuMemory(GPU_BUFFER, gpu.ibo, MEMORY_RENDERER, gpu.indexBytes);
+
+    return gpu;
+}
+
+/**
+ * logMeshLayout: Log a mesh's GPU size against what the float layout would take
+ */
+void logMeshLayout(const MeshData &mesh, const GpuMesh &gpu) {
+    size_t floatBytes = mesh.vertices.size() * sizeof(MeshVertex) + mesh.indices.size() * sizeof(uint32_t);
+    size_t meshBytes = gpu.vertexBytes + gpu.indexBytes;
+    LOG_INFO("Mesh: {} vertices, {} triangles, {} layout {} KB ({}% of float layout)", mesh.vertices.size(),
+             mesh.indices.size() / 3, gpu.packed ? "packed" : "float", meshBytes / 1024,
+             (meshBytes * 100) / std::max<size_t>(floatBytes, 1));
+}
+
+/**
+ * updateMesh: Replace a mesh's contents, rewriting its buffers in place when the new data is the same size
+ * Returns false when the buffers had to be reallocated (the GL names change).
+ */
+bool updateMesh(GpuMesh &gpu, const MeshData &mesh) {
+    bool packed = gpu.packed;
+    GLenum indexType = packed && mesh.vertices.size() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    size_t vertexBytes = mesh.vertices.size() * (packed ? sizeof(PackedVertex) : sizeof(MeshVertex));
+    size_t indexBytes = mesh.indices.size() * (indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+    if (!gpu.vao || vertexBytes != gpu.vertexBytes || indexBytes != gpu.indexBytes || indexType != gpu.indexType) {
+        destroyMesh(gpu);
+        gpu = uploadMesh(mesh, packed);
+        return false;
+    }
+
+    // The element buffer binding belongs to the VAO, so it is bound while writing the indices
+    glBindVertexArray(gpu.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+    if (packed) {
+        std::vector<PackedVertex> vertices = packVertices(mesh);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, vertices.data());
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, mesh.vertices.data());
+    }
+    if (indexType == GL_UNSIGNED_SHORT) {
+        std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, indices.data());
+    } else {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, mesh.indices.data());
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gpu.indexCount = static_cast<GLsizei>(mesh.indices.size());
+    gpu.boundsMin = mesh.boundsMin;
+    gpu.boundsExtent = {mesh.boundsMax.x - mesh.boundsMin.x,
+                        mesh.boundsMax.y - mesh.boundsMin.y,
+                        mesh.boundsMax.z - mesh.boundsMin.z};
+    return true;
+}
+
+/**
+ * uploadPositionMesh: Upload a position-only mesh (built-in cube and grid geometry)
+ */
+GpuMesh uploadPositionMesh(const std::vector<float> &positions, const std::vector<uint32_t> &indices) {
+    GpuMesh gpu;
+    gpu.indexCount = static_cast<GLsizei>(indices.size());
+    gpu.vertexBytes = positions.size() * sizeof(float);
+    gpu.indexBytes = indices.size() * sizeof(uint32_t);
+
+    glGenVertexArrays(1, &gpu.vao);
+    glGenBuffers(1, &gpu.vbo);
+    glGenBuffers(1, &gpu.ibo);
+    glBindVertexArray(gpu.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gpu.vbo);
+    glBufferData(GL_ARRAY_BUFFER, gpu.vertexBytes, positions.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, gpu.indexBytes, indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, gpu.vbo, MEMORY_RENDERER, gpu.vertexBytes);
+    trackGpuMemory(GPU_BUFFER, gpu.ibo, MEMORY_RENDERER, gpu.indexBytes);
+    return gpu;
+}
+
+/**
+ * destroyMesh: Release GPU buffers
+ */
+void destroyMesh(GpuMesh &mesh) {
+    if (mesh.vao) glDeleteVertexArrays(1, &mesh.vao);
+    if (mesh.vbo) {
+        releaseGpuMemory(GPU_BUFFER, mesh.vbo);
+        glDeleteBuffers(1, &mesh.vbo);
+    }
+    if (mesh.ibo) {
+        releaseGpuMemory(GPU_BUFFER, mesh.ibo);
+        glDeleteBuffers(1, &mesh.ibo);
+    }
+    mesh = GpuMesh();
+}
@@ -0,0 +1,55 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "MainFunctions.hpp"
+
+// Full-precision GPU vertex: 32 bytes
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+// Packed GPU vertex: 16 bytes
+// position: unorm16 relative to the model bounds, normal: octahedral snorm16, uv: half floats
+struct PackedVertex {
+    uint16_t position[3];
+    uint16_t padding;
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    Vertex boundsMin, boundsMax;
+};
+
+// source is set instead of the GL handles when the software renderer draws the mesh
+struct GpuMesh {
+    GLuint vao = 0, vbo = 0, ibo = 0;
+    const MeshData *source = nullptr;
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    bool packed = false;
+    size_t vertexBytes = 0, indexBytes = 0;
+    Vertex boundsMin = {0.0f, 0.0f, 0.0f};
+    Vertex boundsExtent = {1.0f, 1.0f, 1.0f};
+};
+
+extern bool usePackedVertices;
+
+MeshData buildMeshData(const Model &model);
+std::vector<PackedVertex> packVertices(const MeshData &mesh);
+uint16_t floatToHalf(float value);
+void encodeOctahedral(const float normal[3], int16_t out[2]);
+GpuMesh uploadMesh(const MeshData &mesh, bool packed);
+bool updateMesh(GpuMesh &gpu, const MeshData &mesh);
+void logMeshLayout(const MeshData &mesh, const GpuMesh &gpu);
+GpuMesh uploadPositionMesh(const std::vector<float> &positions, const std::vector<uint32_t> &indices);
+void destroyMesh(GpuMesh &mesh);
+
+#endif
@@ -0,0 +1,253 @@
+#include "Options.hpp"
+#include "MemoryTracker.hpp"
+#include "FramePacing.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+Options options;
+
+namespace {
+
+// Strictly positive integer argument; false on garbage, zero or overflow
+bool parseCount(const char *text, long maxValue, long &value) {
+    char *end = nullptr;
+    value = std::strtol(text, &end, 10);
+    return end != text && *end == '\0' && value > 0 && value <= maxValue;
+}
+
+// Comma-separated frame numbers, e.g. "0,60,120"
+bool parseFrameList(const std::string &text, std::vector<uint32_t> &frames) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char *end = nullptr;
+        long frame = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || frame < 0 || frame > 100000000) return false;
+        frames.push_back(static_cast<uint32_t>(frame));
+    }
+    return !frames.empty();
+}
+
+// "LAT,LON" in degrees, e.g. "46.5,7.9"
+bool parseLatLon(const std::string &text, double &latitude, double &longitude) {
+    char *end = nullptr;
+    latitude = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || *end != ',') return false;
+    const char *start = end + 1;
+    longitude = std::strtod(start, &end);
+    return end != start && *end == '\0' && latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0;
+}
+
+}
+
+/**
+ * parseOptions: Read command-line flags into options, reporting unknown flags and bad values
+ */
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        long value = 0;
+
+        if (arg == "--software") {
+            options.softwareRenderer = true;
+        } else if (arg == "--benchmark") {
+            options.benchmark = true;
+        } else if (arg == "--help" || arg == "-h") {
+            options.showHelp = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 100000000, value)) {
+                std::cerr << "Invalid frame count: " << argv[i] << std::endl;
+                return false;
+            }
+            options.frames = static_cast<uint32_t>(value);
+        } else if (arg == "--size" && i + 2 < argc) {
+            long width = 0, height = 0;
+            if (!parseCount(argv[i + 1], 16384, width) || !parseCount(argv[i + 2], 16384, height)) {
+                std::cerr << "Invalid size: " << argv[i + 1] << " " << argv[i + 2] << std::endl;
+                return false;
+            }
+            options.width = static_cast<int>(width);
+            options.height = static_cast<int>(height);
+            i += 2;
+        } else if (arg == "--capture" && i + 1 < argc) {
+            if (!parseFrameList(argv[++i], options.captureFrames)) {
+                std::cerr << "Invalid capture frame list: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--capture-dir" && i + 1 < argc) {
+            options.captureDir = argv[++i];
+        } else if (arg == "--golden" && i + 1 < argc) {
+            options.goldenDir = argv[++i];
+        } else if (arg == "--update-golden") {
+            options.updateGolden = true;
+        } else if (arg == "--alloc-check") {
+            options.allocCheck = true;
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            if (!parseMemoryBudgets(argv[++i])) {
+                std::cerr << "Invalid memory budget: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--memory-report" && i + 1 < argc) {
+            options.memoryReportPath = argv[++i];
+        } else if (arg == "--asset-pack" && i + 1 < argc) {
+            options.assetPackPath = argv[++i];
+        } else if (arg == "--pack-assets" && i + 1 < argc) {
+            options.packAssetsPath = argv[++i];
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            options.pacing = argv[++i];
+            PacingMode mode;
+            if (!parsePacingMode(options.pacing, mode)) {
+                std::cerr << "Invalid pacing mode: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--fps-limit" && i + 1 < argc) {
+            char *end = nullptr;
+            options.fpsLimit = std::strtod(argv[++i], &end);
+            if (end == argv[i] || *end != '\0' || !(options.fpsLimit >= 1.0) || options.fpsLimit > 10000.0) {
+                std::cerr << "Invalid frame rate limit: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--hot-reload") {
+            options.hotReload = true;
+        } else if (arg == "--terrain" && i + 1 < argc) {
+            options.terrainDir = argv[++i];
+        } else if (arg == "--terrain-origin" && i + 1 < argc) {
+            if (!parseLatLon(argv[++i], options.terrainLatitude, options.terrainLongitude)) {
+                std::cerr << "Invalid terrain origin: " << argv[i] << std::endl;
+                return false;
+            }
+            options.terrainOriginSet = true;
+        } else if (arg == "--terrain-scale" && i + 1 < argc) {
+            char *end = nullptr;
+            options.terrainScale = std::strtod(argv[++i], &end);
+            if (end == argv[i] || *end != '\0' || !(options.terrainScale > 0.0) || options.terrainScale > 100000.0) {
+                std::cerr << "Invalid terrain scale: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--record" && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--flight-log" && i + 1 < argc) {
+            options.flightLogPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--seek" && i + 1 < argc) {
+            char *end = nullptr;
+            value = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || value < 0 || value > 100000000) {
+                std::cerr << "Invalid seek tick: " << argv[i] << std::endl;
+                return false;
+            }
+            options.seekTick = static_cast<uint32_t>(value);
+        } else if (arg == "--no-render") {
+            options.noRender = true;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            char *end = nullptr;
+            unsigned long seed = std::strtoul(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || argv[i][0] == '-' || seed > 0xffffffffUL) {
+                std::cerr << "Invalid seed: " << argv[i] << std::endl;
+                return false;
+            }
+            options.seed = static_cast<uint32_t>(seed);
+            options.seedSet = true;
+        } else if (arg == "--worldgen-benchmark" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 50000000, value)) {
+                std::cerr << "Invalid cube count: " << argv[i] << std::endl;
+                return false;
+            }
+            options.worldGenBenchmark = static_cast<uint32_t>(value);
+        } else if (arg == "--ecs-benchmark" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 50000000, value)) {
+                std::cerr << "Invalid entity count: " << argv[i] << std::endl;
+                return false;
+            }
+            options.ecsBenchmark = static_cast<uint32_t>(value);
+        } else if (arg == "--log-benchmark" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 100000000, value)) {
+                std::cerr << "Invalid event count: " << argv[i] << std::endl;
+                return false;
+            }
+            options.logBenchmark = static_cast<uint32_t>(value);
+        } else if (arg == "--rewind-check") {
+            options.rewindCheck = true;
+        } else if (arg == "--rewind-minutes" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 600, value)) {
+                std::cerr << "Invalid rewind history: " << argv[i] << std::endl;
+                return false;
+            }
+            options.rewindMinutes = static_cast<uint32_t>(value);
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            char *end = nullptr;
+            options.tolerancePercent = std::strtod(argv[++i], &end);
+            if (end == argv[i] || *end != '\0' || options.tolerancePercent < 0.0 || options.tolerancePercent > 100.0) {
+                std::cerr << "Invalid tolerance: " << argv[i] << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (options.updateGolden && options.goldenDir.empty()) {
+        std::cerr << "--update-golden needs --golden DIR" << std::endl;
+        return false;
+    }
+    if (options.fpsLimit > 0.0 && !options.pacing.empty() && options.pacing != "limit") {
+        std::cerr << "--fps-limit only applies to --pacing limit" << std::endl;
+        return false;
+    }
+    if (options.hotReload && !options.assetPackPath.empty()) {
+        std::cerr << "--hot-reload watches the loose asset files and cannot be combined with --asset-pack" << std::endl;
+        return false;
+    }
+    if ((options.terrainOriginSet || options.terrainScale != 30.0) && options.terrainDir.empty()) {
+        std::cerr << "--terrain-origin and --terrain-scale need --terrain DIR" << std::endl;
+        return false;
+    }
+    if ((options.seekTick > 0 || options.noRender) && options.replayPath.empty()) {
+        std::cerr << "--seek and --no-render need --replay FILE" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * printUsage: List the supported command-line flags
+ */
+void printUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --software         Render on the CPU into an in-memory framebuffer (no window or GL)\n"
+              << "  --benchmark        Fly a fixed camera path with a fixed time step and report frame times\n"
+              << "  --frames N         Stop after N frames (scripted runs default to 300, or the last capture)\n"
+              << "  --size W H         Framebuffer size in pixels (default 800 800)\n"
+              << "  --capture N,M,...  Capture these frames of the scripted flight as PPM images\n"
+              << "  --capture-dir DIR  Where captures and diff images go (default captures)\n"
+              << "  --golden DIR       Compare captures against DIR/frame_NNNNN.ppm; exit code 1 on mismatch\n"
+              << "  --update-golden    Write the captures into the --golden directory instead\n"
+              << "  --tolerance PCT    Percentage of pixels allowed to differ perceptibly (default 0.5)\n"
+              << "  --asset-pack FILE  Load assets from this pack, falling back to loose files for any it lacks\n"
+              << "  --pack-assets FILE Pack every file under src/assets into FILE, then exit\n"
+              << "  --pacing MODE      vsync, adaptive, uncapped or limit (default vsync; uncapped for scripted runs)\n"
+              << "  --fps-limit N      Pace frames to N fps by sleeping and spinning (default for limit: refresh rate)\n"
+              << "  --hot-reload       Reload the plane mesh and texture when their files change\n"
+              << "  --terrain DIR      Fly over the SRTM .hgt elevation files in DIR instead of the flat grid\n"
+              << "  --terrain-origin LAT,LON  Place this point at the world origin (default: centre of the first file)\n"
+              << "  --terrain-scale M  Metres per world unit (default 30, about one SRTM1 sample)\n"
+              << "  --record FILE      Record the session as Y4M video, dropping frames rather than stalling\n"
+              << "  --flight-log FILE  Record plane state and inputs every tick to a compact binary log\n"
+              << "  --replay FILE      Fly a recorded flight log at fixed step, checking each state against it\n"
+              << "  --seek TICK        Start the replay at this tick\n"
+              << "  --no-render        Replay the simulation only, as fast as possible, without a window\n"
+              << "  --rewind-minutes N Keep N minutes of rewind history for Backspace (default 5; off with --flight-log)\n"
+              << "  --rewind-check     Rewind a scripted minute and a half of flight, check it re-flies identically, then exit\n"
+              << "  --seed N           World seed (default: time for interactive runs, 1 for scripted runs)\n"
+              << "  --worldgen-benchmark N  Generate N cubes on one thread and on all threads, then exit\n"
+              << "  --ecs-benchmark N  Time position/velocity updates over N entities as arrays and ECS queries, then exit\n"
+              << "  --log-benchmark N  Time N log calls as the calling thread sees them, then exit\n"
+              << "  --alloc-check      Exit with code 1 if any frame after the warm-up allocates from the heap\n"
+              << "  --memory-budget L  Warn when a subsystem exceeds its budget, e.g. renderer=256,world=64 (MB)\n"
+              << "  --memory-report FILE  Write peak and final memory use per subsystem as JSON\n"
+              << "  --help             Show this message" << std::endl;
+}
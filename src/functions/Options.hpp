@@ -0,0 +1,51 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Command-line settings; frames = 0 runs until the window closes (software runs default to a fixed count)
+// Captures fly the scripted benchmark path so the same frame numbers always show the same view
+struct Options {
+    bool softwareRenderer = false;
+    bool benchmark = false;
+    bool showHelp = false;
+    uint32_t frames = 0;
+    int width = 800, height = 800;
+    std::vector<uint32_t> captureFrames;
+    std::string captureDir = "captures";
+    std::string goldenDir;
+    bool updateGolden = false;
+    double tolerancePercent = 0.5;
+    std::string recordPath;
+    std::string flightLogPath;
+    std::string replayPath;
+    uint32_t seekTick = 0;
+    bool noRender = false;
+    uint32_t rewindMinutes = 5;
+    bool seedSet = false;
+    uint32_t seed = 0;
+    uint32_t worldGenBenchmark = 0;
+    uint32_t ecsBenchmark = 0;
+    uint32_t logBenchmark = 0;
+    bool rewindCheck = false;
+    bool allocCheck = false;
+    std::string memoryReportPath;
+    std::string terrainDir;
+    bool terrainOriginSet = false;
+    double terrainLatitude = 0.0, terrainLongitude = 0.0;
+    double terrainScale = 30.0;
+    std::string assetPackPath;
+    std::string packAssetsPath;
+    bool hotReload = false;
+    std::string pacing;
+    double fpsLimit = 0.0;
+};
+
+extern Options options;
+
+bool parseOptions(int argc, char **argv, Options &options);
+void printUsage(const char *program);
+
+#endif
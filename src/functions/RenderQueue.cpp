@@ -0,0 +1,91 @@
+#include "RenderQueue.hpp"
+#include "FrameMemory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ * makeSortKey: Pack state into a key so sorting groups shaders, then materials, then meshes
+ * Opaque packets are ordered front to back inside a group, transparent ones back to front.
+ */
+uint64_t makeSortKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth, float maxDepth) {
+    float normalized = std::clamp(depth / maxDepth, 0.0f, 1.0f);
+    uint64_t depthBits = static_cast<uint64_t>(normalized * 16777215.0f);
+    if (pass == PASS_TRANSPARENT) depthBits = 16777215u - depthBits;
+
+    return (static_cast<uint64_t>(pass & 0xF) << 60)
+         | (static_cast<uint64_t>(shader & 0xFF) << 52)
+         | (static_cast<uint64_t>(material & 0xFFFF) << 36)
+         | (static_cast<uint64_t>(mesh & 0xFFF) << 24)
+         | depthBits;
+}
+
+/**
+ * clearRenderQueue: Start a new frame; packet storage comes from the frame arena, sized for the peak so far
+ */
+void clearRenderQueue(RenderQueue &queue) {
+    queue.peakPackets = std::max(queue.peakPackets, queue.packets.size());
+    resetFrameVector(queue.packets, queue.peakPackets);
+    resetFrameVector(queue.keys, queue.peakPackets);
+}
+
+void pushDrawPacket(RenderQueue &queue, const DrawPacket &packet, uint64_t key) {
+    queue.packets.push_back(packet);
+    queue.keys.push_back(key);
+}
+
+/**
+ * radixSort: LSD radix sort of 64-bit keys (8 bits per pass) carrying packet indices
+ * Passes where every key shares the same byte are skipped. The ping-pong buffers come from the frame arena.
+ */
+void radixSort(std::pmr::vector<uint64_t> &keys, std::pmr::vector<uint32_t> &order) {
+    size_t count = keys.size();
+    resetFrameVector(order, count);
+    order.resize(count);
+    for (size_t i = 0; i < count; i++) order[i] = static_cast<uint32_t>(i);
+    if (count < 2) return;
+
+    std::pmr::vector<uint64_t> scratchKeys(count, frameArena());
+    std::pmr::vector<uint32_t> scratchOrder(count, frameArena());
+    uint64_t *fromKeys = keys.data(), *toKeys = scratchKeys.data();
+    uint32_t *fromOrder = order.data(), *toOrder = scratchOrder.data();
+
+    uint32_t histograms[8][256] = {};
+    for (uint64_t key : keys) {
+        for (int pass = 0; pass < 8; pass++) histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    for (int pass = 0; pass < 8; pass++) {
+        uint32_t *histogram = histograms[pass];
+        int shift = pass * 8;
+        if (histogram[(fromKeys[0] >> shift) & 0xFF] == count) continue;
+
+        uint32_t offsets[256];
+        uint32_t sum = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            offsets[bucket] = sum;
+            sum += histogram[bucket];
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t slot = offsets[(fromKeys[i] >> shift) & 0xFF]++;
+            toKeys[slot] = fromKeys[i];
+            toOrder[slot] = fromOrder[i];
+        }
+
+        std::swap(fromKeys, toKeys);
+        std::swap(fromOrder, toOrder);
+    }
+
+    if (fromKeys != keys.data()) {
+        std::memcpy(keys.data(), fromKeys, count * sizeof(uint64_t));
+        std::memcpy(order.data(), fromOrder, count * sizeof(uint32_t));
+    }
+}
+
+/**
+ * sortRenderQueue: Sort the frame's packets by key; queue.order holds the submission order
+ */
+void sortRenderQueue(RenderQueue &queue) {
+    radixSort(queue.keys, queue.order);
+}
@@ -0,0 +1,46 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+
+enum RenderPass : uint32_t {
+    PASS_OPAQUE = 0,
+    PASS_TRANSPARENT = 1
+};
+
+struct ShaderProgram;
+struct StaticBatch;
+
+// One recorded draw: everything needed to issue it later in sorted order
+// Static world layers set batch instead of mesh and are issued as one multi-draw
+struct DrawPacket {
+    const GpuMesh *mesh;
+    const StaticBatch *batch;
+    const ShaderProgram *program;
+    GLuint texture;
+    GLenum primitive;
+    float color[3];
+    Mat4 model;
+};
+
+// Per-frame linear buffer of packets, rebuilt in the frame arena with room for the busiest frame so far
+struct RenderQueue {
+    std::pmr::vector<DrawPacket> packets;
+    std::pmr::vector<uint64_t> keys;
+    std::pmr::vector<uint32_t> order;
+    size_t peakPackets = 0;
+};
+
+// Key layout, most significant first: pass:4 | shader:8 | material:16 | mesh:12 | depth:24
+uint64_t makeSortKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth, float maxDepth);
+void clearRenderQueue(RenderQueue &queue);
+void pushDrawPacket(RenderQueue &queue, const DrawPacket &packet, uint64_t key);
+void radixSort(std::pmr::vector<uint64_t> &keys, std::pmr::vector<uint32_t> &order);
+void sortRenderQueue(RenderQueue &queue);
+
+#endif
@@ -0,0 +1,486 @@
+#include "Renderer.hpp"
+#include "HiZ.hpp"
+#include "MemoryTracker.hpp"
+#include "Shader.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Stats.hpp"
+#include <iostream>
+#include <vector>
+
+Renderer renderer;
+MatrixStack modelStack;
+
+namespace {
+
+const char *colorVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 aPosition;
+
+layout(std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+};
+
+uniform mat4 uModel;
+
+void main() {
+    gl_Position = projection * view * uModel * vec4(aPosition, 1.0);
+}
+)";
+
+const char *colorFragmentShader = R"(#version 330 core
+uniform vec3 uColor;
+
+out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(uColor, 1.0);
+}
+)";
+
+const char *meshVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 aPosition;
+#ifdef PACKED_VERTICES
+layout(location = 1) in vec2 aNormal;
+#else
+layout(location = 1) in vec3 aNormal;
+#endif
+layout(location = 2) in vec2 aTexCoord;
+
+layout(std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+};
+
+uniform mat4 uModel;
+uniform vec3 uBoundsMin;
+uniform vec3 uBoundsExtent;
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+    return normalize(n);
+}
+
+void main() {
+#ifdef PACKED_VERTICES
+    vec3 position = uBoundsMin + aPosition * uBoundsExtent;
+    vec3 normal = decodeOctahedral(aNormal);
+#else
+    vec3 position = aPosition;
+    vec3 normal = aNormal;
+#endif
+    mat4 modelView = view * uModel;
+    vNormal = mat3(modelView) * normal;
+    vTexCoord = aTexCoord;
+    gl_Position = projection * modelView * vec4(position, 1.0);
+}
+)";
+
+const char *meshFragmentShader = R"(#version 330 core
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+uniform sampler2D uDiffuse;
+
+out vec4 fragColor;
+
+void main() {
+    float light = 0.35 + 0.65 * max(dot(normalize(vNormal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+    fragColor = vec4(texture(uDiffuse, vTexCoord).rgb * light, 1.0);
+}
+)";
+
+const char *staticVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+layout(location = 3) in mat4 aInstanceModel;
+layout(location = 7) in vec4 aInstanceColor;
+
+layout(std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+};
+
+uniform mat4 uModel;
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main() {
+    mat4 modelView = view * uModel * aInstanceModel;
+    vNormal = mat3(modelView) * aNormal;
+    vTexCoord = aTexCoord;
+    vColor = aInstanceColor;
+    gl_Position = projection * modelView * vec4(aPosition, 1.0);
+}
+)";
+
+// Instances with color.a == 0 are flat colored like the old cubes and grid, 1 means lit and textured
+const char *staticFragmentShader = R"(#version 330 core
+in vec3 vNormal;
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uDiffuse;
+
+out vec4 fragColor;
+
+void main() {
+    if (vColor.a < 0.5) {
+        fragColor = vec4(vColor.rgb, 1.0);
+        return;
+    }
+    float light = 0.35 + 0.65 * max(dot(normalize(vNormal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+    fragColor = vec4(texture(uDiffuse, vTexCoord).rgb * vColor.rgb * light, 1.0);
+}
+)";
+
+ShaderProgram buildProgram(const char *vertexSource, const char *fragmentSource, const std::string &defines = "") {
+    ShaderProgram program;
+    program.id = createProgram(vertexSource, fragmentSource, defines);
+    if (!program.id) return program;
+
+    GLuint cameraBlock = glGetUniformBlockIndex(program.id, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX) glUniformBlockBinding(program.id, cameraBlock, CAMERA_UBO_BINDING);
+
+    program.model = glGetUniformLocation(program.id, "uModel");
+    program.color = glGetUniformLocation(program.id, "uColor");
+    program.boundsMin = glGetUniformLocation(program.id, "uBoundsMin");
+    program.boundsExtent = glGetUniformLocation(program.id, "uBoundsExtent");
+    program.diffuse = glGetUniformLocation(program.id, "uDiffuse");
+    return program;
+}
+
+// Distance in front of the camera of a model matrix origin, used for depth ordering
+float viewDepth(const Mat4 &model) {
+    const float origin[3] = {model.m[12], model.m[13], model.m[14]};
+    float viewPos[4];
+    mat4TransformPoint(renderer.camera.view, origin, viewPos);
+    return -viewPos[2];
+}
+
+void deleteProgram(ShaderProgram &program) {
+    if (program.id) glDeleteProgram(program.id);
+    program = ShaderProgram();
+}
+
+void unitCubeGeometry(std::vector<float> &positions, std::vector<uint32_t> &indices) {
+    positions = {
+        -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, 0.5f, -0.5f,   -0.5f, 0.5f, -0.5f,
+        -0.5f, -0.5f, 0.5f,    0.5f, -0.5f, 0.5f,    0.5f, 0.5f, 0.5f,    -0.5f, 0.5f, 0.5f,
+    };
+    indices = {
+        4, 5, 6, 4, 6, 7,   // front
+        0, 3, 2, 0, 2, 1,   // back
+        3, 7, 6, 3, 6, 2,   // top
+        0, 1, 5, 0, 5, 4,   // bottom
+        1, 2, 6, 1, 6, 5,   // right
+        0, 4, 7, 0, 7, 3,   // left
+    };
+}
+
+GpuMesh buildUnitCube() {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    unitCubeGeometry(positions, indices);
+    if (renderer.backend == BACKEND_OPENGL) return uploadPositionMesh(positions, indices);
+
+    MeshData &data = renderer.unitCubeData;
+    data.vertices.clear();
+    for (size_t i = 0; i < positions.size(); i += 3) {
+        data.vertices.push_back({{positions[i], positions[i + 1], positions[i + 2]}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f}});
+    }
+    data.indices = indices;
+    data.boundsMin = {-0.5f, -0.5f, -0.5f};
+    data.boundsMax = {0.5f, 0.5f, 0.5f};
+    return wrapSoftwareMesh(data, false);
+}
+
+}
+
+/**
+ * applyContextHints: Request an OpenGL 3.3 core profile context
+ */
+void applyContextHints() {
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+}
+
+/**
+ * initRenderer: Load GL entry points and create programs, camera UBO and built-in meshes
+ * The software backend needs no GL context: it only allocates its framebuffer and the meshes.
+ */
+bool initRenderer(RenderBackend backend, int width, int height) {
+    MemoryScope scope(MEMORY_RENDERER);
+    renderer.backend = backend;
+    if (backend == BACKEND_SOFTWARE) {
+        if (!initSoftwareRenderer(width, height)) return false;
+        renderer.unitCube = buildUnitCube();
+        return true;
+    }
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+        std::cerr << "Failed to load OpenGL functions" << std::endl;
+        return false;
+    }
+
+    if (!GLAD_GL_VERSION_3_3) {
+        std::cerr << "OpenGL 3.3 core profile is required" << std::endl;
+        return false;
+    }
+
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+
+    renderer.programs.color = buildProgram(colorVertexShader, colorFragmentShader);
+    renderer.programs.meshFloat = buildProgram(meshVertexShader, meshFragmentShader);
+    renderer.programs.meshPacked = buildProgram(meshVertexShader, meshFragmentShader, "#define PACKED_VERTICES\n");
+    renderer.programs.staticWorld = buildProgram(staticVertexShader, staticFragmentShader);
+    if (!renderer.programs.color.id || !renderer.programs.meshFloat.id || !renderer.programs.meshPacked.id
+        || !renderer.programs.staticWorld.id) {
+        return false;
+    }
+
+    glGenBuffers(1, &renderer.cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, renderer.cameraUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, renderer.cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, renderer.cameraUbo, MEMORY_RENDERER, sizeof(CameraBlock));
+
+    renderer.unitCube = buildUnitCube();
+
+    glEnable(GL_DEPTH_TEST);
+    return true;
+}
+
+/**
+ * shutdownRenderer: Release everything initRenderer created
+ */
+void shutdownRenderer() {
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        renderer.unitCube = GpuMesh();
+        renderer.unitCubeData = MeshData();
+        shutdownSoftwareRenderer();
+        return;
+    }
+
+    destroyMesh(renderer.unitCube);
+    if (renderer.cameraUbo) {
+        releaseGpuMemory(GPU_BUFFER, renderer.cameraUbo);
+        glDeleteBuffers(1, &renderer.cameraUbo);
+    }
+    renderer.cameraUbo = 0;
+    deleteProgram(renderer.programs.color);
+    deleteProgram(renderer.programs.meshFloat);
+    deleteProgram(renderer.programs.meshPacked);
+    deleteProgram(renderer.programs.staticWorld);
+}
+
+/**
+ * backendName: Short name of a rendering backend for logs and benchmark reports
+ */
+const char *backendName(RenderBackend backend) {
+    return backend == BACKEND_SOFTWARE ? "software" : "OpenGL";
+}
+
+/**
+ * createRenderMesh: Upload a mesh for the active backend (the software one references mesh directly)
+ */
+GpuMesh createRenderMesh(const MeshData &mesh, bool packed) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (renderer.backend == BACKEND_SOFTWARE) return wrapSoftwareMesh(mesh, packed);
+    return uploadMesh(mesh, packed);
+}
+
+/**
+ * destroyRenderMesh: Release a mesh created by createRenderMesh
+ */
+void destroyRenderMesh(GpuMesh &mesh) {
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        mesh = GpuMesh();
+        return;
+    }
+    destroyMesh(mesh);
+}
+
+/**
+ * updateRenderMesh: Swap new contents into a mesh made by createRenderMesh; true when its storage was reused
+ */
+bool updateRenderMesh(GpuMesh &mesh, const MeshData &data) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        mesh = wrapSoftwareMesh(data, mesh.packed);
+        return true;
+    }
+    return updateMesh(mesh, data);
+}
+
+/**
+ * loadRenderTexture: Load a texture through the cache for the active backend
+ */
+Texture loadRenderTexture(const std::string &filepath) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (renderer.backend == BACKEND_SOFTWARE) return loadSoftwareTexture(filepath);
+    return loadTexture(filepath);
+}
+
+/**
+ * createRenderTexture: Hand a texture loaded on any thread to the active backend (render thread only)
+ */
+Texture createRenderTexture(const std::string &filepath, const CompressedTexture &texture, bool fromCache, double loadMs) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (renderer.backend == BACKEND_SOFTWARE) return createSoftwareTexture(filepath, texture, fromCache, loadMs);
+    return createTexture(filepath, texture, fromCache, loadMs);
+}
+
+/**
+ * updateRenderTexture: Swap a reloaded texture into one made by createRenderTexture; true when its storage was reused
+ */
+bool updateRenderTexture(Texture &texture, const std::string &filepath, const CompressedTexture &data, bool fromCache,
+                         double loadMs) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (renderer.backend == BACKEND_SOFTWARE) return updateSoftwareTexture(texture, filepath, data, fromCache, loadMs);
+    return updateTexture(texture, filepath, data, fromCache, loadMs);
+}
+
+/**
+ * destroyRenderTexture: Release a texture loaded by loadRenderTexture
+ */
+void destroyRenderTexture(Texture &texture) {
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        destroySoftwareTexture(texture);
+        return;
+    }
+    destroyTexture(texture);
+}
+
+/**
+ * beginFrame: Clear the framebuffer, upload camera matrices and reset the model stack
+ */
+void beginFrame(const Mat4 &projection, const Mat4 &view) {
+    renderer.camera.projection = projection;
+    renderer.camera.view = view;
+
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        clearSoftwareFramebuffer(0.1f, 0.1f, 0.2f);
+    } else {
+        glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, renderer.cameraUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &renderer.camera);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    modelStack.stack.resize(1);
+    modelStack.loadIdentity();
+    clearRenderQueue(renderer.queue);
+    hiZ.built = false;
+    softwareOcclusion.built = false;
+}
+
+/**
+ * submitColored: Record a flat-colored draw of a position-only mesh
+ */
+void submitColored(const GpuMesh &mesh, GLenum primitive, const Mat4 &model, float r, float g, float b) {
+    const ShaderProgram &program = renderer.programs.color;
+    DrawPacket packet = {&mesh, nullptr, &program, 0, primitive, {r, g, b}, model};
+    uint64_t key = makeSortKey(PASS_OPAQUE, program.id, 0, mesh.vao, viewDepth(model), renderer.maxDepth);
+    pushDrawPacket(renderer.queue, packet, key);
+}
+
+/**
+ * submitMesh: Record a textured mesh draw, dequantized in the vertex shader when packed
+ */
+void submitMesh(const GpuMesh &mesh, const Texture &texture, const Mat4 &model) {
+    const ShaderProgram &program = mesh.packed ? renderer.programs.meshPacked : renderer.programs.meshFloat;
+    DrawPacket packet = {&mesh, nullptr, &program, texture.id, GL_TRIANGLES, {1.0f, 1.0f, 1.0f}, model};
+    uint64_t key = makeSortKey(PASS_OPAQUE, program.id, texture.id, mesh.vao, viewDepth(model), renderer.maxDepth);
+    pushDrawPacket(renderer.queue, packet, key);
+}
+
+/**
+ * submitStaticLayer: Cull a static world layer (frustum, plus Hi-Z occlusion on the GPU path) and
+ * record it as a single multi-draw packet
+ */
+void submitStaticLayer(StaticLayer layer, const Mat4 &model) {
+    const StaticBatch *batch = prepareStaticBatch(layer, renderer.camera.projection * renderer.camera.view * model);
+    if (!batch) return;
+
+    const ShaderProgram &program = renderer.programs.staticWorld;
+    DrawPacket packet = {nullptr, batch, &program, batch->texture, batch->primitive, {1.0f, 1.0f, 1.0f}, model};
+    uint64_t key = makeSortKey(PASS_OPAQUE, program.id, batch->texture, batch->vao, 0.0f, renderer.maxDepth);
+    pushDrawPacket(renderer.queue, packet, key);
+}
+
+/**
+ * endFrame: Sort the recorded packets and issue them, skipping redundant state changes
+ * (or hand them to the software rasterizer)
+ */
+void endFrame() {
+    RenderQueue &queue = renderer.queue;
+    sortRenderQueue(queue);
+
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        executeSoftwareQueue(queue, renderer.camera.projection, renderer.camera.view);
+        frameStats.packets += static_cast<uint32_t>(queue.packets.size());
+        clearRenderQueue(queue);
+        return;
+    }
+
+    GLuint currentProgram = 0, currentVao = 0, currentTexture = 0;
+    glActiveTexture(GL_TEXTURE0);
+
+    for (uint32_t index : queue.order) {
+        const DrawPacket &packet = queue.packets[index];
+        const ShaderProgram &program = *packet.program;
+        GLuint vao = packet.batch ? packet.batch->vao : packet.mesh->vao;
+
+        if (program.id != currentProgram) {
+            glUseProgram(program.id);
+            if (program.diffuse >= 0) glUniform1i(program.diffuse, 0);
+            currentProgram = program.id;
+            frameStats.programChanges++;
+        }
+        if (vao != currentVao) {
+            glBindVertexArray(vao);
+            currentVao = vao;
+            frameStats.vaoChanges++;
+        }
+        if (packet.texture && packet.texture != currentTexture) {
+            glBindTexture(GL_TEXTURE_2D, packet.texture);
+            currentTexture = packet.texture;
+            frameStats.textureChanges++;
+        }
+
+        glUniformMatrix4fv(program.model, 1, GL_FALSE, packet.model.m);
+        if (packet.batch) {
+            drawStaticBatch(*packet.batch);
+            continue;
+        }
+
+        const GpuMesh &mesh = *packet.mesh;
+        if (program.color >= 0) glUniform3fv(program.color, 1, packet.color);
+        if (program.boundsMin >= 0) {
+            glUniform3f(program.boundsMin, mesh.boundsMin.x, mesh.boundsMin.y, mesh.boundsMin.z);
+            glUniform3f(program.boundsExtent, mesh.boundsExtent.x, mesh.boundsExtent.y, mesh.boundsExtent.z);
+        }
+
+        glDrawElements(packet.primitive, mesh.indexCount, mesh.indexType, nullptr);
+        frameStats.drawCalls++;
+    }
+
+    frameStats.packets += static_cast<uint32_t>(queue.packets.size());
+    frameStats.stateChanges = frameStats.programChanges + frameStats.vaoChanges + frameStats.textureChanges;
+    clearRenderQueue(queue);
+}
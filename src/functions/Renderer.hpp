@@ -0,0 +1,76 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "TextureCache.hpp"
+#include "RenderQueue.hpp"
+#include "StaticWorld.hpp"
+#include <string>
+
+// std140 layout of the Camera uniform block (binding 0)
+struct CameraBlock {
+    Mat4 projection;
+    Mat4 view;
+};
+
+// Program handle with its uniform locations resolved once at link time
+struct ShaderProgram {
+    GLuint id = 0;
+    GLint model = -1;
+    GLint color = -1;
+    GLint boundsMin = -1;
+    GLint boundsExtent = -1;
+    GLint diffuse = -1;
+};
+
+struct RendererPrograms {
+    ShaderProgram color;
+    ShaderProgram meshFloat;
+    ShaderProgram meshPacked;
+    ShaderProgram staticWorld;
+};
+
+enum RenderBackend {
+    BACKEND_OPENGL,
+    BACKEND_SOFTWARE
+};
+
+// unitCubeData is the CPU copy the software backend draws unitCube from
+struct Renderer {
+    RenderBackend backend = BACKEND_OPENGL;
+    RendererPrograms programs;
+    GLuint cameraUbo = 0;
+    GpuMesh unitCube;
+    MeshData unitCubeData;
+    CameraBlock camera;
+    RenderQueue queue;
+    float maxDepth = 100.0f;
+};
+
+extern Renderer renderer;
+extern MatrixStack modelStack;
+
+const GLuint CAMERA_UBO_BINDING = 0;
+
+void applyContextHints();
+bool initRenderer(RenderBackend backend, int width, int height);
+void shutdownRenderer();
+const char *backendName(RenderBackend backend);
+GpuMesh createRenderMesh(const MeshData &mesh, bool packed);
+void destroyRenderMesh(GpuMesh &mesh);
+bool updateRenderMesh(GpuMesh &mesh, const MeshData &data);
+Texture loadRenderTexture(const std::string &filepath);
+Texture createRenderTexture(const std::string &filepath, const CompressedTexture &texture, bool fromCache, double loadMs);
+bool updateRenderTexture(Texture &texture, const std::string &filepath, const CompressedTexture &data, bool fromCache,
+                         double loadMs);
+void destroyRenderTexture(Texture &texture);
+void beginFrame(const Mat4 &projection, const Mat4 &view);
+void submitColored(const GpuMesh &mesh, GLenum primitive, const Mat4 &model, float r, float g, float b);
+void submitMesh(const GpuMesh &mesh, const Texture &texture, const Mat4 &model);
+void submitStaticLayer(StaticLayer layer, const Mat4 &model);
+void endFrame();
+
+#endif
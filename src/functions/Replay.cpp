@@ -0,0 +1,126 @@
+#include "Replay.hpp"
+#include "Benchmark.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+FlightReplay flightReplay;
+
+/**
+ * startFlightReplay: Load a flight log from the keyframe before seekTick and restore the state to resume from
+ * The recorded state of the tick before seekTick becomes the starting state, so playback begins at seekTick.
+ * When the recorder dropped that tick, playback resyncs to the first recorded state after it instead.
+ */
+bool startFlightReplay(const std::string &path, uint32_t seekTick) {
+    FlightReplay &replay = flightReplay;
+    replay = FlightReplay();
+    if (!loadFlightLog(path, replay.info, replay.ticks, seekTick > 0 ? seekTick - 1 : 0)) return false;
+    if (replay.info.tickRate != SIM_TICKS_PER_SECOND) {
+        std::cerr << "Flight log was recorded at " << replay.info.tickRate << " ticks/s, the simulation runs at "
+                  << SIM_TICKS_PER_SECOND << std::endl;
+        return false;
+    }
+    if (replay.ticks.empty()) {
+        std::cerr << "Flight log has no ticks at or after " << seekTick << ": " << path << std::endl;
+        return false;
+    }
+
+    if (replay.ticks[0].tick < seekTick) {
+        planeState() = replay.ticks[0].state;
+        replay.next = 1;
+    } else if (replay.ticks[0].tick > 0) {
+        planeState() = replay.ticks[0].state;
+        replay.next = 1;
+        replay.resyncs++;
+        std::cout << "Replay: tick " << replay.ticks[0].tick - 1 << " was dropped by the recorder, resuming after tick "
+                  << replay.ticks[0].tick << std::endl;
+    }
+    replay.first = replay.next;
+    replay.seekTick = seekTick;
+    replay.active = true;
+    std::cout << "Replay: " << replay.ticks.size() - replay.next << " ticks from " << path << " starting at tick "
+              << seekTick << " (world seed " << replay.info.worldSeed
+              << ((replay.info.flags & FLIGHT_LOG_SCRIPTED) ? ", scripted flight)" : ")") << std::endl;
+    return true;
+}
+
+/**
+ * nextReplayTick: The next recorded tick and its inputs; false once the recording has run out
+ * Ticks the recorder dropped cannot be simulated: the state jumps to the recorded one after the gap.
+ */
+bool nextReplayTick(uint32_t &tick, uint32_t &inputs) {
+    FlightReplay &replay = flightReplay;
+    if (!replay.active) return false;
+
+    while (replay.next > 0 && replay.next < replay.ticks.size()
+           && replay.ticks[replay.next].tick != replay.ticks[replay.next - 1].tick + 1) {
+        planeState() = replay.ticks[replay.next].state;
+        replay.resyncs++;
+        replay.next++;
+    }
+    if (replay.next >= replay.ticks.size()) return false;
+
+    const FlightTick &recorded = replay.ticks[replay.next];
+    tick = recorded.tick;
+    inputs = recorded.inputs;
+    return true;
+}
+
+/**
+ * verifyReplayTick: Compare the simulated state with the recording for the tick nextReplayTick returned
+ */
+void verifyReplayTick(const PlaneState &state) {
+    FlightReplay &replay = flightReplay;
+    const FlightTick &recorded = replay.ticks[replay.next++];
+    if (std::memcmp(&state, &recorded.state, sizeof(PlaneState)) == 0) return;
+    if (replay.mismatches == 0) replay.firstMismatch = recorded.tick;
+    replay.mismatches++;
+}
+
+/**
+ * finishFlightReplay: Report whether the replay reproduced the recording; false when any state diverged
+ */
+bool finishFlightReplay() {
+    FlightReplay &replay = flightReplay;
+    if (!replay.active) return true;
+    replay.active = false;
+
+    std::cout << "Replay: " << replay.next - replay.first << " of " << replay.ticks.size() - replay.first << " ticks played";
+    if (replay.resyncs > 0) std::cout << ", " << replay.resyncs << " gaps from dropped ticks skipped";
+    if (replay.mismatches == 0) {
+        std::cout << ", all states bit-identical to the recording" << std::endl;
+        return true;
+    }
+    std::cout << ", " << replay.mismatches << " states DIVERGED (first at tick " << replay.firstMismatch << ")"
+              << std::endl;
+    return false;
+}
+
+/**
+ * runHeadlessReplay: Re-simulate a recording as fast as possible without a window or renderer
+ */
+bool runHeadlessReplay(const std::string &path, uint32_t seekTick) {
+    if (!startFlightReplay(path, seekTick)) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    bool scripted = flightReplay.info.flags & FLIGHT_LOG_SCRIPTED;
+    const float deltaTime = 1.0f / SIM_TICKS_PER_SECOND;
+    uint32_t tick = 0, inputs = 0;
+    uint32_t played = 0;
+    while (nextReplayTick(tick, inputs)) {
+        if (scripted) scriptBenchmarkFrame(tick);
+        updatePlaneControls(inputs, deltaTime);
+        verifyReplayTick(planeState());
+        played++;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Replay: simulated " << played << " ticks (" << played / static_cast<double>(SIM_TICKS_PER_SECOND)
+              << " s of flight) in " << ms << " ms" << std::endl;
+    const PlaneState &plane = planeState();
+    std::cout << "Final state: pos (" << plane.posX << ", " << plane.posY << ", " << plane.posZ
+              << ") in sector (" << plane.sectorX << ", " << plane.sectorY << ", " << plane.sectorZ
+              << ") rot (" << plane.rotX << ", " << plane.rotY << ", " << plane.rotZ
+              << ") speed " << plane.speed << std::endl;
+    return finishFlightReplay();
+}
@@ -0,0 +1,32 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FlightRecorder.hpp"
+
+// Playback of a flight log: recorded inputs drive the fixed-step flight model and every resulting
+// state is checked bit for bit against the recording
+struct FlightReplay {
+    FlightLogInfo info;
+    std::vector<FlightTick> ticks;
+    size_t next = 0;
+    size_t first = 0;
+    bool active = false;
+    uint32_t seekTick = 0;
+    uint32_t mismatches = 0;
+    uint32_t firstMismatch = 0;
+    uint32_t resyncs = 0;
+};
+
+extern FlightReplay flightReplay;
+
+bool startFlightReplay(const std::string &path, uint32_t seekTick);
+bool nextReplayTick(uint32_t &tick, uint32_t &inputs);
+void verifyReplayTick(const PlaneState &state);
+bool finishFlightReplay();
+bool runHeadlessReplay(const std::string &path, uint32_t seekTick);
+
+#endif
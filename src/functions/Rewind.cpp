@@ -0,0 +1,319 @@
+#include "Rewind.hpp"
+#include "Benchmark.hpp"
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+RewindBuffer rewindBuffer;
+
+namespace {
+
+uint32_t snapshotIndex(uint32_t age) {
+    RewindBuffer &buffer = rewindBuffer;
+    uint32_t capacity = static_cast<uint32_t>(buffer.snapshots.size());
+    return (buffer.snapshotHead + capacity - 1 - age) % capacity;
+}
+
+void releaseSnapshot(SimSnapshot &snapshot) {
+    RewindBuffer &buffer = rewindBuffer;
+    for (uint32_t chunk : snapshot.cubeChunks) {
+        if (--buffer.chunkRefs[chunk] == 0) buffer.freeChunks.push_back(chunk);
+    }
+    snapshot.cubeChunks.clear();
+}
+
+void dropOldestSnapshot() {
+    RewindBuffer &buffer = rewindBuffer;
+    releaseSnapshot(buffer.snapshots[snapshotIndex(buffer.snapshotCount - 1)]);
+    buffer.snapshotCount--;
+}
+
+void dropNewestSnapshot() {
+    RewindBuffer &buffer = rewindBuffer;
+    uint32_t capacity = static_cast<uint32_t>(buffer.snapshots.size());
+    releaseSnapshot(buffer.snapshots[snapshotIndex(0)]);
+    buffer.snapshotHead = (buffer.snapshotHead + capacity - 1) % capacity;
+    buffer.snapshotCount--;
+}
+
+// True when the previous snapshot's chunk already holds exactly these cubes
+bool sharesChunk(const SimSnapshot *previous, uint32_t chunkIndex, const Cube *cubes, uint32_t count) {
+    return previous && chunkIndex < previous->cubeChunks.size()
+        && std::memcmp(rewindBuffer.chunks[previous->cubeChunks[chunkIndex]].cubes, cubes, count * sizeof(Cube)) == 0;
+}
+
+// Share the previous snapshot's chunk when its cubes are unchanged, otherwise copy into a pooled chunk
+uint32_t snapshotChunk(const SimSnapshot *previous, uint32_t chunkIndex, const Cube *cubes, uint32_t count) {
+    RewindBuffer &buffer = rewindBuffer;
+    if (sharesChunk(previous, chunkIndex, cubes, count)) {
+        uint32_t shared = previous->cubeChunks[chunkIndex];
+        buffer.chunkRefs[shared]++;
+        buffer.chunksShared++;
+        return shared;
+    }
+
+    // takeSnapshot made sure the pool has a chunk for every piece that changed
+    uint32_t chunk = buffer.freeChunks.back();
+    buffer.freeChunks.pop_back();
+    std::memcpy(buffer.chunks[chunk].cubes, cubes, count * sizeof(Cube));
+    buffer.chunkRefs[chunk] = 1;
+    buffer.chunksCopied++;
+    return chunk;
+}
+
+// Visit the world's cubes in pieces of up to REWIND_CUBES_PER_CHUNK; a piece never spans two ECS chunks
+template <typename Fn>
+void forEachCubePiece(Fn &&fn) {
+    uint32_t piece = 0;
+    forEachChunk<Cube>(world, [&](uint32_t rows, Cube *cubes) {
+        for (uint32_t first = 0; first < rows; first += REWIND_CUBES_PER_CHUNK) {
+            fn(piece++, cubes + first, std::min(REWIND_CUBES_PER_CHUNK, rows - first));
+        }
+    });
+}
+
+void takeSnapshot(uint32_t tick) {
+    RewindBuffer &buffer = rewindBuffer;
+    uint32_t capacity = static_cast<uint32_t>(buffer.snapshots.size());
+    if (buffer.snapshotCount == capacity) dropOldestSnapshot();
+
+    // A snapshot can only share with the previous one if the world has the same shape
+    uint32_t cubeCount = countEntities<Cube>(world);
+    const SimSnapshot *previous = buffer.snapshotCount > 0 ? &buffer.snapshots[snapshotIndex(0)] : nullptr;
+    if (previous && previous->cubeCount != cubeCount) previous = nullptr;
+
+    // The pool holds a few copies of the world; when the changed pieces do not fit, the oldest history
+    // makes room, down to the previous snapshot itself, and the snapshot is skipped if even that is not enough
+    uint32_t pieces = 0, changed = 0;
+    forEachCubePiece([&](uint32_t piece, const Cube *cubes, uint32_t count) {
+        pieces++;
+        if (!sharesChunk(previous, piece, cubes, count)) changed++;
+    });
+    while (buffer.freeChunks.size() < changed && buffer.snapshotCount > 1) dropOldestSnapshot();
+    if (buffer.freeChunks.size() < changed && buffer.snapshotCount == 1) {
+        dropOldestSnapshot();
+        previous = nullptr;
+        changed = pieces;
+    }
+    if (buffer.freeChunks.size() < changed) {
+        if (buffer.skippedSnapshots++ == 0) LOG_WARN("Rewind: the world outgrew the snapshot pool, history stops here");
+        return;
+    }
+
+    SimSnapshot &snapshot = buffer.snapshots[buffer.snapshotHead];
+    snapshot.tick = tick;
+    snapshot.plane = planeState();
+    snapshot.cameraRotationX = camera.rotationX;
+    snapshot.cameraRotationY = camera.rotationY;
+    snapshot.cubeCount = cubeCount;
+    forEachCubePiece([&](uint32_t piece, const Cube *cubes, uint32_t count) {
+        snapshot.cubeChunks.push_back(snapshotChunk(previous, piece, cubes, count));
+    });
+    buffer.snapshotHead = (buffer.snapshotHead + 1) % capacity;
+    buffer.snapshotCount++;
+}
+
+}
+
+/**
+ * initRewindBuffer: Size the snapshot ring, chunk pool and input history for the given number of minutes
+ * Call after the world is generated so the chunk pool fits it.
+ */
+void initRewindBuffer(uint32_t minutes, bool scripted) {
+    MemoryScope scope(MEMORY_RECORDER);
+    RewindBuffer &buffer = rewindBuffer;
+    buffer = RewindBuffer();
+    uint32_t historyTicks = minutes * 60 * SIM_TICKS_PER_SECOND;
+    uint32_t snapshotCapacity = historyTicks / REWIND_SNAPSHOT_INTERVAL + 1;
+    uint32_t chunksPerSnapshot = 0;
+    forEachCubePiece([&](uint32_t, const Cube *, uint32_t) { chunksPerSnapshot++; });
+
+    buffer.snapshots.resize(snapshotCapacity);
+    for (SimSnapshot &snapshot : buffer.snapshots) snapshot.cubeChunks.reserve(chunksPerSnapshot);
+
+    // Unchanged chunks are shared, so a few copies of the world cover the history of a mostly static one;
+    // more than a full ring of unshared snapshots could use is never needed
+    uint32_t chunkCapacity = std::min(REWIND_POOL_WORLD_COPIES, snapshotCapacity + 1) * chunksPerSnapshot;
+    buffer.chunks.resize(chunkCapacity);
+    buffer.chunkRefs.assign(chunkCapacity, 0);
+    buffer.freeChunks.reserve(chunkCapacity);
+    for (uint32_t i = chunkCapacity; i > 0; i--) buffer.freeChunks.push_back(i - 1);
+
+    buffer.inputs.assign(historyTicks + REWIND_SNAPSHOT_INTERVAL, 0);
+    buffer.scripted = scripted;
+    buffer.enabled = true;
+}
+
+/**
+ * recordRewindTick: Remember a tick's inputs before it is simulated, snapshotting the state on interval ticks
+ */
+void recordRewindTick(uint32_t tick, uint32_t inputs) {
+    RewindBuffer &buffer = rewindBuffer;
+    if (!buffer.enabled) return;
+
+    if (tick % REWIND_SNAPSHOT_INTERVAL == 0) takeSnapshot(tick);
+    buffer.inputs[tick % buffer.inputs.size()] = inputs;
+}
+
+/**
+ * requestRewind: Ask for a rewind of the given number of seconds at the start of the next frame
+ */
+void requestRewind(uint32_t seconds) {
+    if (rewindBuffer.enabled) rewindBuffer.pendingSeconds += seconds;
+}
+
+/**
+ * applyPendingRewind: Perform a requested rewind, moving tick back; clamps to the oldest snapshot
+ */
+bool applyPendingRewind(uint32_t &tick) {
+    RewindBuffer &buffer = rewindBuffer;
+    if (buffer.pendingSeconds == 0 || buffer.snapshotCount == 0) return false;
+
+    uint32_t back = buffer.pendingSeconds * SIM_TICKS_PER_SECOND;
+    buffer.pendingSeconds = 0;
+    uint32_t oldest = buffer.snapshots[snapshotIndex(buffer.snapshotCount - 1)].tick;
+    uint32_t target = std::max(tick > back ? tick - back : 0, oldest);
+    if (!rewindTo(target)) return false;
+
+    LOG_INFO("Rewound {} s to tick {}", (tick - target) / static_cast<double>(SIM_TICKS_PER_SECOND), target);
+    tick = target;
+    return true;
+}
+
+/**
+ * rewindTo: Restore the sim state at the start of a tick inside the history
+ * Snapshots after the target are discarded; the ticks from there on get simulated and recorded again.
+ */
+bool rewindTo(uint32_t tick) {
+    RewindBuffer &buffer = rewindBuffer;
+    auto start = std::chrono::steady_clock::now();
+
+    uint32_t age = 0;
+    while (age < buffer.snapshotCount && buffer.snapshots[snapshotIndex(age)].tick > tick) age++;
+    if (age == buffer.snapshotCount) {
+        LOG_ERROR("Tick {} is older than the rewind history", tick);
+        return false;
+    }
+
+    const SimSnapshot &snapshot = buffer.snapshots[snapshotIndex(age)];
+    if (snapshot.cubeCount != countEntities<Cube>(world)) {
+        LOG_ERROR("Cannot rewind to tick {}: the world has changed shape since", tick);
+        return false;
+    }
+    planeState() = snapshot.plane;
+    camera.rotationX = snapshot.cameraRotationX;
+    camera.rotationY = snapshot.cameraRotationY;
+    forEachCubePiece([&](uint32_t piece, Cube *cubes, uint32_t count) {
+        std::memcpy(cubes, buffer.chunks[snapshot.cubeChunks[piece]].cubes, count * sizeof(Cube));
+    });
+
+    const float deltaTime = 1.0f / SIM_TICKS_PER_SECOND;
+    for (uint32_t t = snapshot.tick; t < tick; t++) {
+        if (buffer.scripted) scriptBenchmarkFrame(t);
+        updatePlaneControls(buffer.inputs[t % buffer.inputs.size()], deltaTime);
+    }
+
+    while (buffer.snapshotCount > 0 && buffer.snapshots[snapshotIndex(0)].tick >= tick) dropNewestSnapshot();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    buffer.rewinds++;
+    buffer.slowestRewindMs = std::max(buffer.slowestRewindMs, ms);
+    return true;
+}
+
+/**
+ * reportRewindStats: Print how much history is held and how much world data the snapshots share
+ */
+void reportRewindStats() {
+    RewindBuffer &buffer = rewindBuffer;
+    if (!buffer.enabled) return;
+
+    // Chunk references held by the snapshots versus the chunks actually stored and reserved for them
+    uint32_t chunksInUse = static_cast<uint32_t>(buffer.chunks.size() - buffer.freeChunks.size());
+    uint32_t chunkReferences = 0;
+    for (uint32_t age = 0; age < buffer.snapshotCount; age++) {
+        chunkReferences += static_cast<uint32_t>(buffer.snapshots[snapshotIndex(age)].cubeChunks.size());
+    }
+    std::cout << "Rewind: " << buffer.snapshotCount << " snapshots held (every " << REWIND_SNAPSHOT_INTERVAL
+              << " ticks) referencing " << chunkReferences << " world chunks, stored in " << chunksInUse << " of "
+              << buffer.chunks.size() << " reserved (" << buffer.chunks.size() * sizeof(CubeChunk) / 1024
+              << " KB); " << buffer.chunksShared << " shared and " << buffer.chunksCopied << " copied; "
+              << buffer.rewinds << " rewinds, slowest "
+              << buffer.slowestRewindMs << " ms";
+    if (buffer.skippedSnapshots > 0) std::cout << "; " << buffer.skippedSnapshots << " snapshots skipped";
+    std::cout << std::endl;
+}
+
+/**
+ * runRewindCheck: Fly a minute and a half of varied inputs, rewind 10 s and to the oldest snapshot, and
+ * check that flying the same ticks again reproduces every recorded state; then grow the world past what
+ * the chunk pool can hold and keep flying. Returns false on any difference.
+ */
+bool runRewindCheck(uint32_t seed) {
+    const uint32_t totalTicks = 90 * SIM_TICKS_PER_SECOND;
+    const float deltaTime = 1.0f / SIM_TICKS_PER_SECOND;
+    // Hold each random combination of controls for half a second
+    auto inputsAt = [](uint32_t tick) {
+        return ((tick / 30 + 1) * 2654435761u >> 24) & (INPUT_RESET - 1);
+    };
+
+    generateReferenceCubes(seed);
+    initRewindBuffer(1, false);
+    std::vector<Cube> cubes;
+    forEachCubePiece([&](uint32_t, const Cube *piece, uint32_t count) { cubes.insert(cubes.end(), piece, piece + count); });
+
+    std::vector<PlaneState> states(totalTicks);
+    for (uint32_t tick = 0; tick < totalTicks; tick++) {
+        recordRewindTick(tick, inputsAt(tick));
+        updatePlaneControls(inputsAt(tick), deltaTime);
+        states[tick] = planeState();
+    }
+
+    // Each pass rewinds, then flies on to the end comparing against the first flight
+    uint32_t mismatches = 0, firstMismatch = 0, passes = 0;
+    auto reflyFrom = [&](uint32_t target) {
+        if (!rewindTo(target)) {
+            mismatches++;
+            return;
+        }
+        passes++;
+        for (uint32_t tick = target; tick < totalTicks; tick++) {
+            recordRewindTick(tick, inputsAt(tick));
+            updatePlaneControls(inputsAt(tick), deltaTime);
+            if (std::memcmp(&planeState(), &states[tick], sizeof(PlaneState)) == 0) continue;
+            if (mismatches++ == 0) firstMismatch = tick;
+        }
+    };
+    RewindBuffer &buffer = rewindBuffer;
+    reflyFrom(totalTicks - 10 * SIM_TICKS_PER_SECOND - 7);
+    reflyFrom(buffer.snapshots[snapshotIndex(buffer.snapshotCount - 1)].tick);
+
+    uint32_t cube = 0;
+    bool cubesRestored = true;
+    forEachCubePiece([&](uint32_t, const Cube *piece, uint32_t count) {
+        cubesRestored = cubesRestored && std::memcmp(piece, cubes.data() + cube, count * sizeof(Cube)) == 0;
+        cube += count;
+    });
+
+    // Twice the cubes, all moving so no chunk can be shared, overflow the few world copies the pool holds;
+    // older history has to make room instead of the pool running dry
+    for (const Cube &copy : cubes) createEntity(world, Cube{copy.x, copy.y + 1000.0f, copy.z, copy.size, copy.r, copy.g, copy.b});
+    for (uint32_t tick = totalTicks; tick < 2 * totalTicks; tick++) {
+        recordRewindTick(tick, inputsAt(tick));
+        updatePlaneControls(inputsAt(tick), deltaTime);
+        forEach<Cube>(world, [](Cube &moving) { moving.y += 0.01f; });
+    }
+
+    bool passed = mismatches == 0 && passes == 2 && cubesRestored && buffer.snapshotCount > 0;
+    std::cout << "Rewind check: " << totalTicks << " ticks flown, " << passes << " rewinds re-flown";
+    if (mismatches > 0) std::cout << ", " << mismatches << " states DIVERGED (first at tick " << firstMismatch << ")";
+    if (!cubesRestored) std::cout << ", world cubes DIFFER after the rewinds";
+    std::cout << "; after doubling the world " << buffer.snapshotCount << " snapshots held, "
+              << buffer.skippedSnapshots << " skipped" << std::endl;
+    reportRewindStats();
+    std::cout << "Rewind check " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed;
+}
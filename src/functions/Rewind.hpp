@@ -0,0 +1,60 @@
+#ifndef REWIND_HPP
+#define REWIND_HPP
+
+#include <cstdint>
+#include <vector>
+#include "MainFunctions.hpp"
+
+const uint32_t REWIND_SNAPSHOT_INTERVAL = 60;
+const uint32_t REWIND_CUBES_PER_CHUNK = 16;
+const uint32_t REWIND_STEP_SECONDS = 5;
+// The chunk pool holds this many full copies of the world as it was when the buffer was set up
+const uint32_t REWIND_POOL_WORLD_COPIES = 4;
+
+// Fixed block of world cubes shared by every snapshot whose cubes in that range are unchanged
+struct CubeChunk {
+    Cube cubes[REWIND_CUBES_PER_CHUNK];
+};
+
+// Sim state at the start of a tick; cubeChunks index the shared chunk pool
+struct SimSnapshot {
+    uint32_t tick = 0;
+    PlaneState plane = {};
+    float cameraRotationX = 0.0f, cameraRotationY = 0.0f;
+    uint32_t cubeCount = 0;
+    std::vector<uint32_t> cubeChunks;
+};
+
+// Rewind history: a ring of snapshots every REWIND_SNAPSHOT_INTERVAL ticks plus the inputs of every tick
+// since the oldest one. A rewind restores the nearest earlier snapshot and re-simulates the remaining
+// ticks. World chunks are reference counted and only copied when their contents changed since the
+// previous snapshot, from a pool of a few world copies; all storage is allocated up front and reused.
+struct RewindBuffer {
+    std::vector<SimSnapshot> snapshots;
+    uint32_t snapshotHead = 0;
+    uint32_t snapshotCount = 0;
+    std::vector<CubeChunk> chunks;
+    std::vector<uint32_t> chunkRefs;
+    std::vector<uint32_t> freeChunks;
+    std::vector<uint32_t> inputs;
+    uint32_t pendingSeconds = 0;
+    bool scripted = false;
+    bool enabled = false;
+    uint64_t chunksShared = 0;
+    uint64_t chunksCopied = 0;
+    uint32_t rewinds = 0;
+    uint32_t skippedSnapshots = 0;
+    double slowestRewindMs = 0.0;
+};
+
+extern RewindBuffer rewindBuffer;
+
+void initRewindBuffer(uint32_t minutes, bool scripted);
+void recordRewindTick(uint32_t tick, uint32_t inputs);
+void requestRewind(uint32_t seconds);
+bool applyPendingRewind(uint32_t &tick);
+bool rewindTo(uint32_t tick);
+void reportRewindStats();
+bool runRewindCheck(uint32_t seed);
+
+#endif
@@ -0,0 +1,82 @@
+#include "Shader.hpp"
+#include <iostream>
+#include <vector>
+
+/**
+ * compileShader: Compile a GLSL stage, inserting defines right after the #version line
+ */
+GLuint compileShader(GLenum type, const std::string &source, const std::string &defines) {
+    std::string text = source;
+    if (!defines.empty()) {
+        size_t versionEnd = text.rfind("#version", 0) == 0 ? text.find('\n') + 1 : 0;
+        text.insert(versionEnd, defines);
+    }
+
+    GLuint shader = glCreateShader(type);
+    const char *ptr = text.c_str();
+    glShaderSource(shader, 1, &ptr, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetShaderInfoLog(shader, length, nullptr, log.data());
+        std::cerr << "Shader compile failed:\n" << log.data() << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+namespace {
+
+GLuint linkProgram(const std::vector<GLuint> &shaders) {
+    GLuint program = glCreateProgram();
+    for (GLuint shader : shaders) glAttachShader(program, shader);
+    glLinkProgram(program);
+    for (GLuint shader : shaders) glDeleteShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetProgramInfoLog(program, length, nullptr, log.data());
+        std::cerr << "Program link failed:\n" << log.data() << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+}
+
+/**
+ * createProgram: Compile and link a vertex/fragment program
+ */
+GLuint createProgram(const std::string &vertexSource, const std::string &fragmentSource, const std::string &defines) {
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource, defines);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource, defines);
+    if (!vertex || !fragment) {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return 0;
+    }
+
+    return linkProgram({vertex, fragment});
+}
+
+/**
+ * createComputeProgram: Compile and link a compute program (requires GL 4.3)
+ */
+GLuint createComputeProgram(const std::string &computeSource, const std::string &defines) {
+    GLuint compute = compileShader(GL_COMPUTE_SHADER, computeSource, defines);
+    if (!compute) return 0;
+    return linkProgram({compute});
+}
@@ -0,0 +1,18 @@
+#ifndef SHADER_HPP
+#define SHADER_HPP
+
+#include <glad/glad.h>
+#include <string>
+
+// Attribute slots matching the layout(location) qualifiers in every program
+enum VertexAttribute : GLuint {
+    ATTRIB_POSITION = 0,
+    ATTRIB_NORMAL = 1,
+    ATTRIB_TEXCOORD = 2
+};
+
+GLuint compileShader(GLenum type, const std::string &source, const std::string &defines = "");
+GLuint createProgram(const std::string &vertexSource, const std::string &fragmentSource, const std::string &defines = "");
+GLuint createComputeProgram(const std::string &computeSource, const std::string &defines = "");
+
+#endif
@@ -0,0 +1,267 @@
+#include "SoftwareOcclusion.hpp"
+#include "FrameMemory.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <iostream>
+
+SoftwareOcclusion softwareOcclusion;
+
+namespace {
+
+// Depth slack for the occludee test so an object is never hidden by its own rasterized surface
+const float occludeeDepthBias = 1e-5f;
+
+// Box faces as corner quads (corner bits: x = 1, y = 2, z = 4), counter-clockwise seen from outside
+const int boxFaces[6][4] = {
+    {1, 3, 7, 5}, {0, 4, 6, 2},
+    {2, 6, 7, 3}, {0, 1, 5, 4},
+    {4, 5, 7, 6}, {0, 2, 3, 1},
+};
+
+struct ScreenVertex {
+    float x, y, z;
+    bool valid;
+};
+
+ScreenVertex projectCorner(const Mat4 &viewProjection, const float corner[3]) {
+    float clip[4];
+    mat4TransformPoint(viewProjection, corner, clip);
+    ScreenVertex v;
+    v.valid = clip[3] > 1e-6f && clip[2] >= -clip[3];
+    if (!v.valid) return v;
+    float invW = 1.0f / clip[3];
+    v.x = (clip[0] * invW * 0.5f + 0.5f) * SW_OCCLUSION_WIDTH;
+    v.y = (clip[1] * invW * 0.5f + 0.5f) * SW_OCCLUSION_HEIGHT;
+    v.z = clip[2] * invW * 0.5f + 0.5f;
+    return v;
+}
+
+void boxCorner(const OccluderBox &box, int index, float out[3]) {
+    out[0] = (index & 1) ? box.boundsMax[0] : box.boundsMin[0];
+    out[1] = (index & 2) ? box.boundsMax[1] : box.boundsMin[1];
+    out[2] = (index & 4) ? box.boundsMax[2] : box.boundsMin[2];
+}
+
+// Edge i runs between the two vertices other than i, so its value is vertex i's barycentric weight
+bool setupTriangle(const ScreenVertex &v0, const ScreenVertex &v1, const ScreenVertex &v2, RasterTriangle &tri) {
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (area <= 0.0f) return false;
+
+    const ScreenVertex *v[3] = {&v0, &v1, &v2};
+    float invArea = 1.0f / area;
+    tri.depthA = tri.depthB = tri.depthC = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        const ScreenVertex &from = *v[(i + 1) % 3];
+        const ScreenVertex &to = *v[(i + 2) % 3];
+        tri.edgeA[i] = from.y - to.y;
+        tri.edgeB[i] = to.x - from.x;
+        tri.edgeC[i] = -(tri.edgeA[i] * from.x + tri.edgeB[i] * from.y);
+        tri.depthA += v[i]->z * tri.edgeA[i] * invArea;
+        tri.depthB += v[i]->z * tri.edgeB[i] * invArea;
+        tri.depthC += v[i]->z * tri.edgeC[i] * invArea;
+    }
+
+    // Pixels whose centers can fall inside the triangle
+    float minX = std::min({v0.x, v1.x, v2.x}), maxX = std::max({v0.x, v1.x, v2.x});
+    float minY = std::min({v0.y, v1.y, v2.y}), maxY = std::max({v0.y, v1.y, v2.y});
+    tri.minX = std::max(static_cast<int>(std::ceil(minX - 0.5f)), 0);
+    tri.minY = std::max(static_cast<int>(std::ceil(minY - 0.5f)), 0);
+    tri.maxX = std::min(static_cast<int>(std::floor(maxX - 0.5f)), SW_OCCLUSION_WIDTH - 1);
+    tri.maxY = std::min(static_cast<int>(std::floor(maxY - 0.5f)), SW_OCCLUSION_HEIGHT - 1);
+    return tri.minX <= tri.maxX && tri.minY <= tri.maxY;
+}
+
+void rasterizeSpanScalar(const RasterTriangle &tri, float *row, int x0, int x1, float py) {
+    for (int x = x0; x <= x1; x++) {
+        float px = x + 0.5f;
+        bool inside = true;
+        for (int i = 0; i < 3; i++) {
+            inside = inside && tri.edgeA[i] * px + tri.edgeB[i] * py + tri.edgeC[i] >= 0.0f;
+        }
+        if (!inside) continue;
+        float z = tri.depthA * px + tri.depthB * py + tri.depthC;
+        row[x] = std::min(row[x], z);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Eight pixels per step; x0 must be a multiple of 8 so the span stays inside the tile row
+__attribute__((target("avx2,fma")))
+void rasterizeSpanAvx2(const RasterTriangle &tri, float *row, int x0, int x1, float py) {
+    const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 edgeA[3], edgeRow[3];
+    for (int i = 0; i < 3; i++) {
+        edgeA[i] = _mm256_set1_ps(tri.edgeA[i]);
+        edgeRow[i] = _mm256_set1_ps(tri.edgeB[i] * py + tri.edgeC[i]);
+    }
+    __m256 depthA = _mm256_set1_ps(tri.depthA);
+    __m256 depthRow = _mm256_set1_ps(tri.depthB * py + tri.depthC);
+
+    for (int x = x0; x <= x1; x += 8) {
+        __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets);
+        __m256 e0 = _mm256_fmadd_ps(edgeA[0], px, edgeRow[0]);
+        __m256 e1 = _mm256_fmadd_ps(edgeA[1], px, edgeRow[1]);
+        __m256 e2 = _mm256_fmadd_ps(edgeA[2], px, edgeRow[2]);
+        __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+                                      _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+        if (_mm256_testz_ps(inside, inside)) continue;
+
+        __m256 z = _mm256_fmadd_ps(depthA, px, depthRow);
+        __m256 current = _mm256_loadu_ps(row + x);
+        _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), inside));
+    }
+}
+#endif
+
+void rasterizeTile(int tile) {
+    SoftwareOcclusion &occlusion = softwareOcclusion;
+    int tileX0 = (tile % SW_OCCLUSION_TILES_X) * SW_OCCLUSION_TILE;
+    int tileY0 = (tile / SW_OCCLUSION_TILES_X) * SW_OCCLUSION_TILE;
+    int tileX1 = tileX0 + SW_OCCLUSION_TILE - 1;
+    int tileY1 = tileY0 + SW_OCCLUSION_TILE - 1;
+
+    for (int y = tileY0; y <= tileY1; y++) {
+        std::fill_n(&occlusion.depth[y * SW_OCCLUSION_WIDTH + tileX0], SW_OCCLUSION_TILE, 1.0f);
+    }
+
+    const uint32_t *bin = occlusion.binTriangles + static_cast<size_t>(tile) * occlusion.binCapacity;
+    for (uint32_t i = 0; i < occlusion.binCounts[tile]; i++) {
+        const RasterTriangle &tri = occlusion.triangles[bin[i]];
+        int x0 = std::max(tri.minX, tileX0), x1 = std::min(tri.maxX, tileX1);
+        int y0 = std::max(tri.minY, tileY0), y1 = std::min(tri.maxY, tileY1);
+        for (int y = y0; y <= y1; y++) {
+            float *row = &occlusion.depth[y * SW_OCCLUSION_WIDTH];
+#if defined(__x86_64__) || defined(__i386__)
+            if (occlusion.useAvx2) {
+                rasterizeSpanAvx2(tri, row, x0 & ~7, x1, y + 0.5f);
+                continue;
+            }
+#endif
+            rasterizeSpanScalar(tri, row, x0, x1, y + 0.5f);
+        }
+    }
+
+    float farthest = 0.0f;
+    for (int y = tileY0; y <= tileY1; y++) {
+        const float *row = &occlusion.depth[y * SW_OCCLUSION_WIDTH];
+        for (int x = tileX0; x <= tileX1; x++) farthest = std::max(farthest, row[x]);
+    }
+    occlusion.tileMaxDepth[tile] = farthest;
+}
+
+}
+
+/**
+ * initSoftwareOcclusion: Allocate the depth buffer and pick the AVX2 or scalar raster loop
+ * The AVX2 loop is only built for x86; other hosts always take the scalar one.
+ */
+void initSoftwareOcclusion() {
+    MemoryScope scope(MEMORY_RENDERER);
+    softwareOcclusion.depth.assign(SW_OCCLUSION_WIDTH * SW_OCCLUSION_HEIGHT, 1.0f);
+    std::fill(std::begin(softwareOcclusion.tileMaxDepth), std::end(softwareOcclusion.tileMaxDepth), 1.0f);
+#if defined(__x86_64__) || defined(__i386__)
+    softwareOcclusion.useAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    std::cout << "Software occlusion: " << SW_OCCLUSION_WIDTH << "x" << SW_OCCLUSION_HEIGHT << " depth, "
+              << SW_OCCLUSION_TILES_X * SW_OCCLUSION_TILES_Y << " tiles, "
+              << (softwareOcclusion.useAvx2 ? "AVX2" : "scalar") << " on " << threadPoolSize() << " threads" << std::endl;
+}
+
+/**
+ * rasterizeOccluders: Set up and bin the front faces of every box, then rasterize tiles in parallel
+ * Triangles crossing the near plane are dropped, which only ever loses occlusion.
+ */
+void rasterizeOccluders(const Mat4 &viewProjection, const std::vector<OccluderBox> &occluders) {
+    SoftwareOcclusion &occlusion = softwareOcclusion;
+    uint32_t maxTriangles = static_cast<uint32_t>(occluders.size()) * 12;
+    resetFrameVector(occlusion.triangles, maxTriangles);
+    occlusion.binCapacity = maxTriangles;
+    occlusion.binTriangles = static_cast<uint32_t *>(frameArena()->allocate(
+        sizeof(uint32_t) * maxTriangles * SW_OCCLUSION_TILES_X * SW_OCCLUSION_TILES_Y, alignof(uint32_t)));
+    std::fill(std::begin(occlusion.binCounts), std::end(occlusion.binCounts), 0u);
+
+    for (const OccluderBox &box : occluders) {
+        ScreenVertex corners[8];
+        for (int i = 0; i < 8; i++) {
+            float corner[3];
+            boxCorner(box, i, corner);
+            corners[i] = projectCorner(viewProjection, corner);
+        }
+
+        for (const int *face : boxFaces) {
+            const ScreenVertex &a = corners[face[0]], &b = corners[face[1]];
+            const ScreenVertex &c = corners[face[2]], &d = corners[face[3]];
+            if (!a.valid || !b.valid || !c.valid || !d.valid) continue;
+
+            RasterTriangle tris[2];
+            int count = 0;
+            if (setupTriangle(a, b, c, tris[count])) count++;
+            if (setupTriangle(a, c, d, tris[count])) count++;
+            for (int t = 0; t < count; t++) {
+                uint32_t index = static_cast<uint32_t>(occlusion.triangles.size());
+                occlusion.triangles.push_back(tris[t]);
+                for (int ty = tris[t].minY / SW_OCCLUSION_TILE; ty <= tris[t].maxY / SW_OCCLUSION_TILE; ty++) {
+                    for (int tx = tris[t].minX / SW_OCCLUSION_TILE; tx <= tris[t].maxX / SW_OCCLUSION_TILE; tx++) {
+                        int tile = ty * SW_OCCLUSION_TILES_X + tx;
+                        occlusion.binTriangles[static_cast<size_t>(tile) * maxTriangles + occlusion.binCounts[tile]++] = index;
+                    }
+                }
+            }
+        }
+    }
+
+    parallelFor(SW_OCCLUSION_TILES_X * SW_OCCLUSION_TILES_Y, [](uint32_t tile) { rasterizeTile(static_cast<int>(tile)); });
+    occlusion.built = true;
+}
+
+/**
+ * softwareOcclusionTest: True when every pixel under the box's screen rectangle is nearer than the box
+ */
+bool softwareOcclusionTest(const Mat4 &viewProjection, const float boundsMin[3], const float boundsMax[3]) {
+    const SoftwareOcclusion &occlusion = softwareOcclusion;
+    OccluderBox box;
+    std::copy(boundsMin, boundsMin + 3, box.boundsMin);
+    std::copy(boundsMax, boundsMax + 3, box.boundsMax);
+
+    float minX = SW_OCCLUSION_WIDTH, minY = SW_OCCLUSION_HEIGHT, maxX = 0.0f, maxY = 0.0f, nearest = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        float corner[3];
+        boxCorner(box, i, corner);
+        ScreenVertex v = projectCorner(viewProjection, corner);
+        if (!v.valid) return false;
+        minX = std::min(minX, v.x);
+        minY = std::min(minY, v.y);
+        maxX = std::max(maxX, v.x);
+        maxY = std::max(maxY, v.y);
+        nearest = std::min(nearest, v.z);
+    }
+    nearest -= occludeeDepthBias;
+
+    // Every pixel the rectangle touches
+    int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+    int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+    int x1 = std::min(static_cast<int>(std::ceil(maxX)) - 1, SW_OCCLUSION_WIDTH - 1);
+    int y1 = std::min(static_cast<int>(std::ceil(maxY)) - 1, SW_OCCLUSION_HEIGHT - 1);
+    if (x0 > x1 || y0 > y1) return false;
+
+    for (int ty = y0 / SW_OCCLUSION_TILE; ty <= y1 / SW_OCCLUSION_TILE; ty++) {
+        for (int tx = x0 / SW_OCCLUSION_TILE; tx <= x1 / SW_OCCLUSION_TILE; tx++) {
+            if (occlusion.tileMaxDepth[ty * SW_OCCLUSION_TILES_X + tx] < nearest) continue;
+
+            int px0 = std::max(x0, tx * SW_OCCLUSION_TILE), px1 = std::min(x1, tx * SW_OCCLUSION_TILE + SW_OCCLUSION_TILE - 1);
+            int py0 = std::max(y0, ty * SW_OCCLUSION_TILE), py1 = std::min(y1, ty * SW_OCCLUSION_TILE + SW_OCCLUSION_TILE - 1);
+            for (int y = py0; y <= py1; y++) {
+                const float *row = &occlusion.depth[y * SW_OCCLUSION_WIDTH];
+                for (int x = px0; x <= px1; x++) {
+                    if (row[x] >= nearest) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
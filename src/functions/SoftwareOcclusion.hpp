@@ -0,0 +1,48 @@
+#ifndef SOFTWARE_OCCLUSION_HPP
+#define SOFTWARE_OCCLUSION_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "Matrix.hpp"
+
+const int SW_OCCLUSION_WIDTH = 256;
+const int SW_OCCLUSION_HEIGHT = 128;
+const int SW_OCCLUSION_TILE = 32;
+const int SW_OCCLUSION_TILES_X = SW_OCCLUSION_WIDTH / SW_OCCLUSION_TILE;
+const int SW_OCCLUSION_TILES_Y = SW_OCCLUSION_HEIGHT / SW_OCCLUSION_TILE;
+
+// Solid box occluder; any closed convex box-shaped object can stand in for itself
+struct OccluderBox {
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// Screen-space triangle with edge and depth planes: inside when all edges >= 0
+struct RasterTriangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depthA, depthB, depthC;
+    int minX, minY, maxX, maxY;
+};
+
+// Low-resolution CPU depth buffer (nearest depth per pixel, window depth in [0, 1])
+// Triangles and bins are rebuilt in the frame arena; every box adds at most 12 triangles, so each
+// tile's bin gets room for all of them and binning never grows a buffer
+struct SoftwareOcclusion {
+    std::vector<float> depth;
+    float tileMaxDepth[SW_OCCLUSION_TILES_X * SW_OCCLUSION_TILES_Y];
+    std::pmr::vector<RasterTriangle> triangles;
+    uint32_t *binTriangles = nullptr;
+    uint32_t binCapacity = 0;
+    uint32_t binCounts[SW_OCCLUSION_TILES_X * SW_OCCLUSION_TILES_Y];
+    bool useAvx2 = false;
+    bool built = false;
+};
+
+extern SoftwareOcclusion softwareOcclusion;
+
+void initSoftwareOcclusion();
+void rasterizeOccluders(const Mat4 &viewProjection, const std::vector<OccluderBox> &occluders);
+bool softwareOcclusionTest(const Mat4 &viewProjection, const float boundsMin[3], const float boundsMax[3]);
+
+#endif
@@ -0,0 +1,585 @@
+#include "SoftwareRenderer.hpp"
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include "Renderer.hpp"
+#include "StaticWorld.hpp"
+#include "Stats.hpp"
+#include "ThreadPool.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+SoftwareRenderer softwareRenderer;
+
+namespace {
+
+// normalize(vec3(0.3, 0.8, 0.5)) from the GL fragment shaders
+const float lightDirection[3] = {0.30305f, 0.80812f, 0.50508f};
+const float lineHalfWidth = 0.5f;
+const uint32_t transformChunk = 1024;
+
+enum Shading {
+    SHADE_FLAT,
+    SHADE_LIT
+};
+
+// Window-space vertex between clipping and triangle setup
+struct ScreenVertex {
+    float x, y, z, inverseW;
+    float uv[2];
+    float color[3];
+};
+
+uint32_t packColor(float r, float g, float b) {
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | 0xff000000u;
+}
+
+float evaluatePlane(const float plane[3], float x, float y) {
+    return plane[0] * x + plane[1] * y + plane[2];
+}
+
+// Edge and depth planes exactly as the AVX2 loop evaluates them: the row term, then one fused multiply-add
+// along x, so both loops cover and depth-test the same pixels
+float evaluateRasterPlane(const float plane[3], float x, float y) {
+    return std::fma(plane[0], x, plane[1] * y + plane[2]);
+}
+
+// Bilinear sample with GL_REPEAT wrapping; texel row 0 is v = 0 as uploaded to GL
+void sampleBilinear(const SoftwareTextureLevel &level, float u, float v, float out[3]) {
+    float x = u * level.width - 0.5f;
+    float y = v * level.height - 0.5f;
+    float fx = std::floor(x), fy = std::floor(y);
+    float tx = x - fx, ty = y - fy;
+    auto wrap = [](int value, int size) {
+        value %= size;
+        return value < 0 ? value + size : value;
+    };
+    int x0 = wrap(static_cast<int>(fx), level.width), x1 = wrap(x0 + 1, level.width);
+    int y0 = wrap(static_cast<int>(fy), level.height), y1 = wrap(y0 + 1, level.height);
+    const uint32_t corners[4] = {
+        level.texels[y0 * level.width + x0], level.texels[y0 * level.width + x1],
+        level.texels[y1 * level.width + x0], level.texels[y1 * level.width + x1],
+    };
+    const float weights[4] = {(1 - tx) * (1 - ty), tx * (1 - ty), (1 - tx) * ty, tx * ty};
+    for (int c = 0; c < 3; c++) {
+        float sum = 0.0f;
+        for (int k = 0; k < 4; k++) sum += weights[k] * ((corners[k] >> (c * 8)) & 0xff);
+        out[c] = sum * (1.0f / 255.0f);
+    }
+}
+
+void shadePixel(const SoftwareTriangle &triangle, int x, int y) {
+    float px = x + 0.5f, py = y + 0.5f;
+    float w = 1.0f / evaluatePlane(triangle.inverseW, px, py);
+    float rgb[3];
+    for (int c = 0; c < 3; c++) rgb[c] = evaluatePlane(triangle.color[c], px, py) * w;
+    if (triangle.texture) {
+        float texel[3];
+        sampleBilinear(*triangle.texture, evaluatePlane(triangle.uv[0], px, py) * w,
+                       evaluatePlane(triangle.uv[1], px, py) * w, texel);
+        for (int c = 0; c < 3; c++) rgb[c] *= texel[c];
+    }
+    softwareRenderer.color[static_cast<size_t>(y) * softwareRenderer.width + x] = packColor(rgb[0], rgb[1], rgb[2]);
+}
+
+void rasterizeRectScalar(const SoftwareTriangle &triangle, int minX, int minY, int maxX, int maxY) {
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        float *depthRow = softwareRenderer.depth.data() + static_cast<size_t>(y) * softwareRenderer.width;
+        for (int x = minX; x <= maxX; x++) {
+            float px = x + 0.5f;
+            if (evaluateRasterPlane(triangle.edges[0], px, py) < 0.0f
+                || evaluateRasterPlane(triangle.edges[1], px, py) < 0.0f
+                || evaluateRasterPlane(triangle.edges[2], px, py) < 0.0f) {
+                continue;
+            }
+            float z = evaluateRasterPlane(triangle.depth, px, py);
+            if (z >= depthRow[x]) continue;
+            depthRow[x] = z;
+            shadePixel(triangle, x, y);
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Eight pixels per step: edge functions, coverage and the depth test in AVX2, shading per covered pixel
+__attribute__((target("avx2,fma")))
+void rasterizeRectAvx2(const SoftwareTriangle &triangle, int minX, int minY, int maxX, int maxY) {
+    const __m256 laneCenters = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256i laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 edgeX[3];
+    for (int e = 0; e < 3; e++) edgeX[e] = _mm256_set1_ps(triangle.edges[e][0]);
+    __m256 depthX = _mm256_set1_ps(triangle.depth[0]);
+
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        __m256 edgeRow[3];
+        for (int e = 0; e < 3; e++) edgeRow[e] = _mm256_set1_ps(triangle.edges[e][1] * py + triangle.edges[e][2]);
+        __m256 depthRow = _mm256_set1_ps(triangle.depth[1] * py + triangle.depth[2]);
+        float *depth = softwareRenderer.depth.data() + static_cast<size_t>(y) * softwareRenderer.width;
+
+        for (int x = minX; x <= maxX; x += 8) {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneCenters);
+            __m256 inside = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(maxX - x + 1), laneIndices));
+            for (int e = 0; e < 3; e++) {
+                __m256 value = _mm256_fmadd_ps(edgeX[e], px, edgeRow[e]);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(value, zero, _CMP_GE_OQ));
+            }
+            if (_mm256_testz_ps(inside, inside)) continue;
+
+            __m256 z = _mm256_fmadd_ps(depthX, px, depthRow);
+            __m256 stored = _mm256_maskload_ps(depth + x, _mm256_castps_si256(inside));
+            __m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(z, stored, _CMP_LT_OQ));
+            int bits = _mm256_movemask_ps(pass);
+            if (!bits) continue;
+            _mm256_maskstore_ps(depth + x, _mm256_castps_si256(pass), z);
+
+            while (bits) {
+                shadePixel(triangle, x + __builtin_ctz(bits), y);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+#endif
+
+void rasterizeTile(uint32_t tile) {
+    SoftwareRenderer &sw = softwareRenderer;
+    int tileMinX = static_cast<int>(tile % sw.tilesX) * SW_RENDER_TILE;
+    int tileMinY = static_cast<int>(tile / sw.tilesX) * SW_RENDER_TILE;
+    int tileMaxX = std::min(tileMinX + SW_RENDER_TILE, sw.width) - 1;
+    int tileMaxY = std::min(tileMinY + SW_RENDER_TILE, sw.height) - 1;
+
+    for (const SoftwareBinBlock *block = sw.bins[tile].first; block; block = block->next) {
+        for (uint32_t i = 0; i < block->count; i++) {
+            const SoftwareTriangle &triangle = sw.triangles[block->triangles[i]];
+            int minX = std::max(triangle.minX, tileMinX), maxX = std::min(triangle.maxX, tileMaxX);
+            int minY = std::max(triangle.minY, tileMinY), maxY = std::min(triangle.maxY, tileMaxY);
+#if defined(__x86_64__) || defined(__i386__)
+            if (sw.useAvx2) {
+                rasterizeRectAvx2(triangle, minX, minY, maxX, maxY);
+                continue;
+            }
+#endif
+            rasterizeRectScalar(triangle, minX, minY, maxX, maxY);
+        }
+    }
+}
+
+// Decode every mip level of compressed into registry slot id (1-based), replacing what the slot held
+Texture decodeSoftwareTexture(GLuint id, const std::string &filepath, const CompressedTexture &compressed,
+                              bool fromCache, double loadMs) {
+    Texture result;
+    result.fromCache = fromCache;
+    auto start = std::chrono::steady_clock::now();
+
+    SoftwareTexture texture;
+    for (size_t i = 0; i < compressed.levels.size(); i++) {
+        std::vector<uint8_t> rgba = decompressLevel(compressed, i);
+        SoftwareTextureLevel level;
+        level.width = static_cast<int>(compressed.levels[i].width);
+        level.height = static_cast<int>(compressed.levels[i].height);
+        level.texels.resize(static_cast<size_t>(level.width) * level.height);
+        std::memcpy(level.texels.data(), rgba.data(), level.texels.size() * sizeof(uint32_t));
+        result.rawBytes += rgba.size();
+        texture.levels.push_back(std::move(level));
+    }
+
+    softwareRenderer.textures[id - 1] = std::move(texture);
+    result.id = id;
+    result.width = static_cast<int>(compressed.width);
+    result.height = static_cast<int>(compressed.height);
+    result.gpuBytes = result.rawBytes;
+    result.loadMs = loadMs + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    LOG_INFO("Texture: {} {}x{}, {} mip levels decoded for the software renderer ({} KB) in {} ms",
+             std::filesystem::path(filepath).filename().string(), result.width, result.height,
+             compressed.levels.size(), result.rawBytes / 1024, result.loadMs);
+    return result;
+}
+
+ScreenVertex toScreen(const ClipVertex &v) {
+    ScreenVertex s;
+    s.inverseW = 1.0f / v.position[3];
+    s.x = (v.position[0] * s.inverseW * 0.5f + 0.5f) * softwareRenderer.width;
+    s.y = (v.position[1] * s.inverseW * 0.5f + 0.5f) * softwareRenderer.height;
+    s.z = v.position[2] * s.inverseW * 0.5f + 0.5f;
+    std::copy(v.uv, v.uv + 2, s.uv);
+    std::copy(v.color, v.color + 3, s.color);
+    return s;
+}
+
+ClipVertex lerpVertex(const ClipVertex &a, const ClipVertex &b, float t) {
+    ClipVertex v;
+    for (int k = 0; k < 4; k++) v.position[k] = a.position[k] + (b.position[k] - a.position[k]) * t;
+    for (int k = 0; k < 2; k++) v.uv[k] = a.uv[k] + (b.uv[k] - a.uv[k]) * t;
+    for (int k = 0; k < 3; k++) v.color[k] = a.color[k] + (b.color[k] - a.color[k]) * t;
+    return v;
+}
+
+// Signed distance to the GL near plane (z >= -w)
+float nearDistance(const ClipVertex &v) {
+    return v.position[2] + v.position[3];
+}
+
+// Attribute plane through three vertex values, using the barycentric edge planes
+void attributePlane(const float edges[3][3], float a, float b, float c, float out[3]) {
+    for (int k = 0; k < 3; k++) out[k] = edges[1][k] * a + edges[2][k] * b + edges[0][k] * c;
+}
+
+void binTriangle(SoftwareBin &bin, uint32_t index) {
+    SoftwareBinBlock *block = bin.last;
+    if (!block || block->count == SW_BIN_BLOCK_TRIANGLES) {
+        block = static_cast<SoftwareBinBlock *>(softwareRenderer.binPool.allocate(sizeof(SoftwareBinBlock),
+                                                                                  alignof(SoftwareBinBlock)));
+        block->next = nullptr;
+        block->count = 0;
+        (bin.last ? bin.last->next : bin.first) = block;
+        bin.last = block;
+    }
+    block->triangles[block->count++] = index;
+}
+
+// Return every bin's blocks to the pool for the next frame
+void clearBins() {
+    SoftwareRenderer &sw = softwareRenderer;
+    for (SoftwareBin &bin : sw.bins) {
+        for (SoftwareBinBlock *block = bin.first; block;) {
+            SoftwareBinBlock *next = block->next;
+            sw.binPool.deallocate(block, sizeof(SoftwareBinBlock), alignof(SoftwareBinBlock));
+            block = next;
+        }
+        bin = SoftwareBin();
+    }
+}
+
+// Edge planes, attribute planes, mip level and bins for one window-space triangle (either winding)
+void setupTriangle(const ScreenVertex &a, const ScreenVertex &b, const ScreenVertex &c, const SoftwareTexture *texture) {
+    SoftwareRenderer &sw = softwareRenderer;
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0.0f || !std::isfinite(area)) return;
+
+    SoftwareTriangle triangle;
+    triangle.minX = std::max(static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))), 0);
+    triangle.minY = std::max(static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))), 0);
+    triangle.maxX = std::min(static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))), sw.width - 1);
+    triangle.maxY = std::min(static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))), sw.height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+    // edges[e] runs from vertex e to e + 1, so normalized by the area it is the weight of the third vertex
+    const ScreenVertex *v[3] = {&a, &b, &c};
+    float inverseArea = 1.0f / area;
+    for (int e = 0; e < 3; e++) {
+        const ScreenVertex &from = *v[e];
+        const ScreenVertex &to = *v[(e + 1) % 3];
+        triangle.edges[e][0] = -(to.y - from.y) * inverseArea;
+        triangle.edges[e][1] = (to.x - from.x) * inverseArea;
+        triangle.edges[e][2] = -(triangle.edges[e][0] * from.x + triangle.edges[e][1] * from.y);
+    }
+
+    attributePlane(triangle.edges, a.z, b.z, c.z, triangle.depth);
+    attributePlane(triangle.edges, a.inverseW, b.inverseW, c.inverseW, triangle.inverseW);
+    for (int k = 0; k < 2; k++) {
+        attributePlane(triangle.edges, a.uv[k] * a.inverseW, b.uv[k] * b.inverseW, c.uv[k] * c.inverseW, triangle.uv[k]);
+    }
+    for (int k = 0; k < 3; k++) {
+        attributePlane(triangle.edges, a.color[k] * a.inverseW, b.color[k] * b.inverseW, c.color[k] * c.inverseW,
+                       triangle.color[k]);
+    }
+
+    // One mip level per triangle from the ratio of texel area to pixel area
+    triangle.texture = nullptr;
+    if (texture && !texture->levels.empty()) {
+        const SoftwareTextureLevel &base = texture->levels[0];
+        float uvArea = std::fabs((b.uv[0] - a.uv[0]) * (c.uv[1] - a.uv[1]) - (b.uv[1] - a.uv[1]) * (c.uv[0] - a.uv[0]));
+        float texelArea = uvArea * base.width * base.height;
+        float lod = texelArea > 0.0f ? 0.5f * std::log2(texelArea / std::fabs(area)) : 0.0f;
+        int level = std::clamp(static_cast<int>(lod + 0.5f), 0, static_cast<int>(texture->levels.size()) - 1);
+        triangle.texture = &texture->levels[level];
+    }
+
+    uint32_t index = static_cast<uint32_t>(sw.triangles.size());
+    sw.triangles.push_back(triangle);
+    for (int ty = triangle.minY / SW_RENDER_TILE; ty <= triangle.maxY / SW_RENDER_TILE; ty++) {
+        for (int tx = triangle.minX / SW_RENDER_TILE; tx <= triangle.maxX / SW_RENDER_TILE; tx++) {
+            binTriangle(sw.bins[ty * sw.tilesX + tx], index);
+        }
+    }
+}
+
+// Clip against the near plane (one triangle becomes up to two) and set up the result
+void clipTriangle(const ClipVertex &a, const ClipVertex &b, const ClipVertex &c, const SoftwareTexture *texture) {
+    const ClipVertex *input[3] = {&a, &b, &c};
+    float distances[3] = {nearDistance(a), nearDistance(b), nearDistance(c)};
+    if (distances[0] >= 0.0f && distances[1] >= 0.0f && distances[2] >= 0.0f) {
+        setupTriangle(toScreen(a), toScreen(b), toScreen(c), texture);
+        return;
+    }
+
+    ClipVertex polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++) {
+        int j = (i + 1) % 3;
+        if (distances[i] >= 0.0f) polygon[count++] = *input[i];
+        if ((distances[i] >= 0.0f) != (distances[j] >= 0.0f)) {
+            polygon[count++] = lerpVertex(*input[i], *input[j], distances[i] / (distances[i] - distances[j]));
+        }
+    }
+    if (count < 3) return;
+
+    ScreenVertex first = toScreen(polygon[0]);
+    for (int i = 1; i + 1 < count; i++) setupTriangle(first, toScreen(polygon[i]), toScreen(polygon[i + 1]), texture);
+}
+
+// Lines become one-pixel-wide screen-space quads
+void clipLine(const ClipVertex &a, const ClipVertex &b) {
+    float da = nearDistance(a), db = nearDistance(b);
+    if (da < 0.0f && db < 0.0f) return;
+    ScreenVertex s0 = toScreen(da < 0.0f ? lerpVertex(a, b, da / (da - db)) : a);
+    ScreenVertex s1 = toScreen(db < 0.0f ? lerpVertex(a, b, da / (da - db)) : b);
+    float dx = s1.x - s0.x, dy = s1.y - s0.y;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f || !std::isfinite(length)) return;
+    float nx = -dy / length * lineHalfWidth, ny = dx / length * lineHalfWidth;
+
+    ScreenVertex corners[4] = {s0, s1, s1, s0};
+    corners[0].x += nx; corners[0].y += ny;
+    corners[1].x += nx; corners[1].y += ny;
+    corners[2].x -= nx; corners[2].y -= ny;
+    corners[3].x -= nx; corners[3].y -= ny;
+    setupTriangle(corners[0], corners[1], corners[2], nullptr);
+    setupTriangle(corners[0], corners[2], corners[3], nullptr);
+}
+
+// Vertex stage: transform and light vertices, in parallel chunks for large meshes
+void transformVertices(const MeshVertex *vertices, uint32_t vertexCount, const Mat4 &modelView, const Mat4 &projection,
+                       const float color[3], Shading shading) {
+    std::vector<ClipVertex> &out = softwareRenderer.vertices;
+    out.resize(vertexCount);
+    const Mat4 modelViewProjection = projection * modelView;
+    const float *m = modelView.m;
+
+    auto transformChunkAt = [&](uint32_t chunk) {
+        uint32_t end = std::min(vertexCount, (chunk + 1) * transformChunk);
+        for (uint32_t i = chunk * transformChunk; i < end; i++) {
+            const MeshVertex &v = vertices[i];
+            ClipVertex &clip = out[i];
+            mat4TransformPoint(modelViewProjection, v.position, clip.position);
+            clip.uv[0] = v.uv[0];
+            clip.uv[1] = v.uv[1];
+
+            float light = 1.0f;
+            if (shading == SHADE_LIT) {
+                float n[3];
+                for (int k = 0; k < 3; k++) n[k] = m[k] * v.normal[0] + m[4 + k] * v.normal[1] + m[8 + k] * v.normal[2];
+                float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                float facing = length > 0.0f
+                    ? (n[0] * lightDirection[0] + n[1] * lightDirection[1] + n[2] * lightDirection[2]) / length
+                    : 0.0f;
+                light = 0.35f + 0.65f * std::max(facing, 0.0f);
+            }
+            for (int k = 0; k < 3; k++) clip.color[k] = color[k] * light;
+        }
+    };
+
+    uint32_t chunks = (vertexCount + transformChunk - 1) / transformChunk;
+    parallelFor(chunks, transformChunkAt);
+}
+
+void drawIndexed(const MeshVertex *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount,
+                 GLenum primitive, const Mat4 &modelView, const Mat4 &projection, const float color[3],
+                 Shading shading, const SoftwareTexture *texture) {
+    transformVertices(vertices, vertexCount, modelView, projection, color, shading);
+    const std::vector<ClipVertex> &clip = softwareRenderer.vertices;
+
+    if (primitive == GL_LINES) {
+        for (uint32_t i = 0; i + 1 < indexCount; i += 2) clipLine(clip[indices[i]], clip[indices[i + 1]]);
+    } else {
+        for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+            clipTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]], texture);
+        }
+    }
+    frameStats.drawCalls++;
+}
+
+const SoftwareTexture *findTexture(GLuint id) {
+    if (id == 0 || id > softwareRenderer.textures.size()) return nullptr;
+    return &softwareRenderer.textures[id - 1];
+}
+
+// Static layers: each command draws one mesh range for a run of compacted instances
+void drawStaticBatchSoftware(const StaticBatch &batch, const Mat4 &model, const Mat4 &view, const Mat4 &projection) {
+    const SoftwareTexture *texture = findTexture(batch.texture);
+    for (const DrawElementsIndirectCommand &command : batch.commands) {
+        // Commands only carry index ranges; meshes are few, so find the one that starts there
+        const StaticMesh *mesh = nullptr;
+        for (const StaticMesh &candidate : staticWorld.meshes) {
+            if (candidate.firstIndex == command.firstIndex) mesh = &candidate;
+        }
+        if (!mesh) continue;
+
+        const MeshVertex *vertices = staticWorld.vertices.data() + mesh->baseVertex;
+        const uint32_t *indices = staticWorld.indices.data() + mesh->firstIndex;
+        for (uint32_t i = 0; i < command.instanceCount; i++) {
+            const StaticInstance &instance = batch.instances[command.baseInstance + i];
+            bool textured = instance.color[3] >= 0.5f;
+            drawIndexed(vertices, mesh->vertexCount, indices, mesh->indexCount, batch.primitive,
+                        view * model * instance.model, projection, instance.color,
+                        textured ? SHADE_LIT : SHADE_FLAT, textured ? texture : nullptr);
+        }
+    }
+}
+
+}
+
+/**
+ * initSoftwareRenderer: Allocate the CPU framebuffer and tile bins
+ */
+bool initSoftwareRenderer(int width, int height) {
+    MemoryScope scope(MEMORY_RENDERER);
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Invalid software framebuffer size " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    SoftwareRenderer &sw = softwareRenderer;
+    sw.width = width;
+    sw.height = height;
+    sw.tilesX = (width + SW_RENDER_TILE - 1) / SW_RENDER_TILE;
+    sw.tilesY = (height + SW_RENDER_TILE - 1) / SW_RENDER_TILE;
+    sw.color.assign(static_cast<size_t>(width) * height, 0);
+    sw.depth.assign(static_cast<size_t>(width) * height, 1.0f);
+    sw.bins.assign(sw.tilesX * sw.tilesY, {});
+#if defined(__x86_64__) || defined(__i386__)
+    sw.useAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+
+    std::cout << "Software renderer: " << width << "x" << height << ", " << sw.tilesX * sw.tilesY << " tiles of "
+              << SW_RENDER_TILE << "x" << SW_RENDER_TILE << " on " << threadPoolSize() << " threads, "
+              << (sw.useAvx2 ? "AVX2" : "scalar") << " rasterizer" << std::endl;
+    return true;
+}
+
+/**
+ * shutdownSoftwareRenderer: Release the framebuffer and every decoded texture
+ */
+void shutdownSoftwareRenderer() {
+    softwareRenderer = SoftwareRenderer();
+}
+
+/**
+ * clearSoftwareFramebuffer: Fill color with the clear color and depth with the far plane
+ */
+void clearSoftwareFramebuffer(float r, float g, float b) {
+    std::fill(softwareRenderer.color.begin(), softwareRenderer.color.end(), packColor(r, g, b));
+    std::fill(softwareRenderer.depth.begin(), softwareRenderer.depth.end(), 1.0f);
+}
+
+/**
+ * wrapSoftwareMesh: Reference CPU mesh data for drawing; the MeshData must outlive the result
+ */
+GpuMesh wrapSoftwareMesh(const MeshData &mesh, bool packed) {
+    GpuMesh result;
+    result.source = &mesh;
+    result.indexCount = static_cast<GLsizei>(mesh.indices.size());
+    result.packed = packed;
+    result.vertexBytes = mesh.vertices.size() * sizeof(MeshVertex);
+    result.indexBytes = mesh.indices.size() * sizeof(uint32_t);
+    result.boundsMin = mesh.boundsMin;
+    result.boundsExtent = {mesh.boundsMax.x - mesh.boundsMin.x, mesh.boundsMax.y - mesh.boundsMin.y,
+                           mesh.boundsMax.z - mesh.boundsMin.z};
+    return result;
+}
+
+/**
+ * loadSoftwareTexture: Load a texture through the cache and decode its full mip chain to RGBA8
+ */
+Texture loadSoftwareTexture(const std::string &filepath) {
+    auto start = std::chrono::steady_clock::now();
+    CompressedTexture compressed;
+    bool fromCache = false;
+    if (!loadCompressedTexture(filepath, compressed, fromCache)) return Texture();
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return createSoftwareTexture(filepath, compressed, fromCache, loadMs);
+}
+
+/**
+ * createSoftwareTexture: Decode a texture loaded by loadCompressedTexture into the software texture registry
+ * Slots released by destroySoftwareTexture are reused before the registry grows.
+ */
+Texture createSoftwareTexture(const std::string &filepath, const CompressedTexture &compressed, bool fromCache,
+                              double loadMs) {
+    SoftwareRenderer &sw = softwareRenderer;
+    GLuint id;
+    if (!sw.freeTextures.empty()) {
+        id = sw.freeTextures.back();
+        sw.freeTextures.pop_back();
+    } else {
+        sw.textures.emplace_back();
+        id = static_cast<GLuint>(sw.textures.size());
+    }
+    return decodeSoftwareTexture(id, filepath, compressed, fromCache, loadMs);
+}
+
+/**
+ * updateSoftwareTexture: Decode a reloaded texture into the registry slot of an existing one, keeping its id
+ */
+bool updateSoftwareTexture(Texture &texture, const std::string &filepath, const CompressedTexture &compressed,
+                           bool fromCache, double loadMs) {
+    if (!texture.id || texture.id > softwareRenderer.textures.size()) {
+        texture = createSoftwareTexture(filepath, compressed, fromCache, loadMs);
+        return false;
+    }
+    texture = decodeSoftwareTexture(texture.id, filepath, compressed, fromCache, loadMs);
+    return true;
+}
+
+/**
+ * destroySoftwareTexture: Free a texture's decoded levels and return its registry slot for reuse
+ */
+void destroySoftwareTexture(Texture &texture) {
+    SoftwareRenderer &sw = softwareRenderer;
+    if (texture.id && texture.id <= sw.textures.size()) {
+        sw.textures[texture.id - 1] = SoftwareTexture();
+        sw.freeTextures.push_back(texture.id);
+    }
+    texture.id = 0;
+}
+
+/**
+ * executeSoftwareQueue: Transform, clip and bin every sorted packet, then rasterize tiles in parallel
+ * Triangle setup runs on the calling thread in submission order, so each tile's bin keeps draw order.
+ */
+void executeSoftwareQueue(const RenderQueue &queue, const Mat4 &projection, const Mat4 &view) {
+    MemoryScope scope(MEMORY_RENDERER);
+    SoftwareRenderer &sw = softwareRenderer;
+    clearBins();
+    resetFrameVector(sw.triangles, sw.triangles.size() + sw.triangles.size() / 4);
+
+    for (uint32_t index : queue.order) {
+        const DrawPacket &packet = queue.packets[index];
+        if (packet.batch) {
+            drawStaticBatchSoftware(*packet.batch, packet.model, view, projection);
+            continue;
+        }
+
+        const MeshData *mesh = packet.mesh->source;
+        if (!mesh) continue;
+        bool flat = packet.program == &renderer.programs.color;
+        drawIndexed(mesh->vertices.data(), static_cast<uint32_t>(mesh->vertices.size()), mesh->indices.data(),
+                    static_cast<uint32_t>(mesh->indices.size()), packet.primitive, view * packet.model, projection,
+                    packet.color, flat ? SHADE_FLAT : SHADE_LIT, flat ? nullptr : findTexture(packet.texture));
+    }
+
+    parallelFor(static_cast<uint32_t>(sw.bins.size()), rasterizeTile);
+}
@@ -0,0 +1,90 @@
+#ifndef SOFTWARE_RENDERER_HPP
+#define SOFTWARE_RENDERER_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "FrameMemory.hpp"
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "TextureCache.hpp"
+
+const int SW_RENDER_TILE = 64;
+const uint32_t SW_BIN_BLOCK_TRIANGLES = 254;
+const size_t SW_BIN_BLOCKS_PER_CHUNK = 256;
+
+struct SoftwareTextureLevel {
+    int width = 0, height = 0;
+    std::vector<uint32_t> texels;
+};
+
+// Decoded RGBA8 mip chain; Texture::id is the index into SoftwareRenderer::textures plus one
+struct SoftwareTexture {
+    std::vector<SoftwareTextureLevel> levels;
+};
+
+// Post-transform vertex with its lighting already applied, as the GL vertex shaders output it
+struct ClipVertex {
+    float position[4];
+    float uv[2];
+    float color[3];
+};
+
+// Screen-space triangle: barycentric edge planes and attribute planes a * x + b * y + c
+// Attributes are premultiplied by 1/w so dividing by the inverseW plane is perspective correct
+struct SoftwareTriangle {
+    float edges[3][3];
+    float depth[3];
+    float inverseW[3];
+    float uv[2][3];
+    float color[3][3];
+    const SoftwareTextureLevel *texture;
+    int minX, minY, maxX, maxY;
+};
+
+// Part of a tile's triangle list: bins are chains of fixed-size blocks from the bin pool, so binning
+// neither copies on growth nor allocates once the pool has grown to the busiest frame
+struct SoftwareBinBlock {
+    SoftwareBinBlock *next;
+    uint32_t count;
+    uint32_t triangles[SW_BIN_BLOCK_TRIANGLES];
+};
+
+struct SoftwareBin {
+    SoftwareBinBlock *first = nullptr;
+    SoftwareBinBlock *last = nullptr;
+};
+
+// CPU framebuffer (RGBA8 color, window depth in [0, 1], row 0 at the bottom like GL) and
+// the per-frame triangle bins that tiles rasterize in parallel; the triangles live in the frame arena
+struct SoftwareRenderer {
+    int width = 0, height = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<SoftwareTexture> textures;
+    std::vector<GLuint> freeTextures;
+    std::vector<ClipVertex> vertices;
+    std::pmr::vector<SoftwareTriangle> triangles;
+    std::vector<SoftwareBin> bins;
+    FixedPool binPool{sizeof(SoftwareBinBlock), SW_BIN_BLOCKS_PER_CHUNK};
+    bool useAvx2 = false;
+};
+
+extern SoftwareRenderer softwareRenderer;
+
+bool initSoftwareRenderer(int width, int height);
+void shutdownSoftwareRenderer();
+void clearSoftwareFramebuffer(float r, float g, float b);
+GpuMesh wrapSoftwareMesh(const MeshData &mesh, bool packed);
+Texture loadSoftwareTexture(const std::string &filepath);
+Texture createSoftwareTexture(const std::string &filepath, const CompressedTexture &compressed, bool fromCache,
+                              double loadMs);
+bool updateSoftwareTexture(Texture &texture, const std::string &filepath, const CompressedTexture &compressed,
+                           bool fromCache, double loadMs);
+void destroySoftwareTexture(Texture &texture);
+void executeSoftwareQueue(const RenderQueue &queue, const Mat4 &projection, const Mat4 &view);
+
+#endif
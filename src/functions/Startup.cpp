@@ -0,0 +1,78 @@
+#include "Startup.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+StartupTimeline startupTimeline;
+
+namespace {
+
+const int timelineColumns = 40;
+
+}
+
+/**
+ * beginStartupTimeline: Start the startup clock (call first thing in main)
+ */
+void beginStartupTimeline() {
+    startupTimeline.origin = std::chrono::steady_clock::now();
+    startupTimeline.phases.clear();
+    startupTimeline.reported = false;
+}
+
+/**
+ * startupElapsedMs: Milliseconds since beginStartupTimeline
+ */
+double startupElapsedMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupTimeline.origin).count();
+}
+
+/**
+ * recordStartupPhase: Add a phase that began at startMs and ends now
+ */
+void recordStartupPhase(const std::string &name, const std::string &lane, double startMs) {
+    double endMs = startupElapsedMs();
+    std::lock_guard<std::mutex> lock(startupTimeline.mutex);
+    startupTimeline.phases.push_back({name, lane, startMs, endMs});
+}
+
+/**
+ * reportStartupTimeline: Print every phase as a bar on a shared time axis, once, after the first frame
+ * The slowest single phase is the lower bound for time-to-first-frame when everything else overlaps it.
+ */
+void reportStartupTimeline() {
+    StartupTimeline &timeline = startupTimeline;
+    if (timeline.reported) return;
+    timeline.reported = true;
+    timeline.firstFrameMs = startupElapsedMs();
+
+    std::vector<StartupPhase> phases;
+    {
+        std::lock_guard<std::mutex> lock(timeline.mutex);
+        phases = timeline.phases;
+    }
+    std::sort(phases.begin(), phases.end(), [](const StartupPhase &a, const StartupPhase &b) {
+        return a.startMs < b.startMs;
+    });
+
+    double total = std::max(timeline.firstFrameMs, 1e-3);
+    double summed = 0.0, slowest = 0.0;
+    std::cout << "Startup timeline (first frame after " << timeline.firstFrameMs << " ms):" << std::endl;
+    for (const StartupPhase &phase : phases) {
+        double duration = phase.endMs - phase.startMs;
+        summed += duration;
+        slowest = std::max(slowest, duration);
+
+        std::string bar(timelineColumns, '.');
+        int from = std::clamp(static_cast<int>(phase.startMs / total * timelineColumns), 0, timelineColumns - 1);
+        int to = std::clamp(static_cast<int>(phase.endMs / total * timelineColumns), from + 1, timelineColumns);
+        std::fill(bar.begin() + from, bar.begin() + to, '#');
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "  %-8s %-24s %8.1f ms  |%s|", phase.lane.c_str(), phase.name.c_str(),
+                      duration, bar.c_str());
+        std::cout << line << std::endl;
+    }
+    std::cout << "Startup: phases add up to " << summed << " ms, slowest phase " << slowest << " ms, first frame after "
+              << timeline.firstFrameMs << " ms" << std::endl;
+}
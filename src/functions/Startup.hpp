@@ -0,0 +1,32 @@
+#ifndef STARTUP_HPP
+#define STARTUP_HPP
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One timed piece of startup work; lane names the thread it ran on
+struct StartupPhase {
+    std::string name;
+    std::string lane;
+    double startMs, endMs;
+};
+
+// Startup phases in milliseconds since beginStartupTimeline, recorded from any thread
+struct StartupTimeline {
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mutex;
+    std::vector<StartupPhase> phases;
+    double firstFrameMs = 0.0;
+    bool reported = false;
+};
+
+extern StartupTimeline startupTimeline;
+
+void beginStartupTimeline();
+double startupElapsedMs();
+void recordStartupPhase(const std::string &name, const std::string &lane, double startMs);
+void reportStartupTimeline();
+
+#endif
@@ -0,0 +1,668 @@
+#include "StaticWorld.hpp"
+#include "HiZ.hpp"
+#include "MainFunctions.hpp"
+#include "MemoryTracker.hpp"
+#include "Shader.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+StaticWorld staticWorld;
+bool useGpuCulling = true;
+
+namespace {
+
+const float groundY = -2.0f;
+const float gridSize = 100.0f;
+const float gridStep = 5.0f;
+const int cellsPerChunk = 5;
+const float occluderMinSize = 1.0f;
+const GLsizei hiZSize = 256;
+
+const GLuint ATTRIB_INSTANCE_MODEL = 3;
+const GLuint ATTRIB_INSTANCE_COLOR = 7;
+
+const GLuint CULL_OBJECTS_BINDING = 0;
+const GLuint CULL_COMMANDS_BINDING = 1;
+const GLuint CULL_INSTANCES_BINDING = 2;
+const GLuint CULL_COUNTERS_BINDING = 3;
+const GLuint CULL_GROUP_SIZE = 64;
+
+// One invocation per object: frustum and Hi-Z occlusion tests, then append to its mesh's instance range
+const char *cullComputeShader = R"(#version 430 core
+layout(local_size_x = 64) in;
+
+struct CullObject {
+    vec3 boundsMin;
+    uint command;
+    vec3 boundsMax;
+    uint padding;
+    mat4 model;
+    vec4 color;
+};
+
+struct Instance {
+    mat4 model;
+    vec4 color;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { CullObject objects[]; };
+layout(std430, binding = 1) buffer Commands { DrawCommand commands[]; };
+layout(std430, binding = 2) writeonly buffer Instances { Instance instances[]; };
+layout(std430, binding = 3) buffer Counters { uint occluded; };
+
+layout(binding = 1) uniform sampler2D uHiZ;
+
+uniform vec4 uPlanes[6];
+uniform uint uObjectCount;
+uniform mat4 uViewProjection;
+uniform bool uOcclusion;
+
+// Nearest box depth against the farthest occluder depth over its screen rectangle,
+// read from the pyramid level where the rectangle spans at most 2x2 texels
+bool isOccluded(vec3 boundsMin, vec3 boundsMax) {
+    vec2 uvMin = vec2(1.0);
+    vec2 uvMax = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x,
+                           (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+                           (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+        vec4 clip = uViewProjection * vec4(corner, 1.0);
+        if (clip.w <= 0.0) return false;
+        vec3 ndc = clip.xyz / clip.w;
+        uvMin = min(uvMin, ndc.xy * 0.5 + 0.5);
+        uvMax = max(uvMax, ndc.xy * 0.5 + 0.5);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+    uvMin = clamp(uvMin, 0.0, 1.0);
+    uvMax = clamp(uvMax, 0.0, 1.0);
+
+    ivec2 baseSize = textureSize(uHiZ, 0);
+    vec2 extent = (uvMax - uvMin) * vec2(baseSize);
+    int level = int(ceil(log2(max(max(extent.x, extent.y), 1.0))));
+    level = min(level, textureQueryLevels(uHiZ) - 1);
+
+    // Derived from the base size: textureSize() with a non-zero lod is unreliable on some drivers
+    ivec2 levelSize = max(baseSize >> level, ivec2(1));
+    ivec2 lo = min(ivec2(uvMin * vec2(levelSize)), levelSize - 1);
+    ivec2 hi = min(ivec2(uvMax * vec2(levelSize)), levelSize - 1);
+    float farthest = max(max(texelFetch(uHiZ, lo, level).r, texelFetch(uHiZ, ivec2(hi.x, lo.y), level).r),
+                         max(texelFetch(uHiZ, ivec2(lo.x, hi.y), level).r, texelFetch(uHiZ, hi, level).r));
+    return nearest > farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uObjectCount) return;
+
+    CullObject object = objects[index];
+    for (int i = 0; i < 6; i++) {
+        vec3 corner = mix(object.boundsMin, object.boundsMax, greaterThanEqual(uPlanes[i].xyz, vec3(0.0)));
+        if (dot(uPlanes[i].xyz, corner) + uPlanes[i].w < 0.0) return;
+    }
+
+    if (uOcclusion && isOccluded(object.boundsMin, object.boundsMax)) {
+        atomicAdd(occluded, 1u);
+        return;
+    }
+
+    uint slot = atomicAdd(commands[object.command].instanceCount, 1u);
+    instances[commands[object.command].baseInstance + slot] = Instance(object.model, object.color);
+}
+)";
+
+uint32_t addStaticMesh(std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices,
+                       const std::vector<MeshVertex> &meshVertices, const std::vector<uint32_t> &meshIndices) {
+    StaticMesh mesh;
+    mesh.firstIndex = static_cast<GLuint>(indices.size());
+    mesh.indexCount = static_cast<GLuint>(meshIndices.size());
+    mesh.baseVertex = static_cast<GLint>(vertices.size());
+    mesh.vertexCount = static_cast<GLuint>(meshVertices.size());
+
+    for (int k = 0; k < 3; k++) {
+        mesh.boundsMin[k] = meshVertices.empty() ? 0.0f : meshVertices[0].position[k];
+        mesh.boundsMax[k] = mesh.boundsMin[k];
+    }
+    for (const MeshVertex &v : meshVertices) {
+        for (int k = 0; k < 3; k++) {
+            mesh.boundsMin[k] = std::min(mesh.boundsMin[k], v.position[k]);
+            mesh.boundsMax[k] = std::max(mesh.boundsMax[k], v.position[k]);
+        }
+    }
+
+    vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+    indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+    staticWorld.meshes.push_back(mesh);
+    return static_cast<uint32_t>(staticWorld.meshes.size() - 1);
+}
+
+void buildCube(std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices) {
+    const float faces[6][3][3] = {
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+        {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+        {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+        {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+    };
+    const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+    for (const auto &face : faces) {
+        uint32_t base = static_cast<uint32_t>(vertices.size());
+        for (const auto &corner : corners) {
+            MeshVertex v = {};
+            for (int k = 0; k < 3; k++) {
+                v.position[k] = 0.5f * (face[0][k] + corner[0] * face[1][k] + corner[1] * face[2][k]);
+                v.normal[k] = face[0][k];
+            }
+            v.uv[0] = corner[0] * 0.5f + 0.5f;
+            v.uv[1] = corner[1] * 0.5f + 0.5f;
+            vertices.push_back(v);
+        }
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+}
+
+// Line grid covering one terrain chunk, origin at the chunk corner
+void buildTerrainChunk(std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices) {
+    float chunkSize = gridStep * cellsPerChunk;
+    for (int i = 0; i <= cellsPerChunk; i++) {
+        float t = gridStep * static_cast<float>(i);
+        uint32_t base = static_cast<uint32_t>(vertices.size());
+        const float ends[4][3] = {{0, 0, t}, {chunkSize, 0, t}, {t, 0, 0}, {t, 0, chunkSize}};
+        for (const auto &end : ends) {
+            MeshVertex v = {{end[0], end[1], end[2]}, {0, 1, 0}, {0, 0}};
+            vertices.push_back(v);
+        }
+        indices.insert(indices.end(), {base, base + 1, base + 2, base + 3});
+    }
+}
+
+void addObject(StaticBatch &batch, uint32_t mesh, const Mat4 &model, float r, float g, float b, float textured) {
+    StaticObject object;
+    object.mesh = mesh;
+    object.instance.model = model;
+    object.instance.color[0] = r;
+    object.instance.color[1] = g;
+    object.instance.color[2] = b;
+    object.instance.color[3] = textured;
+    const StaticMesh &info = staticWorld.meshes[mesh];
+    transformAabb(model, info.boundsMin, info.boundsMax, object.boundsMin, object.boundsMax);
+    batch.objects.push_back(object);
+}
+
+void bindInstanceAttributes(GLuint instanceVbo, size_t firstInstance) {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    size_t base = firstInstance * sizeof(StaticInstance);
+    for (GLuint column = 0; column < 4; column++) {
+        glVertexAttribPointer(ATTRIB_INSTANCE_MODEL + column, 4, GL_FLOAT, GL_FALSE, sizeof(StaticInstance),
+                              reinterpret_cast<void *>(base + offsetof(StaticInstance, model) + column * 4 * sizeof(float)));
+    }
+    glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(StaticInstance),
+                          reinterpret_cast<void *>(base + offsetof(StaticInstance, color)));
+}
+
+void createBatchBuffers(StaticBatch &batch) {
+    glGenVertexArrays(1, &batch.vao);
+    glGenBuffers(1, &batch.instanceVbo);
+    glGenBuffers(1, &batch.indirectBuffer);
+
+    glBindVertexArray(batch.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, staticWorld.vbo);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                          reinterpret_cast<void *>(offsetof(MeshVertex, position)));
+    glEnableVertexAttribArray(ATTRIB_NORMAL);
+    glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                          reinterpret_cast<void *>(offsetof(MeshVertex, normal)));
+    glEnableVertexAttribArray(ATTRIB_TEXCOORD);
+    glVertexAttribPointer(ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                          reinterpret_cast<void *>(offsetof(MeshVertex, uv)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, staticWorld.ibo);
+
+    for (GLuint attribute = ATTRIB_INSTANCE_MODEL; attribute <= ATTRIB_INSTANCE_COLOR; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    bindInstanceAttributes(batch.instanceVbo, 0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void destroyBatchBuffers(StaticBatch &batch) {
+    if (batch.vao) glDeleteVertexArrays(1, &batch.vao);
+    for (GLuint *buffer : {&batch.instanceVbo, &batch.indirectBuffer, &batch.objectBuffer, &batch.commandTemplate,
+                           &batch.cullCounters}) {
+        if (!*buffer) continue;
+        releaseGpuMemory(GPU_BUFFER, *buffer);
+        glDeleteBuffers(1, buffer);
+    }
+}
+
+// Grow-only upload so steady-state frames only orphan and refill existing storage
+void uploadBuffer(GLenum target, GLuint buffer, size_t &capacity, const void *data, size_t bytes) {
+    glBindBuffer(target, buffer);
+    if (bytes > capacity) {
+        capacity = bytes * 2;
+        trackGpuMemory(GPU_BUFFER, buffer, MEMORY_WORLD, capacity);
+    }
+    glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, bytes, data);
+    glBindBuffer(target, 0);
+}
+
+// Group the visible objects into one command per mesh and upload commands plus instances
+void compactVisible(StaticBatch &batch) {
+    batch.meshCounts.assign(staticWorld.meshes.size(), 0);
+    for (uint32_t index : batch.visible) batch.meshCounts[batch.objects[index].mesh]++;
+
+    // meshCounts becomes each mesh's write cursor into the instance array
+    batch.commands.clear();
+    uint32_t firstInstance = 0;
+    for (uint32_t mesh = 0; mesh < batch.meshCounts.size(); mesh++) {
+        uint32_t count = batch.meshCounts[mesh];
+        if (count == 0) continue;
+        const StaticMesh &info = staticWorld.meshes[mesh];
+        batch.commands.push_back({info.indexCount, count, info.firstIndex, info.baseVertex, firstInstance});
+        batch.meshCounts[mesh] = firstInstance;
+        firstInstance += count;
+    }
+
+    batch.instances.resize(batch.visible.size());
+    for (uint32_t index : batch.visible) {
+        const StaticObject &object = batch.objects[index];
+        batch.instances[batch.meshCounts[object.mesh]++] = object.instance;
+    }
+
+    if (!batch.vao) return;
+    uploadBuffer(GL_ARRAY_BUFFER, batch.instanceVbo, batch.instanceCapacity,
+                 batch.instances.data(), batch.instances.size() * sizeof(StaticInstance));
+    uploadBuffer(GL_DRAW_INDIRECT_BUFFER, batch.indirectBuffer, batch.commandCapacity,
+                 batch.commands.data(), batch.commands.size() * sizeof(DrawElementsIndirectCommand));
+}
+
+// Static inputs for GPU culling: one command per mesh with a fixed instance range, zero instances
+void createGpuCullBuffers(StaticBatch &batch) {
+    std::vector<uint32_t> meshCommand(staticWorld.meshes.size(), 0);
+    std::vector<uint32_t> meshCounts(staticWorld.meshes.size(), 0);
+    for (const StaticObject &object : batch.objects) meshCounts[object.mesh]++;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    uint32_t firstInstance = 0;
+    for (uint32_t mesh = 0; mesh < meshCounts.size(); mesh++) {
+        if (meshCounts[mesh] == 0) continue;
+        const StaticMesh &info = staticWorld.meshes[mesh];
+        meshCommand[mesh] = static_cast<uint32_t>(commands.size());
+        commands.push_back({info.indexCount, 0, info.firstIndex, info.baseVertex, firstInstance});
+        firstInstance += meshCounts[mesh];
+    }
+
+    std::vector<GpuCullObject> objects;
+    objects.reserve(batch.objects.size());
+    for (const StaticObject &object : batch.objects) {
+        GpuCullObject record = {};
+        for (int k = 0; k < 3; k++) {
+            record.boundsMin[k] = object.boundsMin[k];
+            record.boundsMax[k] = object.boundsMax[k];
+        }
+        record.command = meshCommand[object.mesh];
+        record.instance = object.instance;
+        objects.push_back(record);
+    }
+
+    size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+    size_t instanceBytes = objects.size() * sizeof(StaticInstance);
+
+    glGenBuffers(1, &batch.objectBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.objectBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * sizeof(GpuCullObject), objects.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, batch.objectBuffer, MEMORY_WORLD, objects.size() * sizeof(GpuCullObject));
+
+    glGenBuffers(1, &batch.commandTemplate);
+    glBindBuffer(GL_COPY_READ_BUFFER, batch.commandTemplate);
+    glBufferData(GL_COPY_READ_BUFFER, commandBytes, commands.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, batch.commandTemplate, MEMORY_WORLD, commandBytes);
+
+    // Full-size storage up front; the CPU path's grow-only uploads then never need to reallocate
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commandBytes, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    batch.commandCapacity = commandBytes;
+    trackGpuMemory(GPU_BUFFER, batch.indirectBuffer, MEMORY_WORLD, commandBytes);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instanceBytes, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    batch.instanceCapacity = instanceBytes;
+    trackGpuMemory(GPU_BUFFER, batch.instanceVbo, MEMORY_WORLD, instanceBytes);
+
+    glGenBuffers(1, &batch.cullCounters);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.cullCounters);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    trackGpuMemory(GPU_BUFFER, batch.cullCounters, MEMORY_WORLD, sizeof(GLuint));
+
+    batch.gpuCommandCount = static_cast<GLsizei>(commands.size());
+}
+
+// Depth-only draw of the large obstacles and parked aircraft, reduced into the Hi-Z pyramid
+void renderOccluders(const Mat4 &viewProjection) {
+    beginOccluderPass(viewProjection);
+    glBindVertexArray(staticWorld.occluders.vao);
+    drawStaticBatch(staticWorld.occluders);
+    glBindVertexArray(0);
+    endOccluderPass();
+}
+
+// Only solid boxes go to the software rasterizer: a box around an aircraft would hide what it doesn't
+void renderSoftwareOccluders(const Mat4 &viewProjection) {
+    auto start = std::chrono::steady_clock::now();
+    rasterizeOccluders(viewProjection, staticWorld.occluderBoxes);
+    frameStats.occlusionMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reset the commands from the template and let the compute shader fill instances and counts
+void dispatchGpuCull(StaticBatch &batch, const Frustum &frustum, const Mat4 &viewProjection) {
+    bool occlusion = useOcclusionCulling && hiZ.built;
+
+    GLsizeiptr commandBytes = batch.gpuCommandCount * sizeof(DrawElementsIndirectCommand);
+    glBindBuffer(GL_COPY_READ_BUFFER, batch.commandTemplate);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch.indirectBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, commandBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    GLuint objectCount = static_cast<GLuint>(batch.objects.size());
+    glUseProgram(staticWorld.cullProgram);
+    glUniform4fv(staticWorld.cullPlanes, 6, &frustum.planes[0][0]);
+    glUniform1ui(staticWorld.cullObjectCount, objectCount);
+    glUniformMatrix4fv(staticWorld.cullViewProjection, 1, GL_FALSE, viewProjection.m);
+    glUniform1i(staticWorld.cullOcclusion, occlusion ? 1 : 0);
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.cullCounters);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0 + HIZ_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, occlusion ? hiZ.pyramidTexture : 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OBJECTS_BINDING, batch.objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_COMMANDS_BINDING, batch.indirectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_INSTANCES_BINDING, batch.instanceVbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_COUNTERS_BINDING, batch.cullCounters);
+    glDispatchCompute((objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    glUseProgram(0);
+
+    // Visible counts live only on the GPU; read them back just while stats are being printed
+    if (printStats) {
+        frameStats.staticObjects += objectCount;
+        batch.commands.resize(batch.gpuCommandCount);
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.indirectBuffer);
+        glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandBytes, batch.commands.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        for (const DrawElementsIndirectCommand &command : batch.commands) {
+            frameStats.staticVisible += command.instanceCount;
+        }
+        GLuint occluded = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.cullCounters);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &occluded);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        frameStats.staticOccluded += occluded;
+    }
+}
+
+}
+
+/**
+ * buildStaticWorld: Pack terrain chunks, reference cubes and parked aircraft into shared buffers
+ * Without gpuBuffers only the CPU copies are built, for the software renderer.
+ */
+void buildStaticWorld(const MeshData &aircraft, const Texture &aircraftTexture, bool gpuBuffers) {
+    MemoryScope scope(MEMORY_WORLD);
+    destroyStaticWorld();
+
+    std::vector<MeshVertex> &vertices = staticWorld.vertices;
+    std::vector<uint32_t> &indices = staticWorld.indices;
+    std::vector<MeshVertex> meshVertices;
+    std::vector<uint32_t> meshIndices;
+
+    buildCube(meshVertices, meshIndices);
+    staticWorld.cubeMesh = addStaticMesh(vertices, indices, meshVertices, meshIndices);
+
+    meshVertices.clear();
+    meshIndices.clear();
+    buildTerrainChunk(meshVertices, meshIndices);
+    staticWorld.terrainMesh = addStaticMesh(vertices, indices, meshVertices, meshIndices);
+
+    staticWorld.aircraftMesh = addStaticMesh(vertices, indices, aircraft.vertices, aircraft.indices);
+
+    if (gpuBuffers) {
+        glGenBuffers(1, &staticWorld.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, staticWorld.vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
+        glGenBuffers(1, &staticWorld.ibo);
+        glBindBuffer(GL_ARRAY_BUFFER, staticWorld.ibo);
+        glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        trackGpuMemory(GPU_BUFFER, staticWorld.vbo, MEMORY_WORLD, vertices.size() * sizeof(MeshVertex));
+        trackGpuMemory(GPU_BUFFER, staticWorld.ibo, MEMORY_WORLD, indices.size() * sizeof(uint32_t));
+
+        for (StaticBatch &batch : staticWorld.batches) createBatchBuffers(batch);
+    }
+    staticWorld.batches[STATIC_TERRAIN].primitive = GL_LINES;
+    staticWorld.batches[STATIC_FLEET].texture = aircraftTexture.id;
+
+    float chunkSize = gridStep * cellsPerChunk;
+    for (float z = -gridSize; z < gridSize; z += chunkSize) {
+        for (float x = -gridSize; x < gridSize; x += chunkSize) {
+            addObject(staticWorld.batches[STATIC_TERRAIN], staticWorld.terrainMesh, mat4Translate(x, groundY, z), 0.3f, 0.4f, 0.3f, 0.0f);
+        }
+    }
+
+    forEach<const Cube>(world, [&](const Cube &cube) {
+        Mat4 model = mat4Translate(cube.x, cube.y, cube.z) * mat4Scale(cube.size, cube.size, cube.size);
+        addObject(staticWorld.batches[STATIC_OBSTACLES], staticWorld.cubeMesh, model, cube.r, cube.g, cube.b, 0.0f);
+        if (cube.size >= occluderMinSize) {
+            addObject(staticWorld.occluders, staticWorld.cubeMesh, model, cube.r, cube.g, cube.b, 0.0f);
+            const StaticObject &object = staticWorld.occluders.objects.back();
+            OccluderBox box;
+            std::copy(object.boundsMin, object.boundsMin + 3, box.boundsMin);
+            std::copy(object.boundsMax, object.boundsMax + 3, box.boundsMax);
+            staticWorld.occluderBoxes.push_back(box);
+        }
+    });
+
+    // A row of parked aircraft resting on the ground, same base orientation as the player's plane
+    Mat4 orientation = mat4Rotate(-85.0f, 1.0f, 0.0f, 1.0f);
+    const StaticMesh &aircraftInfo = staticWorld.meshes[staticWorld.aircraftMesh];
+    float orientedMin[3], orientedMax[3];
+    transformAabb(orientation, aircraftInfo.boundsMin, aircraftInfo.boundsMax, orientedMin, orientedMax);
+    for (int i = -2; i <= 2; i++) {
+        Mat4 model = mat4Translate(i * 4.0f, groundY - orientedMin[1], -12.0f) * orientation;
+        addObject(staticWorld.batches[STATIC_FLEET], staticWorld.aircraftMesh, model, 1.0f, 1.0f, 1.0f, 1.0f);
+        addObject(staticWorld.occluders, staticWorld.aircraftMesh, model, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    // Culling output is bounded by the layer, so reserving it now keeps per-frame culling off the heap
+    for (StaticBatch &batch : staticWorld.batches) {
+        batch.visible.reserve(batch.objects.size());
+        batch.instances.reserve(batch.objects.size());
+        batch.meshCounts.reserve(staticWorld.meshes.size());
+        batch.commands.reserve(staticWorld.meshes.size());
+    }
+
+    if (gpuBuffers && GLAD_GL_VERSION_4_3) {
+        staticWorld.cullProgram = createComputeProgram(cullComputeShader);
+        staticWorld.cullPlanes = glGetUniformLocation(staticWorld.cullProgram, "uPlanes");
+        staticWorld.cullObjectCount = glGetUniformLocation(staticWorld.cullProgram, "uObjectCount");
+        staticWorld.cullViewProjection = glGetUniformLocation(staticWorld.cullProgram, "uViewProjection");
+        staticWorld.cullOcclusion = glGetUniformLocation(staticWorld.cullProgram, "uOcclusion");
+    }
+    if (staticWorld.cullProgram) {
+        for (StaticBatch &batch : staticWorld.batches) createGpuCullBuffers(batch);
+    }
+
+    // Occluders never change, so their commands and instances are compacted once
+    if (staticWorld.cullProgram && createHiZ(hiZSize)) {
+        StaticBatch &occluders = staticWorld.occluders;
+        createBatchBuffers(occluders);
+        for (uint32_t i = 0; i < occluders.objects.size(); i++) occluders.visible.push_back(i);
+        compactVisible(occluders);
+    }
+
+    std::cout << "Static world: " << staticWorld.batches[STATIC_TERRAIN].objects.size() << " terrain chunks, "
+              << staticWorld.batches[STATIC_OBSTACLES].objects.size() << " obstacles, "
+              << staticWorld.batches[STATIC_FLEET].objects.size() << " parked aircraft in "
+              << (vertices.size() * sizeof(MeshVertex) + indices.size() * sizeof(uint32_t)) / 1024
+              << " KB of shared buffers, culled on the " << (gpuCullingAvailable() ? "GPU" : "CPU") << std::endl;
+    if (hiZ.framebuffer) {
+        std::cout << "Occlusion: " << staticWorld.occluders.objects.size() << " occluders into a "
+                  << hiZ.size << "x" << hiZ.size << " Hi-Z pyramid (" << hiZ.levels << " levels), "
+                  << staticWorld.occluderBoxes.size() << " box occluders for the CPU path" << std::endl;
+    } else {
+        std::cout << "Occlusion: " << staticWorld.occluderBoxes.size() << " box occluders for the CPU path" << std::endl;
+    }
+}
+
+/**
+ * updateStaticAircraft: Swap a reloaded aircraft mesh and texture into the parked fleet
+ * With the same vertex and index counts and the same bounds the aircraft keep their placement and culling
+ * data, so only their range of the shared buffers is rewritten; any other change rebuilds the static world.
+ */
+void updateStaticAircraft(const MeshData &aircraft, const Texture &aircraftTexture, bool gpuBuffers) {
+    const StaticMesh &mesh = staticWorld.meshes[staticWorld.aircraftMesh];
+    bool sameShape = mesh.vertexCount == aircraft.vertices.size() && mesh.indexCount == aircraft.indices.size();
+    float boundsMin[3], boundsMax[3];
+    for (int k = 0; k < 3 && sameShape; k++) {
+        boundsMin[k] = aircraft.vertices.empty() ? 0.0f : aircraft.vertices[0].position[k];
+        boundsMax[k] = boundsMin[k];
+        for (const MeshVertex &v : aircraft.vertices) {
+            boundsMin[k] = std::min(boundsMin[k], v.position[k]);
+            boundsMax[k] = std::max(boundsMax[k], v.position[k]);
+        }
+        sameShape = boundsMin[k] == mesh.boundsMin[k] && boundsMax[k] == mesh.boundsMax[k];
+    }
+    if (!sameShape) {
+        buildStaticWorld(aircraft, aircraftTexture, gpuBuffers);
+        return;
+    }
+
+    std::copy(aircraft.vertices.begin(), aircraft.vertices.end(), staticWorld.vertices.begin() + mesh.baseVertex);
+    std::copy(aircraft.indices.begin(), aircraft.indices.end(), staticWorld.indices.begin() + mesh.firstIndex);
+    if (staticWorld.vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, staticWorld.vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, mesh.baseVertex * sizeof(MeshVertex), aircraft.vertices.size() * sizeof(MeshVertex),
+                        aircraft.vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, staticWorld.ibo);
+        glBufferSubData(GL_ARRAY_BUFFER, mesh.firstIndex * sizeof(uint32_t), aircraft.indices.size() * sizeof(uint32_t),
+                        aircraft.indices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    staticWorld.batches[STATIC_FLEET].texture = aircraftTexture.id;
+}
+
+/**
+ * destroyStaticWorld: Release shared buffers and per-layer batches
+ */
+void destroyStaticWorld() {
+    destroyHiZ();
+    for (StaticBatch &batch : staticWorld.batches) destroyBatchBuffers(batch);
+    destroyBatchBuffers(staticWorld.occluders);
+    if (staticWorld.cullProgram) glDeleteProgram(staticWorld.cullProgram);
+    for (GLuint *buffer : {&staticWorld.vbo, &staticWorld.ibo}) {
+        if (!*buffer) continue;
+        releaseGpuMemory(GPU_BUFFER, *buffer);
+        glDeleteBuffers(1, buffer);
+    }
+    staticWorld = StaticWorld();
+}
+
+/**
+ * gpuCullingAvailable: True when the context supports compute shaders (GL 4.3) and the cull program linked
+ */
+bool gpuCullingAvailable() {
+    return staticWorld.cullProgram != 0;
+}
+
+/**
+ * prepareStaticBatch: Cull a layer and build its indirect commands and compacted instances
+ * With GPU culling the work is dispatched without readback, after the first layer of the frame
+ * has rendered the occluders into the Hi-Z pyramid. Otherwise frustum culling and the software
+ * occlusion test run on the CPU, and nullptr is returned when nothing in the layer is visible.
+ */
+const StaticBatch *prepareStaticBatch(StaticLayer layer, const Mat4 &viewProjection) {
+    StaticBatch &batch = staticWorld.batches[layer];
+    Frustum frustum = frustumFromMatrix(viewProjection);
+    batch.gpuCulled = useGpuCulling && gpuCullingAvailable() && !batch.objects.empty();
+    if (batch.gpuCulled) {
+        if (useOcclusionCulling && hiZ.framebuffer && !hiZ.built) renderOccluders(viewProjection);
+        dispatchGpuCull(batch, frustum, viewProjection);
+        return &batch;
+    }
+
+    bool occlusion = useOcclusionCulling && !staticWorld.occluderBoxes.empty();
+    if (occlusion && !softwareOcclusion.built) renderSoftwareOccluders(viewProjection);
+
+    batch.visible.clear();
+    for (uint32_t i = 0; i < batch.objects.size(); i++) {
+        const StaticObject &object = batch.objects[i];
+        if (!frustumIntersectsAabb(frustum, object.boundsMin, object.boundsMax)) continue;
+        if (occlusion && softwareOcclusionTest(viewProjection, object.boundsMin, object.boundsMax)) {
+            frameStats.staticOccluded++;
+            continue;
+        }
+        batch.visible.push_back(i);
+    }
+
+    frameStats.staticObjects += static_cast<uint32_t>(batch.objects.size());
+    frameStats.staticVisible += static_cast<uint32_t>(batch.visible.size());
+    if (batch.visible.empty()) return nullptr;
+
+    compactVisible(batch);
+    return &batch;
+}
+
+/**
+ * drawStaticBatch: Issue a prepared layer with one glMultiDrawElementsIndirect (VAO already bound)
+ * GL 4.2 falls back to base-instance draws, GL 3.3 re-points the instance attributes per command.
+ */
+void drawStaticBatch(const StaticBatch &batch) {
+    GLsizei commandCount = batch.gpuCulled ? batch.gpuCommandCount : static_cast<GLsizei>(batch.commands.size());
+
+    if (GLAD_GL_VERSION_4_3) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.indirectBuffer);
+        glMultiDrawElementsIndirect(batch.primitive, GL_UNSIGNED_INT, nullptr, commandCount, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        frameStats.drawCalls++;
+        return;
+    }
+
+    for (const DrawElementsIndirectCommand &command : batch.commands) {
+        const void *offset = reinterpret_cast<const void *>(command.firstIndex * sizeof(uint32_t));
+        if (GLAD_GL_VERSION_4_2) {
+            glDrawElementsInstancedBaseVertexBaseInstance(batch.primitive, command.count, GL_UNSIGNED_INT, offset,
+                                                          command.instanceCount, command.baseVertex, command.baseInstance);
+        } else {
+            bindInstanceAttributes(batch.instanceVbo, command.baseInstance);
+            glDrawElementsInstancedBaseVertex(batch.primitive, command.count, GL_UNSIGNED_INT, offset,
+                                              command.instanceCount, command.baseVertex);
+        }
+        frameStats.drawCalls++;
+    }
+    if (!GLAD_GL_VERSION_4_2) bindInstanceAttributes(batch.instanceVbo, 0);
+}
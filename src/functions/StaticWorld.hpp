@@ -0,0 +1,107 @@
+#ifndef STATIC_WORLD_HPP
+#define STATIC_WORLD_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "SoftwareOcclusion.hpp"
+#include "TextureCache.hpp"
+
+enum StaticLayer : uint32_t {
+    STATIC_TERRAIN = 0,
+    STATIC_OBSTACLES = 1,
+    STATIC_FLEET = 2,
+    STATIC_LAYER_COUNT = 3
+};
+
+// Matches the GL DrawElementsIndirectCommand layout
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Sub-range of the shared vertex/index buffers
+struct StaticMesh {
+    GLuint firstIndex;
+    GLuint indexCount;
+    GLint baseVertex;
+    GLuint vertexCount;
+    float boundsMin[3], boundsMax[3];
+};
+
+// Per-instance vertex attributes (locations 3-7); color.a = 1 samples the layer texture
+struct StaticInstance {
+    Mat4 model;
+    float color[4];
+};
+
+// std430 record read by the culling compute shader; command indexes the layer's indirect commands
+struct GpuCullObject {
+    float boundsMin[3];
+    uint32_t command;
+    float boundsMax[3];
+    uint32_t padding;
+    StaticInstance instance;
+};
+
+struct StaticObject {
+    uint32_t mesh;
+    StaticInstance instance;
+    float boundsMin[3], boundsMax[3];
+};
+
+// One layer drawn with a single multi-draw: its objects plus per-frame command/instance buffers
+// On the GPU path objectBuffer and commandTemplate are static; the cull shader fills the rest
+struct StaticBatch {
+    GLenum primitive = GL_TRIANGLES;
+    GLuint texture = 0;
+    GLuint vao = 0;
+    GLuint instanceVbo = 0;
+    GLuint indirectBuffer = 0;
+    size_t instanceCapacity = 0;
+    size_t commandCapacity = 0;
+    GLuint objectBuffer = 0;
+    GLuint commandTemplate = 0;
+    GLuint cullCounters = 0;
+    GLsizei gpuCommandCount = 0;
+    bool gpuCulled = false;
+    std::vector<StaticObject> objects;
+    std::vector<uint32_t> visible;
+    std::vector<uint32_t> meshCounts;
+    std::vector<StaticInstance> instances;
+    std::vector<DrawElementsIndirectCommand> commands;
+};
+
+// vertices and indices keep a CPU copy of the shared buffers for the software renderer
+struct StaticWorld {
+    GLuint vbo = 0, ibo = 0;
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<StaticMesh> meshes;
+    StaticBatch batches[STATIC_LAYER_COUNT];
+    StaticBatch occluders;
+    std::vector<OccluderBox> occluderBoxes;
+    uint32_t cubeMesh = 0, terrainMesh = 0, aircraftMesh = 0;
+    GLuint cullProgram = 0;
+    GLint cullPlanes = -1;
+    GLint cullObjectCount = -1;
+    GLint cullViewProjection = -1;
+    GLint cullOcclusion = -1;
+};
+
+extern StaticWorld staticWorld;
+extern bool useGpuCulling;
+
+void buildStaticWorld(const MeshData &aircraft, const Texture &aircraftTexture, bool gpuBuffers = true);
+void updateStaticAircraft(const MeshData &aircraft, const Texture &aircraftTexture, bool gpuBuffers = true);
+void destroyStaticWorld();
+bool gpuCullingAvailable();
+const StaticBatch *prepareStaticBatch(StaticLayer layer, const Mat4 &viewProjection);
+void drawStaticBatch(const StaticBatch &batch);
+
+#endif
@@ -0,0 +1,126 @@
+#include "Stats.hpp"
+#include "Log.hpp"
+#include "MemoryTracker.hpp"
+#include <algorithm>
+#include <cmath>
+
+FrameStats frameStats;
+bool printStats = false;
+
+namespace {
+
+StatsAccumulator interval;
+StatsAccumulator session;
+double lastReport = 0.0;
+
+void accumulate(StatsAccumulator &acc, double frameMs) {
+    acc.frames++;
+    acc.frameMs += frameMs;
+    acc.maxFrameMs = std::max(acc.maxFrameMs, frameMs);
+    acc.totals.packets += frameStats.packets;
+    acc.totals.drawCalls += frameStats.drawCalls;
+    acc.totals.stateChanges += frameStats.stateChanges;
+    acc.totals.programChanges += frameStats.programChanges;
+    acc.totals.vaoChanges += frameStats.vaoChanges;
+    acc.totals.textureChanges += frameStats.textureChanges;
+    if (frameStats.staticObjects > 0) acc.cullFrames++;
+    acc.totals.staticObjects += frameStats.staticObjects;
+    acc.totals.staticVisible += frameStats.staticVisible;
+    acc.totals.staticOccluded += frameStats.staticOccluded;
+    acc.totals.occlusionMs += frameStats.occlusionMs;
+    acc.totals.heapAllocations += frameStats.heapAllocations;
+    acc.totals.arenaBytes += frameStats.arenaBytes;
+}
+
+void accumulatePresent(StatsAccumulator &acc, double intervalMs, double latencyMs, bool hasInterval) {
+    if (hasInterval) {
+        acc.presents++;
+        acc.presentMs += intervalMs;
+        acc.presentSquaredMs += intervalMs * intervalMs;
+    }
+    acc.latencyFrames++;
+    acc.latencyMs += latencyMs;
+    acc.maxLatencyMs = std::max(acc.maxLatencyMs, latencyMs);
+}
+
+double presentVariance(const StatsAccumulator &acc) {
+    double presents = static_cast<double>(acc.presents);
+    double mean = acc.presentMs / presents;
+    return std::max(acc.presentSquaredMs / presents - mean * mean, 0.0);
+}
+
+// The per-second and session reports both go through the logger, so the frame loop never waits on stdout
+void logAverages(const char *label, const StatsAccumulator &acc) {
+    if (acc.frames == 0) return;
+    double frames = static_cast<double>(acc.frames);
+    LOG_INFO("{}: {} fps, {} ms avg, {} ms max", label, frames * 1000.0 / acc.frameMs, acc.frameMs / frames,
+             acc.maxFrameMs);
+    LOG_INFO("{}: {} draws from {} packets", label, acc.totals.drawCalls / frames, acc.totals.packets / frames);
+    LOG_INFO("{}: {} state changes ({} program, {} vao, {} texture)", label, acc.totals.stateChanges / frames,
+             acc.totals.programChanges / frames, acc.totals.vaoChanges / frames, acc.totals.textureChanges / frames);
+    if (acc.cullFrames > 0) {
+        double cullFrames = static_cast<double>(acc.cullFrames);
+        double objects = static_cast<double>(acc.totals.staticObjects);
+        double rejected = objects - acc.totals.staticVisible;
+        LOG_INFO("{}: {} of {} static objects visible per frame, {}% rejected ({}% occluded)", label,
+                 acc.totals.staticVisible / cullFrames, objects / cullFrames, 100.0 * rejected / objects,
+                 100.0 * acc.totals.staticOccluded / objects);
+    }
+    if (acc.totals.occlusionMs > 0.0) LOG_INFO("{}: software occlusion {} ms", label, acc.totals.occlusionMs / frames);
+    LOG_INFO("{}: {} heap allocations, {} KB frame arena", label, acc.totals.heapAllocations / frames,
+             acc.totals.arenaBytes / frames / 1024.0);
+    if (acc.presents > 0 && acc.latencyFrames > 0) {
+        double variance = presentVariance(acc);
+        LOG_INFO("{}: frame time variance {} ms^2 ({} ms std dev), estimated input latency {} ms avg, {} ms max",
+                 label, variance, std::sqrt(variance), acc.latencyMs / acc.latencyFrames, acc.maxLatencyMs);
+    }
+}
+
+}
+
+/**
+ * resetFrameStats: Clear the per-frame counters at the start of a frame
+ */
+void resetFrameStats() {
+    frameStats = FrameStats();
+}
+
+/**
+ * recordFrameStats: Fold the finished frame into the interval and session totals
+ */
+void recordFrameStats(double frameMs) {
+    accumulate(interval, frameMs);
+    accumulate(session, frameMs);
+}
+
+/**
+ * recordPresentStats: Fold a present into the totals: the interval since the previous one (unless this is
+ * the first) and the estimated input-to-present latency
+ */
+void recordPresentStats(double intervalMs, double latencyMs, bool hasInterval) {
+    accumulatePresent(interval, intervalMs, latencyMs, hasInterval);
+    accumulatePresent(session, intervalMs, latencyMs, hasInterval);
+}
+
+/**
+ * reportStats: Print interval averages once per second while enabled (F3)
+ */
+void reportStats(double now) {
+    if (now - lastReport < 1.0) return;
+    if (printStats) {
+        logAverages("Stats", interval);
+        logMemoryUsage();
+    }
+    interval = StatsAccumulator();
+    lastReport = now;
+}
+
+/**
+ * reportSessionStats: Print averages over the whole run, flushing the log around them so they land after the
+ * last interval report and before the reports main prints next
+ */
+void reportSessionStats() {
+    flushLog();
+    logAverages("Session", session);
+    flushLog();
+}
@@ -0,0 +1,47 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <cstdint>
+
+struct FrameStats {
+    uint32_t packets = 0;
+    uint32_t drawCalls = 0;
+    uint32_t stateChanges = 0;
+    uint32_t programChanges = 0;
+    uint32_t vaoChanges = 0;
+    uint32_t textureChanges = 0;
+    uint32_t staticObjects = 0;
+    uint32_t staticVisible = 0;
+    uint32_t staticOccluded = 0;
+    double occlusionMs = 0.0;
+    uint32_t heapAllocations = 0;
+    uint64_t arenaBytes = 0;
+};
+
+// Static culling totals only cover frames that reported them (cullFrames): GPU culling
+// results are read back only while stats are printed.
+// Present intervals (presents of them) are kept as a sum and a sum of squares for their variance
+struct StatsAccumulator {
+    uint64_t frames = 0;
+    double frameMs = 0.0;
+    double maxFrameMs = 0.0;
+    uint64_t cullFrames = 0;
+    FrameStats totals;
+    uint64_t presents = 0;
+    double presentMs = 0.0;
+    double presentSquaredMs = 0.0;
+    uint64_t latencyFrames = 0;
+    double latencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+};
+
+extern FrameStats frameStats;
+extern bool printStats;
+
+void resetFrameStats();
+void recordFrameStats(double frameMs);
+void recordPresentStats(double intervalMs, double latencyMs, bool hasInterval);
+void reportStats(double now);
+void reportSessionStats();
+
+#endif
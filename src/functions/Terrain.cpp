@@ -0,0 +1,518 @@
+#include "Terrain.hpp"
+#include "MainFunctions.hpp"
+#include "MemoryTracker.hpp"
+#include "Renderer.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+const std::string terrainCacheDir = "cache/terrain/";
+
+Terrain terrain;
+
+namespace {
+
+const char pyramidMagic[8] = {'F', 'S', 'D', 'E', 'M', 'P', 'Y', '\0'};
+const uint32_t pyramidVersion = 1;
+const int16_t demVoid = -32768;
+const double metresPerDegree = 111320.0;
+// Same height as the flat grid, so the origin of the terrain lies where the ground used to be
+const float groundY = -2.0f;
+const uint32_t tileVertices = TERRAIN_TILE_CELLS + 1;
+const uint64_t tileIndexMask = (1ull << 30) - 1;
+
+struct PyramidHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t samples;
+    uint32_t levels;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+};
+
+uint64_t tileKey(uint32_t level, uint64_t x, uint64_t y) {
+    return static_cast<uint64_t>(level) << 60 | x << 30 | y;
+}
+
+uint64_t fileKey(uint64_t row, uint64_t column) {
+    return row << 32 | column;
+}
+
+// Samples per side of pyramid level L in one file
+uint32_t levelSize(uint32_t level) {
+    return ((terrain.samples - 1) >> level) + 1;
+}
+
+// "N47E008" is the degree north-east of 47N 8E
+bool parseDemName(const std::string &name, int &latitude, int &longitude) {
+    if (name.size() != 7 || (name[0] != 'N' && name[0] != 'S') || (name[3] != 'E' && name[3] != 'W')) return false;
+    for (int i : {1, 2, 4, 5, 6}) {
+        if (name[i] < '0' || name[i] > '9') return false;
+    }
+    latitude = std::stoi(name.substr(1, 2)) * (name[0] == 'N' ? 1 : -1);
+    longitude = std::stoi(name.substr(4, 3)) * (name[3] == 'E' ? 1 : -1);
+    return latitude >= -90 && latitude < 90 && longitude >= -180 && longitude < 180;
+}
+
+int16_t sourceHeight(const DemFile &file, uint32_t row, uint32_t column) {
+    const uint8_t *bytes = file.source.data + (static_cast<size_t>(row) * terrain.samples + column) * 2;
+    int16_t height = static_cast<int16_t>(bytes[0] << 8 | bytes[1]);
+    return height == demVoid ? 0 : height;
+}
+
+// [1 2 1] filter in both directions around every other sample, renormalized where it runs off the file
+template <typename Fetch>
+void downsample(Fetch fetch, uint32_t sourceSize, int16_t *out) {
+    uint32_t size = (sourceSize - 1) / 2 + 1;
+    for (uint32_t row = 0; row < size; row++) {
+        for (uint32_t column = 0; column < size; column++) {
+            int32_t sum = 0, weight = 0;
+            for (int dr = -1; dr <= 1; dr++) {
+                int64_t sourceRow = 2 * static_cast<int64_t>(row) + dr;
+                if (sourceRow < 0 || sourceRow >= sourceSize) continue;
+                for (int dc = -1; dc <= 1; dc++) {
+                    int64_t sourceColumn = 2 * static_cast<int64_t>(column) + dc;
+                    if (sourceColumn < 0 || sourceColumn >= sourceSize) continue;
+                    int32_t w = (2 - std::abs(dr)) * (2 - std::abs(dc));
+                    sum += w * fetch(static_cast<uint32_t>(sourceRow), static_cast<uint32_t>(sourceColumn));
+                    weight += w;
+                }
+            }
+            out[static_cast<size_t>(row) * size + column] = static_cast<int16_t>(std::lround(static_cast<double>(sum) / weight));
+        }
+    }
+}
+
+// Point levels[1..] at consecutive level blocks starting at base
+void assignLevels(DemFile &file, const int16_t *base) {
+    for (uint32_t level = 1; level < TERRAIN_LEVELS; level++) {
+        file.levels[level] = base;
+        base += static_cast<size_t>(levelSize(level)) * levelSize(level);
+    }
+}
+
+size_t pyramidHeights() {
+    size_t total = 0;
+    for (uint32_t level = 1; level < TERRAIN_LEVELS; level++) total += static_cast<size_t>(levelSize(level)) * levelSize(level);
+    return total;
+}
+
+bool mapCachedPyramid(DemFile &file, const std::string &cachePath, const PyramidHeader &expected) {
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec) || !mapFile(cachePath, file.pyramid)) return false;
+
+    PyramidHeader header;
+    bool valid = file.pyramid.size == sizeof(header) + pyramidHeights() * sizeof(int16_t);
+    if (valid) {
+        std::memcpy(&header, file.pyramid.data, sizeof(header));
+        valid = std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 && header.version == expected.version
+             && header.samples == expected.samples && header.levels == expected.levels
+             && header.sourceSize == expected.sourceSize && header.sourceTime == expected.sourceTime;
+    }
+    if (!valid) {
+        unmapFile(file.pyramid);
+        return false;
+    }
+    assignLevels(file, reinterpret_cast<const int16_t *>(file.pyramid.data + sizeof(header)));
+    return true;
+}
+
+// Load the file's height pyramid from the cache, building and caching it on first use (streaming thread only).
+// If the cache can't be written the pyramid just stays in memory
+bool ensurePyramid(DemFile &file) {
+    if (file.pyramidTried) return file.levels[1] != nullptr;
+    file.pyramidTried = true;
+    auto start = std::chrono::steady_clock::now();
+
+    PyramidHeader header = {};
+    std::memcpy(header.magic, pyramidMagic, sizeof(header.magic));
+    header.version = pyramidVersion;
+    header.samples = terrain.samples;
+    header.levels = TERRAIN_LEVELS;
+    if (!sourceStamp(file.path, header.sourceSize, header.sourceTime)) return false;
+
+    std::string cachePath = terrainCacheDir + file.name + ".dpy";
+    if (mapCachedPyramid(file, cachePath, header)) {
+        terrain.pyramidsCached++;
+        return true;
+    }
+
+    file.pyramidHeap.resize(pyramidHeights());
+    assignLevels(file, file.pyramidHeap.data());
+    downsample([&](uint32_t row, uint32_t column) { return sourceHeight(file, row, column); },
+               terrain.samples, const_cast<int16_t *>(file.levels[1]));
+    for (uint32_t level = 2; level < TERRAIN_LEVELS; level++) {
+        const int16_t *finer = file.levels[level - 1];
+        uint32_t finerSize = levelSize(level - 1);
+        downsample([&](uint32_t row, uint32_t column) { return finer[static_cast<size_t>(row) * finerSize + column]; },
+                   finerSize, const_cast<int16_t *>(file.levels[level]));
+    }
+    terrain.pyramidsBuilt++;
+
+    std::error_code ec;
+    std::filesystem::create_directories(terrainCacheDir, ec);
+    std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(file.pyramidHeap.data()), file.pyramidHeap.size() * sizeof(int16_t));
+    out.close();
+    if (out && mapCachedPyramid(file, cachePath, header)) {
+        std::vector<int16_t>().swap(file.pyramidHeap);
+    } else {
+        LOG_WARN("Cannot write terrain cache {}, keeping the pyramid in memory", cachePath);
+        assignLevels(file, file.pyramidHeap.data());
+    }
+    LOG_INFO("Terrain: built the height pyramid of {} in {} ms", file.name,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+// Height in metres at sample (x, y) of level L's global grid; 0 (sea level) where no file covers it
+double heightAt(uint32_t level, uint64_t x, uint64_t y) {
+    uint64_t stride = (terrain.samples - 1) >> level;
+    auto found = terrain.fileIndex.find(fileKey(y / stride, x / stride));
+    if (found == terrain.fileIndex.end()) return 0.0;
+
+    DemFile &file = terrain.files[found->second];
+    uint32_t row = static_cast<uint32_t>(y % stride), column = static_cast<uint32_t>(x % stride);
+    if (level == 0 || !ensurePyramid(file)) return sourceHeight(file, row << level, column << level);
+    return file.levels[level][static_cast<size_t>(row) * levelSize(level) + column];
+}
+
+TerrainTileData buildTile(uint64_t key) {
+    uint32_t level = static_cast<uint32_t>(key >> 60);
+    uint64_t tileX = (key >> 30) & tileIndexMask, tileY = key & tileIndexMask;
+    double step = static_cast<double>(1u << level);
+
+    TerrainTileData tile = {key, {}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+    tile.positions.reserve(tileVertices * tileVertices * 3);
+    float minY = 0.0f, maxY = 0.0f;
+    for (uint32_t j = 0; j < tileVertices; j++) {
+        for (uint32_t i = 0; i < tileVertices; i++) {
+            double height = heightAt(level, tileX * TERRAIN_TILE_CELLS + i, tileY * TERRAIN_TILE_CELLS + j);
+            float y = groundY + static_cast<float>((height - terrain.originElevation) / terrain.metresPerUnit);
+            tile.positions.insert(tile.positions.end(), {static_cast<float>(i * step * terrain.spacingX), y,
+                                                         static_cast<float>(j * step * terrain.spacingZ)});
+            minY = (i == 0 && j == 0) ? y : std::min(minY, y);
+            maxY = (i == 0 && j == 0) ? y : std::max(maxY, y);
+        }
+    }
+    float extent = static_cast<float>(TERRAIN_TILE_CELLS * step);
+    tile.boundsMin = {0.0f, minY, 0.0f};
+    tile.boundsMax = {static_cast<float>(extent * terrain.spacingX), maxY, static_cast<float>(extent * terrain.spacingZ)};
+    return tile;
+}
+
+void streamLoop() {
+    MemoryScope scope(MEMORY_WORLD);
+    excludeThreadFromFrameMemory();
+    Terrain &t = terrain;
+    for (;;) {
+        uint64_t key;
+        {
+            std::unique_lock<std::mutex> lock(t.mutex);
+            t.wake.wait(lock, [&] { return t.stopping || !t.requests.empty(); });
+            if (t.stopping) return;
+            key = t.requests.front();
+            t.requests.pop_front();
+        }
+        TerrainTileData tile = buildTile(key);
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.ready.push_back(std::move(tile));
+        t.tilesBuilt++;
+    }
+}
+
+// Whether any DEM file overlaps a node's samples, so the sea around the data isn't streamed
+bool nodeCovered(uint32_t level, uint64_t tileX, uint64_t tileY) {
+    uint64_t cells = terrain.samples - 1;
+    uint64_t size = static_cast<uint64_t>(TERRAIN_TILE_CELLS) << level;
+    for (uint64_t row = tileY * size / cells; row <= ((tileY + 1) * size - 1) / cells; row++) {
+        for (uint64_t column = tileX * size / cells; column <= ((tileX + 1) * size - 1) / cells; column++) {
+            if (terrain.fileIndex.count(fileKey(row, column))) return true;
+        }
+    }
+    return false;
+}
+
+bool tileResident(uint64_t key) {
+    auto found = terrain.tiles.find(key);
+    if (found == terrain.tiles.end()) return false;
+    found->second.lastUsedFrame = terrain.frame;
+    return true;
+}
+
+void requestTile(uint64_t key) {
+    if (terrain.pending.size() >= TERRAIN_MAX_PENDING_TILES || !terrain.pending.insert(key).second) return;
+    terrain.wanted.push_back(key);
+}
+
+// Split nodes near the aircraft once all their children are resident; until then draw the node itself
+void selectNode(uint32_t level, uint64_t tileX, uint64_t tileY, double cameraX, double cameraY) {
+    if (!nodeCovered(level, tileX, tileY)) return;
+    uint64_t key = tileKey(level, tileX, tileY);
+
+    double size = static_cast<double>(TERRAIN_TILE_CELLS << level);
+    double dx = std::max({0.0, tileX * size - cameraX, cameraX - (tileX + 1) * size}) * terrain.spacingX;
+    double dy = std::max({0.0, tileY * size - cameraY, cameraY - (tileY + 1) * size}) * terrain.spacingZ;
+    double nodeSize = size * std::max(terrain.spacingX, terrain.spacingZ);
+    if (level > 0 && std::sqrt(dx * dx + dy * dy) < TERRAIN_SPLIT_FACTOR * nodeSize) {
+        bool childrenResident = true;
+        for (uint64_t child = 0; child < 4; child++) {
+            uint64_t childX = tileX * 2 + (child & 1), childY = tileY * 2 + (child >> 1);
+            if (!nodeCovered(level - 1, childX, childY) || tileResident(tileKey(level - 1, childX, childY))) continue;
+            requestTile(tileKey(level - 1, childX, childY));
+            childrenResident = false;
+        }
+        if (childrenResident) {
+            for (uint64_t child = 0; child < 4; child++) {
+                selectNode(level - 1, tileX * 2 + (child & 1), tileY * 2 + (child >> 1), cameraX, cameraY);
+            }
+            return;
+        }
+    }
+    if (tileResident(key)) {
+        terrain.selected.push_back(key);
+    } else {
+        requestTile(key);
+    }
+}
+
+// Take finished tiles from the streamer and upload a few per frame
+void receiveTiles() {
+    Terrain &t = terrain;
+    {
+        std::unique_lock<std::mutex> lock(t.mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            for (TerrainTileData &tile : t.ready) t.received.push_back(std::move(tile));
+            t.ready.clear();
+        }
+    }
+
+    MemoryScope scope(MEMORY_WORLD);
+    for (uint32_t uploads = 0; uploads < TERRAIN_UPLOADS_PER_FRAME && !t.received.empty(); uploads++) {
+        TerrainTileData &data = t.received.front();
+        t.pending.erase(data.key);
+        TerrainTile &tile = t.tiles[data.key];
+        tile.boundsMin = data.boundsMin;
+        tile.boundsMax = data.boundsMax;
+        tile.lastUsedFrame = t.frame;
+        if (renderer.backend == BACKEND_OPENGL) {
+            tile.gpu = uploadPositionMesh(data.positions, t.lineIndices);
+        } else {
+            for (size_t i = 0; i < data.positions.size(); i += 3) {
+                tile.mesh.vertices.push_back({{data.positions[i], data.positions[i + 1], data.positions[i + 2]},
+                                              {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}});
+            }
+            tile.mesh.indices = t.lineIndices;
+            tile.mesh.boundsMin = data.boundsMin;
+            tile.mesh.boundsMax = data.boundsMax;
+            tile.gpu = wrapSoftwareMesh(tile.mesh, false);
+        }
+        t.tilesUploaded++;
+        t.received.pop_front();
+    }
+    t.peakResident = std::max(t.peakResident, t.tiles.size());
+}
+
+// Hand this frame's new requests to the streamer; if it holds the lock they are asked for again next frame
+void sendRequests() {
+    Terrain &t = terrain;
+    if (t.wanted.empty()) return;
+    std::unique_lock<std::mutex> lock(t.mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        t.requests.insert(t.requests.end(), t.wanted.begin(), t.wanted.end());
+        t.wake.notify_one();
+    } else {
+        for (uint64_t key : t.wanted) t.pending.erase(key);
+    }
+    t.wanted.clear();
+}
+
+void destroyTile(TerrainTile &tile) {
+    if (renderer.backend == BACKEND_OPENGL) destroyMesh(tile.gpu);
+}
+
+// Drop the least recently used tiles that weren't touched this frame
+void evictTiles() {
+    Terrain &t = terrain;
+    if (t.tiles.size() <= TERRAIN_MAX_RESIDENT_TILES) return;
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;
+    for (const auto &[key, tile] : t.tiles) {
+        if (tile.lastUsedFrame < t.frame) candidates.push_back({tile.lastUsedFrame, key});
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto &[lastUsed, key] : candidates) {
+        if (t.tiles.size() <= TERRAIN_MAX_RESIDENT_TILES) break;
+        destroyTile(t.tiles[key]);
+        t.tiles.erase(key);
+        t.tilesEvicted++;
+    }
+}
+
+}
+
+/**
+ * initTerrain: Map the SRTM .hgt files in a directory and start the tile streaming thread
+ * Without an origin the centre of the first file (by name) is placed at the world origin.
+ */
+bool initTerrain(const std::string &directory, bool originSet, double latitude, double longitude, double metresPerUnit) {
+    MemoryScope scope(MEMORY_WORLD);
+    Terrain &t = terrain;
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> paths;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == ".hgt") paths.push_back(entry.path());
+    }
+    if (ec) {
+        std::cerr << "Cannot read terrain directory: " << directory << std::endl;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (const std::filesystem::path &path : paths) {
+        DemFile file;
+        file.path = path.string();
+        file.name = path.stem().string();
+        uint64_t bytes = std::filesystem::file_size(path, ec);
+        uint32_t samples = static_cast<uint32_t>(std::lround(std::sqrt(bytes / 2.0)));
+        if (!parseDemName(file.name, file.latitude, file.longitude) || ec
+            || static_cast<uint64_t>(samples) * samples * 2 != bytes || (samples != 1201 && samples != 3601)
+            || (t.samples != 0 && samples != t.samples)) {
+            std::cerr << "Skipping terrain file (not an SRTM tile of the first file's resolution): " << file.path << std::endl;
+            continue;
+        }
+        if (!mapFile(file.path, file.source)) continue;
+        t.samples = samples;
+        t.files.push_back(std::move(file));
+    }
+    if (t.files.empty()) {
+        std::cerr << "No SRTM .hgt files in " << directory << std::endl;
+        return false;
+    }
+
+    uint32_t cells = t.samples - 1;
+    for (uint32_t i = 0; i < t.files.size(); i++) {
+        t.fileIndex[fileKey(89 - t.files[i].latitude, t.files[i].longitude + 180)] = i;
+    }
+    if (!originSet) {
+        latitude = t.files[0].latitude + 0.5;
+        longitude = t.files[0].longitude + 0.5;
+    }
+    t.metresPerUnit = metresPerUnit;
+    t.originSampleX = (longitude + 180.0) * cells;
+    t.originSampleY = (90.0 - latitude) * cells;
+    t.spacingZ = metresPerDegree / cells / metresPerUnit;
+    t.spacingX = t.spacingZ * std::cos(latitude * M_PI / 180.0);
+    t.originElevation = heightAt(0, static_cast<uint64_t>(std::llround(t.originSampleX)),
+                                 static_cast<uint64_t>(std::llround(t.originSampleY)));
+
+    // Every tile shares the same line grid topology
+    for (uint32_t j = 0; j < tileVertices; j++) {
+        for (uint32_t i = 0; i < TERRAIN_TILE_CELLS; i++) {
+            t.lineIndices.insert(t.lineIndices.end(), {j * tileVertices + i, j * tileVertices + i + 1});
+            t.lineIndices.insert(t.lineIndices.end(), {i * tileVertices + j, (i + 1) * tileVertices + j});
+        }
+    }
+    t.tiles.reserve(TERRAIN_MAX_RESIDENT_TILES * 2);
+    t.pending.reserve(TERRAIN_MAX_PENDING_TILES * 2);
+    t.selected.reserve(TERRAIN_MAX_RESIDENT_TILES);
+    t.wanted.reserve(TERRAIN_MAX_PENDING_TILES);
+
+    t.stopping = false;
+    t.active = true;
+    t.streamer = std::thread(streamLoop);
+    std::cout << "Terrain: " << t.files.size() << " DEM files of " << t.samples << "x" << t.samples << " samples from "
+              << directory << ", origin " << latitude << ", " << longitude << " at " << t.originElevation << " m, "
+              << t.spacingX << " x " << t.spacingZ << " units per sample" << std::endl;
+    return true;
+}
+
+/**
+ * renderTerrain: Stream and draw the quadtree tiles around the aircraft in place of the flat grid
+ * Tiles are placed relative to the camera in double, so they stay exact however far the aircraft flies.
+ */
+void renderTerrain() {
+    Terrain &t = terrain;
+    if (!t.active) return;
+    t.frame++;
+    receiveTiles();
+
+    const PlaneState &plane = planeState();
+    double cameraX = static_cast<double>(plane.sectorX) * WORLD_SECTOR_SIZE + plane.posX;
+    double cameraY = static_cast<double>(plane.sectorY) * WORLD_SECTOR_SIZE + plane.posY;
+    double cameraZ = static_cast<double>(plane.sectorZ) * WORLD_SECTOR_SIZE + plane.posZ;
+    double sampleX = t.originSampleX + cameraX / t.spacingX;
+    double sampleY = t.originSampleY + cameraZ / t.spacingZ;
+
+    // The roots are the 3x3 coarsest tiles around the aircraft
+    const uint32_t rootLevel = TERRAIN_LEVELS - 1;
+    double rootSize = static_cast<double>(TERRAIN_TILE_CELLS << rootLevel);
+    int64_t rootX = static_cast<int64_t>(std::floor(sampleX / rootSize));
+    int64_t rootY = static_cast<int64_t>(std::floor(sampleY / rootSize));
+    t.selected.clear();
+    for (int64_t y = rootY - 1; y <= rootY + 1; y++) {
+        for (int64_t x = rootX - 1; x <= rootX + 1; x++) {
+            if (x < 0 || y < 0 || x > static_cast<int64_t>(tileIndexMask) || y > static_cast<int64_t>(tileIndexMask)) continue;
+            selectNode(rootLevel, static_cast<uint64_t>(x), static_cast<uint64_t>(y), sampleX, sampleY);
+        }
+    }
+    sendRequests();
+
+    const Mat4 &base = modelStack.top();
+    Frustum frustum = frustumFromMatrix(renderer.camera.projection * renderer.camera.view * base);
+    for (uint64_t key : t.selected) {
+        const TerrainTile &tile = t.tiles[key];
+        uint32_t level = static_cast<uint32_t>(key >> 60);
+        double size = static_cast<double>(TERRAIN_TILE_CELLS << level);
+        float offset[3] = {
+            static_cast<float>((((key >> 30) & tileIndexMask) * size - t.originSampleX) * t.spacingX - cameraX),
+            static_cast<float>(-cameraY),
+            static_cast<float>(((key & tileIndexMask) * size - t.originSampleY) * t.spacingZ - cameraZ),
+        };
+        float boundsMin[3] = {tile.boundsMin.x + offset[0], tile.boundsMin.y + offset[1], tile.boundsMin.z + offset[2]};
+        float boundsMax[3] = {tile.boundsMax.x + offset[0], tile.boundsMax.y + offset[1], tile.boundsMax.z + offset[2]};
+        if (!frustumIntersectsAabb(frustum, boundsMin, boundsMax)) continue;
+        submitColored(tile.gpu, GL_LINES, base * mat4Translate(offset[0], offset[1], offset[2]), 0.3f, 0.4f, 0.3f);
+    }
+    evictTiles();
+}
+
+/**
+ * destroyTerrain: Stop the streaming thread, release the tiles and unmap the DEM files
+ */
+void destroyTerrain() {
+    Terrain &t = terrain;
+    if (!t.active) return;
+    {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.stopping = true;
+    }
+    t.wake.notify_one();
+    t.streamer.join();
+
+    std::cout << "Terrain: built " << t.tilesBuilt << " tiles (" << t.pyramidsBuilt << " height pyramids built, "
+              << t.pyramidsCached << " from " << terrainCacheDir << "), uploaded " << t.tilesUploaded << ", evicted "
+              << t.tilesEvicted << ", peak " << t.peakResident << " resident tiles" << std::endl;
+
+    for (auto &[key, tile] : t.tiles) destroyTile(tile);
+    for (DemFile &file : t.files) {
+        unmapFile(file.source);
+        unmapFile(file.pyramid);
+    }
+    t.files.clear();
+    t.fileIndex.clear();
+    t.tiles.clear();
+    t.pending.clear();
+    t.received.clear();
+    t.requests.clear();
+    t.ready.clear();
+    t.active = false;
+}
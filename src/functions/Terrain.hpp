@@ -0,0 +1,99 @@
+#ifndef TERRAIN_HPP
+#define TERRAIN_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Mesh.hpp"
+
+// Tiles are TERRAIN_TILE_CELLS cells on a side at every level; level L spaces its heights 2^L samples apart.
+// Both SRTM resolutions (1200 and 3600 cells per degree) divide into 2^(TERRAIN_LEVELS - 1)
+const uint32_t TERRAIN_TILE_CELLS = 32;
+const uint32_t TERRAIN_LEVELS = 5;
+const uint32_t TERRAIN_MAX_RESIDENT_TILES = 512;
+const uint32_t TERRAIN_UPLOADS_PER_FRAME = 4;
+const uint32_t TERRAIN_MAX_PENDING_TILES = 64;
+const float TERRAIN_SPLIT_FACTOR = 1.5f;
+
+extern const std::string terrainCacheDir;
+
+// One SRTM .hgt file: samples x samples big-endian int16 metres, rows north to south, covering the degree
+// north-east of (latitude, longitude); neighbouring files share their edge rows and columns.
+// levels[1..] point into the height pyramid, which only the streaming thread builds and reads
+struct DemFile {
+    std::string path;
+    std::string name;
+    int latitude = 0, longitude = 0;
+    MappedFile source;
+    MappedFile pyramid;
+    std::vector<int16_t> pyramidHeap;
+    const int16_t *levels[TERRAIN_LEVELS] = {};
+    bool pyramidTried = false;
+};
+
+// Line grid of one quadtree node built by the streaming thread, positions relative to the tile's north-west corner
+struct TerrainTileData {
+    uint64_t key;
+    std::vector<float> positions;
+    Vertex boundsMin, boundsMax;
+};
+
+// mesh is only filled for the software backend, which draws straight from it
+struct TerrainTile {
+    GpuMesh gpu;
+    MeshData mesh;
+    Vertex boundsMin, boundsMax;
+    uint64_t lastUsedFrame = 0;
+};
+
+// Elevation tiles streamed around the aircraft. The render thread walks the quadtree, draws the resident
+// tiles and queues the missing ones; a streaming thread builds them from the memory-mapped DEM files and
+// their cached height pyramids. The render thread only ever try-locks, so a busy streamer costs it a
+// frame of latency on new tiles, never a stall.
+struct Terrain {
+    bool active = false;
+    uint32_t samples = 0;
+    double metresPerUnit = 30.0;
+    double spacingX = 1.0, spacingZ = 1.0;
+    double originSampleX = 0.0, originSampleY = 0.0;
+    double originElevation = 0.0;
+    std::vector<DemFile> files;
+    std::unordered_map<uint64_t, uint32_t> fileIndex;
+    std::vector<uint32_t> lineIndices;
+
+    std::unordered_map<uint64_t, TerrainTile> tiles;
+    std::unordered_set<uint64_t> pending;
+    std::deque<TerrainTileData> received;
+    std::vector<uint64_t> selected;
+    std::vector<uint64_t> wanted;
+    uint64_t frame = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint64_t> requests;
+    std::vector<TerrainTileData> ready;
+    std::thread streamer;
+    bool stopping = false;
+
+    uint64_t tilesBuilt = 0;
+    uint64_t tilesUploaded = 0;
+    uint64_t tilesEvicted = 0;
+    size_t peakResident = 0;
+    uint32_t pyramidsBuilt = 0;
+    uint32_t pyramidsCached = 0;
+};
+
+extern Terrain terrain;
+
+bool initTerrain(const std::string &directory, bool originSet, double latitude, double longitude, double metresPerUnit);
+void renderTerrain();
+void destroyTerrain();
+
+#endif
@@ -0,0 +1,704 @@
+#include "TextureCache.hpp"
+#include "MemoryTracker.hpp"
+#include "AssetPack.hpp"
+#include "Log.hpp"
+#include <GLFW/glfw3.h>
+#include <jpeglib.h>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+const std::string textureCacheDir = "cache/";
+
+namespace {
+
+const char textureCacheMagic[8] = {'F', 'S', 'T', 'E', 'X', 'C', 'H', '\0'};
+const uint32_t textureCacheVersion = 1;
+
+struct TextureCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+    uint32_t width, height;
+    uint32_t levelCount;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    double buildMs;
+};
+
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info) {
+    JpegErrorManager *manager = reinterpret_cast<JpegErrorManager *>(info->err);
+    char message[JMSG_LENGTH_MAX];
+    (*info->err->format_message)(info, message);
+    std::cerr << "JPEG error: " << message << std::endl;
+    longjmp(manager->jump, 1);
+}
+
+size_t blockBytes(TextureFormat format) {
+    return format == TextureFormat::BC1 ? 8 : 16;
+}
+
+size_t levelBytes(TextureFormat format, uint32_t width, uint32_t height) {
+    if (format == TextureFormat::RGBA8) return static_cast<size_t>(width) * height * 4;
+    size_t blocksX = std::max(1u, (width + 3) / 4);
+    size_t blocksY = std::max(1u, (height + 3) / 4);
+    return blocksX * blocksY * blockBytes(format);
+}
+
+// A cache file must hold exactly the mip chain writeTextureCache stores: every level from the full size
+// down to 1x1, each the size its format and dimensions call for, packed back to back to the end of the file
+bool validCacheLayout(const TextureCacheHeader &header, const std::vector<TextureLevel> &levels, uint64_t fileSize) {
+    if (header.format > static_cast<uint32_t>(TextureFormat::BC3)) return false;
+    if (header.width == 0 || header.height == 0 || header.width > 65536 || header.height > 65536) return false;
+
+    TextureFormat format = static_cast<TextureFormat>(header.format);
+    uint32_t width = header.width, height = header.height;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const TextureLevel &level = levels[i];
+        if (level.width != width || level.height != height || level.offset != offset
+            || level.size != levelBytes(format, width, height)) {
+            return false;
+        }
+        offset += level.size;
+        bool last = width == 1 && height == 1;
+        if (last != (i + 1 == levels.size())) return false;
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+    return sizeof(TextureCacheHeader) + levels.size() * sizeof(TextureLevel) + offset == fileSize;
+}
+
+// RGB565 <-> RGB888 with bit replication so 0 and 255 round-trip exactly
+uint16_t packRgb565(float r, float g, float b) {
+    int ri = std::clamp(static_cast<int>(std::lround(r * 31.0f / 255.0f)), 0, 31);
+    int gi = std::clamp(static_cast<int>(std::lround(g * 63.0f / 255.0f)), 0, 63);
+    int bi = std::clamp(static_cast<int>(std::lround(b * 31.0f / 255.0f)), 0, 31);
+    return static_cast<uint16_t>((ri << 11) | (gi << 5) | bi);
+}
+
+void unpackRgb565(uint16_t c, int out[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+    unpackRgb565(c0, palette[0]);
+    unpackRgb565(c1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        if (c0 > c1) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        } else {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+            palette[3][k] = 0;
+        }
+    }
+}
+
+int colorDistance(const uint8_t *pixel, const int color[3]) {
+    int dr = pixel[0] - color[0], dg = pixel[1] - color[1], db = pixel[2] - color[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+uint32_t assignBc1Indices(const uint8_t block[16][4], uint16_t c0, uint16_t c1, int &error) {
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    uint32_t indices = 0;
+    error = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestDist = colorDistance(block[i], palette[0]);
+        for (int p = 1; p < 4; p++) {
+            int dist = colorDistance(block[i], palette[p]);
+            if (dist < bestDist) { best = p; bestDist = dist; }
+        }
+        indices |= static_cast<uint32_t>(best) << (2 * i);
+        error += bestDist;
+    }
+    return indices;
+}
+
+/**
+ * encodeBc1Block: principal-axis endpoints followed by one least-squares refinement
+ */
+void encodeBc1Block(const uint8_t block[16][4], uint8_t *out) {
+    float mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) mean[k] += block[i][k] / 16.0f;
+
+    float cov[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        float d[3] = {block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2]};
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iter = 0; iter < 4; iter++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::sqrt(x * x + y * y + z * z);
+        if (len < 1e-6f) break;
+        axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+    }
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    uint16_t c0 = packRgb565(mean[0] + axis[0] * maxT, mean[1] + axis[1] * maxT, mean[2] + axis[2] * maxT);
+    uint16_t c1 = packRgb565(mean[0] + axis[0] * minT, mean[1] + axis[1] * minT, mean[2] + axis[2] * minT);
+    if (c0 < c1) std::swap(c0, c1);
+
+    int error = 0;
+    uint32_t indices = assignBc1Indices(block, c0, c1, error);
+
+    if (c0 != c1 && error > 0) {
+        // Solve for the endpoints that best fit the chosen palette weights
+        const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float a = 0, b = 0, c = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+        for (int i = 0; i < 16; i++) {
+            float w = weights[(indices >> (2 * i)) & 3];
+            a += w * w; b += (1 - w) * (1 - w); c += w * (1 - w);
+            for (int k = 0; k < 3; k++) {
+                ax[k] += w * block[i][k];
+                bx[k] += (1 - w) * block[i][k];
+            }
+        }
+        float det = a * b - c * c;
+        if (std::fabs(det) > 1e-6f) {
+            float e0[3], e1[3];
+            for (int k = 0; k < 3; k++) {
+                e0[k] = (ax[k] * b - bx[k] * c) / det;
+                e1[k] = (bx[k] * a - ax[k] * c) / det;
+            }
+            uint16_t r0 = packRgb565(e0[0], e0[1], e0[2]);
+            uint16_t r1 = packRgb565(e1[0], e1[1], e1[2]);
+            if (r0 < r1) std::swap(r0, r1);
+            if (r0 != r1) {
+                int refinedError = 0;
+                uint32_t refined = assignBc1Indices(block, r0, r1, refinedError);
+                if (refinedError < error) {
+                    c0 = r0; c1 = r1; indices = refined;
+                }
+            }
+        }
+    }
+
+    if (c0 == c1) indices = 0;
+
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+void encodeBc3AlphaBlock(const uint8_t block[16][4], uint8_t *out) {
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++) {
+        a0 = std::max(a0, static_cast<int>(block[i][3]));
+        a1 = std::min(a1, static_cast<int>(block[i][3]));
+    }
+
+    int palette[8] = {a0, a1};
+    for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestDist = 256;
+        for (int p = 0; p < 8; p++) {
+            int dist = std::abs(block[i][3] - palette[p]);
+            if (dist < bestDist) { best = p; bestDist = dist; }
+        }
+        bits |= static_cast<uint64_t>(best) << (3 * i);
+    }
+
+    out[0] = static_cast<uint8_t>(a0);
+    out[1] = static_cast<uint8_t>(a1);
+    for (int i = 0; i < 6; i++) out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+void decodeBc1Block(const uint8_t *in, uint8_t block[16][4]) {
+    uint16_t c0, c1;
+    uint32_t indices;
+    std::memcpy(&c0, in, 2);
+    std::memcpy(&c1, in + 2, 2);
+    std::memcpy(&indices, in + 4, 4);
+
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    for (int i = 0; i < 16; i++) {
+        int p = (indices >> (2 * i)) & 3;
+        block[i][0] = static_cast<uint8_t>(palette[p][0]);
+        block[i][1] = static_cast<uint8_t>(palette[p][1]);
+        block[i][2] = static_cast<uint8_t>(palette[p][2]);
+        block[i][3] = (c0 <= c1 && p == 3) ? 0 : 255;
+    }
+}
+
+void decodeBc3AlphaBlock(const uint8_t *in, uint8_t block[16][4]) {
+    int a0 = in[0], a1 = in[1];
+    int palette[8] = {a0, a1};
+    if (a0 > a1) {
+        for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    } else {
+        for (int i = 1; i < 5; i++) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) bits |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; i++) block[i][3] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+}
+
+std::vector<uint8_t> downsample(const std::vector<uint8_t> &src, uint32_t width, uint32_t height) {
+    uint32_t dstWidth = std::max(1u, width / 2), dstHeight = std::max(1u, height / 2);
+    std::vector<uint8_t> dst(static_cast<size_t>(dstWidth) * dstHeight * 4);
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            for (int k = 0; k < 4; k++) {
+                int sum = src[(y0 * width + x0) * 4 + k] + src[(y0 * width + x1) * 4 + k]
+                        + src[(y1 * width + x0) * 4 + k] + src[(y1 * width + x1) * 4 + k];
+                dst[(y * dstWidth + x) * 4 + k] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return dst;
+}
+
+void fetchBlock(const std::vector<uint8_t> &rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, uint8_t block[16][4]) {
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t py = std::min(by * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t px = std::min(bx * 4 + x, width - 1);
+            std::memcpy(block[y * 4 + x], &rgba[(py * width + px) * 4], 4);
+        }
+    }
+}
+
+GLenum glFormatFor(TextureFormat format) {
+    return format == TextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+const char *formatName(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1: return "BC1";
+        case TextureFormat::BC3: return "BC3";
+        default: return "RGBA8";
+    }
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+/**
+ * decodeJpeg: Decode a baseline or progressive JPEG into RGBA8, straight from the asset pack when it holds the path
+ */
+bool decodeJpeg(const std::string &filepath, std::vector<uint8_t> &rgba, int &width, int &height) {
+    AssetView packed;
+    FILE *const file = readPackedAsset(filepath, packed) ? nullptr : std::fopen(filepath.c_str(), "rb");
+    if (!file && !packed.data) {
+        std::cerr << "Cannot open: " << filepath << std::endl;
+        return false;
+    }
+
+    jpeg_decompress_struct info;
+    JpegErrorManager error;
+    std::vector<uint8_t> row;
+    info.err = jpeg_std_error(&error.base);
+    error.base.error_exit = jpegErrorExit;
+
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&info);
+        if (file) std::fclose(file);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    if (file) {
+        jpeg_stdio_src(&info, file);
+    } else {
+        jpeg_mem_src(&info, packed.data, static_cast<unsigned long>(packed.size));
+    }
+    jpeg_read_header(&info, TRUE);
+    info.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&info);
+
+    width = static_cast<int>(info.output_width);
+    height = static_cast<int>(info.output_height);
+    rgba.assign(static_cast<size_t>(width) * height * 4, 255);
+
+    row.resize(static_cast<size_t>(width) * 3);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW rowPtr = row.data();
+        size_t y = info.output_scanline;
+        jpeg_read_scanlines(&info, &rowPtr, 1);
+        uint8_t *dst = &rgba[y * width * 4];
+        for (int x = 0; x < width; x++) {
+            dst[x * 4 + 0] = row[x * 3 + 0];
+            dst[x * 4 + 1] = row[x * 3 + 1];
+            dst[x * 4 + 2] = row[x * 3 + 2];
+        }
+    }
+
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    if (file) std::fclose(file);
+    return true;
+}
+
+/**
+ * buildCompressedTexture: Generate a full mip chain and encode it as BC1 (opaque) or BC3 (alpha)
+ */
+CompressedTexture buildCompressedTexture(const std::vector<uint8_t> &rgba, int width, int height) {
+    CompressedTexture texture;
+    texture.width = static_cast<uint32_t>(width);
+    texture.height = static_cast<uint32_t>(height);
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+        if (rgba[i] != 255) { hasAlpha = true; break; }
+    }
+    texture.format = hasAlpha ? TextureFormat::BC3 : TextureFormat::BC1;
+
+    std::vector<uint8_t> level = rgba;
+    uint32_t levelWidth = texture.width, levelHeight = texture.height;
+
+    while (true) {
+        uint32_t blocksX = std::max(1u, (levelWidth + 3) / 4);
+        uint32_t blocksY = std::max(1u, (levelHeight + 3) / 4);
+        size_t size = levelBytes(texture.format, levelWidth, levelHeight);
+
+        TextureLevel info = {levelWidth, levelHeight, texture.data.size(), size};
+        texture.data.resize(texture.data.size() + size);
+        uint8_t *out = texture.data.data() + info.offset;
+
+        uint8_t block[16][4];
+        for (uint32_t by = 0; by < blocksY; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                fetchBlock(level, levelWidth, levelHeight, bx, by, block);
+                if (texture.format == TextureFormat::BC3) {
+                    encodeBc3AlphaBlock(block, out);
+                    encodeBc1Block(block, out + 8);
+                    out += 16;
+                } else {
+                    encodeBc1Block(block, out);
+                    out += 8;
+                }
+            }
+        }
+
+        texture.levels.push_back(info);
+        if (levelWidth == 1 && levelHeight == 1) break;
+
+        level = downsample(level, levelWidth, levelHeight);
+        levelWidth = std::max(1u, levelWidth / 2);
+        levelHeight = std::max(1u, levelHeight / 2);
+    }
+
+    return texture;
+}
+
+/**
+ * decompressLevel: Expand one mip level back to RGBA8 (used when S3TC is unavailable)
+ */
+std::vector<uint8_t> decompressLevel(const CompressedTexture &texture, size_t level) {
+    const TextureLevel &info = texture.levels[level];
+    const uint8_t *in = texture.data.data() + info.offset;
+    if (texture.format == TextureFormat::RGBA8) return std::vector<uint8_t>(in, in + info.size);
+
+    std::vector<uint8_t> rgba(static_cast<size_t>(info.width) * info.height * 4);
+    uint32_t blocksX = std::max(1u, (info.width + 3) / 4);
+    uint32_t blocksY = std::max(1u, (info.height + 3) / 4);
+
+    uint8_t block[16][4];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            if (texture.format == TextureFormat::BC3) {
+                decodeBc1Block(in + 8, block);
+                decodeBc3AlphaBlock(in, block);
+                in += 16;
+            } else {
+                decodeBc1Block(in, block);
+                in += 8;
+            }
+
+            for (uint32_t y = 0; y < 4 && by * 4 + y < info.height; y++) {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < info.width; x++) {
+                    std::memcpy(&rgba[((by * 4 + y) * info.width + bx * 4 + x) * 4], block[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+
+    return rgba;
+}
+
+/**
+ * sourceStamp: Size and modification time of a cache's source file, to tell when the cache is stale
+ * A packed asset reports the stamp its loose file had when packed.
+ */
+bool sourceStamp(const std::string &sourcePath, uint64_t &size, int64_t &time) {
+    if (const AssetPackEntry *entry = findPackedAsset(sourcePath)) {
+        size = entry->sourceSize;
+        time = entry->sourceTime;
+        return true;
+    }
+    std::error_code ec;
+    size = std::filesystem::file_size(sourcePath, ec);
+    if (ec) return false;
+    auto stamp = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) return false;
+    time = stamp.time_since_epoch().count();
+    return true;
+}
+
+/**
+ * textureCachePath: cache/<name>.ktc for a source texture
+ */
+std::string textureCachePath(const std::string &sourcePath) {
+    return textureCacheDir + std::filesystem::path(sourcePath).stem().string() + ".ktc";
+}
+
+/**
+ * writeTextureCache: Store header, level table and block data in one file
+ */
+bool writeTextureCache(const std::string &cachePath, const CompressedTexture &texture, const std::string &sourcePath) {
+    TextureCacheHeader header = {};
+    std::memcpy(header.magic, textureCacheMagic, sizeof(header.magic));
+    header.version = textureCacheVersion;
+    header.format = static_cast<uint32_t>(texture.format);
+    header.width = texture.width;
+    header.height = texture.height;
+    header.levelCount = static_cast<uint32_t>(texture.levels.size());
+    header.buildMs = texture.buildMs;
+    if (!sourceStamp(sourcePath, header.sourceSize, header.sourceTime)) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Cannot write texture cache: " << cachePath << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(texture.levels.data()), texture.levels.size() * sizeof(TextureLevel));
+    file.write(reinterpret_cast<const char *>(texture.data.data()), texture.data.size());
+    return static_cast<bool>(file);
+}
+
+/**
+ * readTextureCache: Load a cached texture if it is still newer than its source
+ * A file whose level table does not describe its dimensions, format and length is discarded, so the
+ * caller re-encodes the texture and overwrites it.
+ */
+bool readTextureCache(const std::string &cachePath, CompressedTexture &texture, const std::string &sourcePath) {
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    TextureCacheHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, textureCacheMagic, sizeof(header.magic)) != 0) return false;
+    if (header.version != textureCacheVersion || header.levelCount == 0 || header.levelCount > 32) return false;
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceStamp(sourcePath, sourceSize, sourceTime)) return false;
+    if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) return false;
+
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+    std::vector<TextureLevel> levels(header.levelCount);
+    if (ec || !file.read(reinterpret_cast<char *>(levels.data()), header.levelCount * sizeof(TextureLevel))
+        || !validCacheLayout(header, levels, fileSize)) {
+        std::cerr << "Discarding corrupt texture cache: " << cachePath << std::endl;
+        return false;
+    }
+
+    texture.format = static_cast<TextureFormat>(header.format);
+    texture.width = header.width;
+    texture.height = header.height;
+    texture.buildMs = header.buildMs;
+    texture.levels = std::move(levels);
+    const TextureLevel &last = texture.levels.back();
+    texture.data.resize(last.offset + last.size);
+    if (!file.read(reinterpret_cast<char *>(texture.data.data()), texture.data.size())) {
+        std::cerr << "Discarding corrupt texture cache: " << cachePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * loadCompressedTexture: Read the compressed mip chain from the cache, building it on first run
+ */
+bool loadCompressedTexture(const std::string &filepath, CompressedTexture &texture, bool &fromCache) {
+    MemoryScope scope(MEMORY_LOADER);
+    auto start = std::chrono::steady_clock::now();
+    std::string cachePath = textureCachePath(filepath);
+    fromCache = readTextureCache(cachePath, texture, filepath);
+    if (fromCache) return true;
+
+    std::vector<uint8_t> rgba;
+    int width = 0, height = 0;
+    if (!decodeJpeg(filepath, rgba, width, height)) return false;
+
+    texture = buildCompressedTexture(rgba, width, height);
+    texture.buildMs = elapsedMs(start);
+    writeTextureCache(cachePath, texture, filepath);
+    return true;
+}
+
+/**
+ * loadTexture: Load a texture through the cache and upload it, compressed when S3TC is available
+ */
+Texture loadTexture(const std::string &filepath) {
+    auto start = std::chrono::steady_clock::now();
+    CompressedTexture texture;
+    bool fromCache = false;
+    if (!loadCompressedTexture(filepath, texture, fromCache)) return Texture();
+    return createTexture(filepath, texture, fromCache, elapsedMs(start));
+}
+
+/**
+ * createTexture: Upload a texture loaded by loadCompressedTexture (GL thread only)
+ * loadMs is the time already spent loading it; the upload time is added on top.
+ */
+Texture createTexture(const std::string &filepath, const CompressedTexture &texture, bool fromCache, double loadMs) {
+    Texture result;
+    result.fromCache = fromCache;
+    auto start = std::chrono::steady_clock::now();
+
+    bool compressed = texture.format != TextureFormat::RGBA8
+                   && glfwExtensionSupported("GL_EXT_texture_compression_s3tc");
+
+    glGenTextures(1, &result.id);
+    glBindTexture(GL_TEXTURE_2D, result.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (size_t i = 0; i < texture.levels.size(); i++) {
+        const TextureLevel &level = texture.levels[i];
+        result.rawBytes += static_cast<size_t>(level.width) * level.height * 4;
+
+        if (compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), glFormatFor(texture.format),
+                                   level.width, level.height, 0, static_cast<GLsizei>(level.size),
+                                   texture.data.data() + level.offset);
+            result.gpuBytes += level.size;
+        } else {
+            std::vector<uint8_t> rgba = decompressLevel(texture, i);
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA8, level.width, level.height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            result.gpuBytes += rgba.size();
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackGpuMemory(GPU_TEXTURE, result.id, MEMORY_RENDERER, result.gpuBytes);
+
+    result.width = static_cast<int>(texture.width);
+    result.height = static_cast<int>(texture.height);
+    result.format = compressed ? texture.format : TextureFormat::RGBA8;
+    result.loadMs = loadMs + elapsedMs(start);
+
+    LOG_INFO("Texture: {} {}x{} {}, {} mip levels", std::filesystem::path(filepath).filename().string(),
+             result.width, result.height, formatName(result.format), texture.levels.size());
+    LOG_INFO("Texture VRAM: {} KB (RGBA8 would be {} KB, saved {}%)", result.gpuBytes / 1024, result.rawBytes / 1024,
+             100 - (result.gpuBytes * 100) / std::max<size_t>(result.rawBytes, 1));
+    if (result.fromCache) {
+        LOG_INFO("Texture load: {} ms from cache (first run took {} ms to decode and encode)", result.loadMs,
+                 texture.buildMs);
+    } else {
+        LOG_INFO("Texture load: {} ms (built {})", result.loadMs, textureCachePath(filepath));
+    }
+
+    return result;
+}
+
+/**
+ * updateTexture: Replace a texture's contents, rewriting its levels in place when size and format are unchanged
+ * (the cache always stores a full mip chain, so that fixes the levels too). Returns false when a new texture
+ * had to be created (the GL name changes).
+ */
+bool updateTexture(Texture &texture, const std::string &filepath, const CompressedTexture &data, bool fromCache,
+                   double loadMs) {
+    bool compressed = data.format != TextureFormat::RGBA8
+                   && glfwExtensionSupported("GL_EXT_texture_compression_s3tc");
+    TextureFormat format = compressed ? data.format : TextureFormat::RGBA8;
+    if (!texture.id || texture.width != static_cast<int>(data.width) || texture.height != static_cast<int>(data.height)
+        || texture.format != format) {
+        Texture fresh = createTexture(filepath, data, fromCache, loadMs);
+        destroyTexture(texture);
+        texture = fresh;
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < data.levels.size(); i++) {
+        const TextureLevel &level = data.levels[i];
+        if (compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), 0, 0, level.width, level.height,
+                                      glFormatFor(data.format), static_cast<GLsizei>(level.size),
+                                      data.data.data() + level.offset);
+        } else {
+            std::vector<uint8_t> rgba = decompressLevel(data, i);
+            glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), 0, 0, level.width, level.height,
+                            GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture.fromCache = fromCache;
+    texture.loadMs = loadMs;
+    return true;
+}
+
+/**
+ * destroyTexture: Release the GL texture
+ */
+void destroyTexture(Texture &texture) {
+    if (texture.id) {
+        releaseGpuMemory(GPU_TEXTURE, texture.id);
+        glDeleteTextures(1, &texture.id);
+    }
+    texture.id = 0;
+}
@@ -0,0 +1,55 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Block-compressed formats stored in the texture cache
+enum class TextureFormat : uint32_t {
+    RGBA8 = 0,
+    BC1 = 1,
+    BC3 = 2
+};
+
+struct TextureLevel {
+    uint32_t width, height;
+    uint64_t offset, size;
+};
+
+struct CompressedTexture {
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0, height = 0;
+    std::vector<TextureLevel> levels;
+    std::vector<uint8_t> data;
+    double buildMs = 0.0;
+};
+
+struct Texture {
+    GLuint id = 0;
+    int width = 0, height = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    size_t gpuBytes = 0;
+    size_t rawBytes = 0;
+    double loadMs = 0.0;
+    bool fromCache = false;
+};
+
+extern const std::string textureCacheDir;
+
+bool decodeJpeg(const std::string &filepath, std::vector<uint8_t> &rgba, int &width, int &height);
+CompressedTexture buildCompressedTexture(const std::vector<uint8_t> &rgba, int width, int height);
+bool writeTextureCache(const std::string &cachePath, const CompressedTexture &texture, const std::string &sourcePath);
+bool readTextureCache(const std::string &cachePath, CompressedTexture &texture, const std::string &sourcePath);
+std::vector<uint8_t> decompressLevel(const CompressedTexture &texture, size_t level);
+bool sourceStamp(const std::string &sourcePath, uint64_t &size, int64_t &time);
+std::string textureCachePath(const std::string &sourcePath);
+bool loadCompressedTexture(const std::string &filepath, CompressedTexture &texture, bool &fromCache);
+Texture loadTexture(const std::string &filepath);
+Texture createTexture(const std::string &filepath, const CompressedTexture &texture, bool fromCache, double loadMs);
+bool updateTexture(Texture &texture, const std::string &filepath, const CompressedTexture &data, bool fromCache,
+                   double loadMs);
+void destroyTexture(Texture &texture);
+
+#endif
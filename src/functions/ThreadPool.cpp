@@ -0,0 +1,88 @@
+#include "ThreadPool.hpp"
+
+ThreadPool threadPool;
+
+namespace {
+
+// Claim indices until the job is exhausted; shared by workers and the caller
+void runIndices() {
+    uint32_t index;
+    while ((index = threadPool.nextIndex.fetch_add(1, std::memory_order_relaxed)) < threadPool.jobCount) {
+        threadPool.job->call(threadPool.job->context, index);
+    }
+}
+
+void workerLoop() {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(threadPool.mutex);
+            threadPool.wake.wait(lock, [&] { return threadPool.stopping || threadPool.generation != seenGeneration; });
+            if (threadPool.stopping) return;
+            seenGeneration = threadPool.generation;
+        }
+
+        runIndices();
+
+        std::lock_guard<std::mutex> lock(threadPool.mutex);
+        if (--threadPool.activeWorkers == 0) threadPool.done.notify_one();
+    }
+}
+
+}
+
+/**
+ * startThreadPool: Spawn workerCount workers (0 runs every job on the calling thread)
+ */
+void startThreadPool(uint32_t workerCount) {
+    stopThreadPool();
+    threadPool.stopping = false;
+    for (uint32_t i = 0; i < workerCount; i++) threadPool.workers.emplace_back(workerLoop);
+}
+
+/**
+ * stopThreadPool: Wake and join all workers
+ */
+void stopThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(threadPool.mutex);
+        threadPool.stopping = true;
+    }
+    threadPool.wake.notify_all();
+    for (std::thread &worker : threadPool.workers) worker.join();
+    threadPool.workers.clear();
+}
+
+/**
+ * threadPoolSize: Number of threads that take part in a parallelFor, including the caller
+ */
+uint32_t threadPoolSize() {
+    return static_cast<uint32_t>(threadPool.workers.size()) + 1;
+}
+
+/**
+ * runParallelJob: Run job(0..count-1) across the pool and the calling thread (see parallelFor)
+ */
+void runParallelJob(uint32_t count, const ParallelJob &job) {
+    if (count == 0) return;
+    if (threadPool.workers.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++) job.call(job.context, i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(threadPool.mutex);
+        threadPool.job = &job;
+        threadPool.jobCount = count;
+        threadPool.nextIndex.store(0, std::memory_order_relaxed);
+        threadPool.activeWorkers = static_cast<uint32_t>(threadPool.workers.size());
+        threadPool.generation++;
+    }
+    threadPool.wake.notify_all();
+
+    runIndices();
+
+    std::unique_lock<std::mutex> lock(threadPool.mutex);
+    threadPool.done.wait(lock, [] { return threadPool.activeWorkers == 0; });
+    threadPool.job = nullptr;
+}
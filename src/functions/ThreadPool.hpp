@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Non-owning reference to a parallelFor body; unlike std::function, wrapping a lambda never allocates
+struct ParallelJob {
+    const void *context;
+    void (*call)(const void *context, uint32_t index);
+};
+
+// Fixed set of workers that run parallelFor jobs together with the calling thread
+struct ThreadPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const ParallelJob *job = nullptr;
+    uint32_t jobCount = 0;
+    std::atomic<uint32_t> nextIndex{0};
+    uint32_t activeWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+extern ThreadPool threadPool;
+
+void startThreadPool(uint32_t workerCount);
+void stopThreadPool();
+uint32_t threadPoolSize();
+void runParallelJob(uint32_t count, const ParallelJob &job);
+
+/**
+ * parallelFor: Run fn(0..count-1) across the pool and the calling thread, returning when all are done
+ */
+template <typename Fn>
+void parallelFor(uint32_t count, Fn &&fn) {
+    auto *target = &fn;
+    runParallelJob(count, {&target, [](const void *context, uint32_t index) {
+        (**static_cast<decltype(target) const *>(context))(index);
+    }});
+}
+
+#endif
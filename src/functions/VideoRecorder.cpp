@@ -0,0 +1,281 @@
+#include "VideoRecorder.hpp"
+#include "MemoryTracker.hpp"
+#include "Renderer.hpp"
+#include "SoftwareRenderer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+VideoRecorder videoRecorder;
+
+namespace {
+
+const int recordFps = 60;
+const size_t writeBufferBytes = 8 * 1024 * 1024;
+
+// BT.601 limited range with chroma centred between its 2x2 luma samples, as the C420 XCOLORRANGE=LIMITED
+// header declares; rgba is bottom-up as read back, the planes run top-down
+void convertToI420(const uint8_t *rgba, int width, int height, std::vector<uint8_t> &yuv) {
+    int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    yuv.resize(static_cast<size_t>(width) * height + 2 * static_cast<size_t>(chromaWidth) * chromaHeight);
+    uint8_t *planeY = yuv.data();
+    uint8_t *planeU = planeY + static_cast<size_t>(width) * height;
+    uint8_t *planeV = planeU + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    auto pixel = [&](int x, int y) {
+        return rgba + (static_cast<size_t>(height - 1 - y) * width + x) * 4;
+    };
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t *p = pixel(x, y);
+            planeY[static_cast<size_t>(y) * width + x] =
+                static_cast<uint8_t>(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+        }
+    }
+
+    // Chroma from the average of each 2x2 block
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    int x = std::min(cx * 2 + dx, width - 1), y = std::min(cy * 2 + dy, height - 1);
+                    const uint8_t *p = pixel(x, y);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            size_t index = static_cast<size_t>(cy) * chromaWidth + cx;
+            planeU[index] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            planeV[index] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+void encoderLoop() {
+    MemoryScope scope(MEMORY_RECORDER);
+    excludeThreadFromFrameMemory();
+    VideoRecorder &recorder = videoRecorder;
+    std::vector<uint8_t> yuv;
+    for (;;) {
+        uint32_t slot;
+        {
+            std::unique_lock<std::mutex> lock(recorder.mutex);
+            recorder.wake.wait(lock, [&] { return recorder.stopping || recorder.queuedCount > 0; });
+            if (recorder.queuedCount == 0) return;
+            slot = recorder.queuedSlots[recorder.queueHead];
+            recorder.queueHead = (recorder.queueHead + 1) % RECORD_SLOT_COUNT;
+            recorder.queuedCount--;
+        }
+
+        // yuv still holds the previous frame: it stands in for the periods nothing was recorded
+        uint32_t repeats = yuv.empty() ? 0 : recorder.slots[slot].gapBefore;
+        for (uint32_t i = 0; i < repeats; i++) {
+            std::fputs("FRAME\n", recorder.file);
+            std::fwrite(yuv.data(), 1, yuv.size(), recorder.file);
+        }
+        convertToI420(recorder.slots[slot].rgba.data(), recorder.width, recorder.height, yuv);
+        std::fputs("FRAME\n", recorder.file);
+        std::fwrite(yuv.data(), 1, yuv.size(), recorder.file);
+
+        {
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+            recorder.framesWritten += repeats + 1;
+            recorder.repeatedFrames += repeats;
+            recorder.bytesWritten += (repeats + 1) * (yuv.size() + 6);
+            recorder.freeSlots.push_back(slot);
+        }
+        recorder.slotFreed.notify_one();
+    }
+}
+
+// Copy a frame into a free slot and wake the encoder; false when every slot is still queued
+bool queueFrame(const void *rgba, uint32_t gapBefore) {
+    VideoRecorder &recorder = videoRecorder;
+    uint32_t slot;
+    {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        if (recorder.freeSlots.empty()) return false;
+        slot = recorder.freeSlots.back();
+        recorder.freeSlots.pop_back();
+    }
+
+    std::memcpy(recorder.slots[slot].rgba.data(), rgba, recorder.slots[slot].rgba.size());
+    recorder.slots[slot].gapBefore = gapBefore;
+
+    {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        recorder.queuedSlots[(recorder.queueHead + recorder.queuedCount) % RECORD_SLOT_COUNT] = slot;
+        recorder.queuedCount++;
+    }
+    recorder.wake.notify_one();
+    return true;
+}
+
+// Hand the oldest in-flight readback to the encoder once its fence has signaled (or always, with wait)
+// A finished readback stays in its buffer while the encoder has no free slot
+bool resolveOldestReadback(bool wait) {
+    VideoRecorder &recorder = videoRecorder;
+    if (recorder.pboCount == 0) return false;
+    {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        if (recorder.freeSlots.empty()) return false;
+    }
+
+    uint32_t oldest = (recorder.pboHead + RECORD_PBO_COUNT - recorder.pboCount) % RECORD_PBO_COUNT;
+    GLenum status = glClientWaitSync(recorder.fences[oldest], wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                     wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+
+    glDeleteSync(recorder.fences[oldest]);
+    recorder.fences[oldest] = nullptr;
+    recorder.pboCount--;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, recorder.pbos[oldest]);
+    size_t bytes = static_cast<size_t>(recorder.width) * recorder.height * 4;
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (!pixels || !queueFrame(pixels, recorder.pboGaps[oldest])) {
+        // The periods this frame and its gap covered fall to the next frame that makes it
+        recorder.droppedFrames++;
+        recorder.periodsCovered -= recorder.pboGaps[oldest] + 1;
+    }
+    if (pixels) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+}
+
+/**
+ * startVideoRecording: Open a Y4M file and start the encoder thread
+ */
+bool startVideoRecording(const std::string &path, int width, int height) {
+    MemoryScope scope(MEMORY_RECORDER);
+    VideoRecorder &recorder = videoRecorder;
+    recorder.file = std::fopen(path.c_str(), "wb");
+    if (!recorder.file) {
+        std::cerr << "Cannot open recording file: " << path << std::endl;
+        return false;
+    }
+    recorder.writeBuffer.resize(writeBufferBytes);
+    std::setvbuf(recorder.file, recorder.writeBuffer.data(), _IOFBF, recorder.writeBuffer.size());
+    std::fprintf(recorder.file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420 XCOLORRANGE=LIMITED\n", width, height, recordFps);
+
+    recorder.width = width;
+    recorder.height = height;
+    recorder.freeSlots.clear();
+    recorder.queueHead = 0;
+    recorder.queuedCount = 0;
+    for (uint32_t i = 0; i < RECORD_SLOT_COUNT; i++) {
+        recorder.slots[i].rgba.assign(static_cast<size_t>(width) * height * 4, 0);
+        recorder.freeSlots.push_back(i);
+    }
+
+    if (renderer.backend == BACKEND_OPENGL) {
+        glGenBuffers(RECORD_PBO_COUNT, recorder.pbos);
+        for (GLuint pbo : recorder.pbos) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<size_t>(width) * height * 4, nullptr, GL_STREAM_READ);
+            trackGpuMemory(GPU_BUFFER, pbo, MEMORY_RECORDER, static_cast<size_t>(width) * height * 4);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    recorder.stopping = false;
+    recorder.active = true;
+    recorder.encoder = std::thread(encoderLoop);
+    std::cout << "Recording " << width << "x" << height << " Y4M to " << path << " (" << RECORD_PBO_COUNT
+              << " readback buffers, " << RECORD_SLOT_COUNT << " encoder slots)" << std::endl;
+    return true;
+}
+
+/**
+ * recordVideoFrame: Queue the finished frame for recording (call after endFrame, before swapping)
+ * time is the frame's clock in seconds (the sim clock in fixed-step runs). A frame is recorded only when a new 1/recordFps
+ * period has started since the last recorded one; periods that passed without one (a slow or dropped
+ * frame) repeat the previous frame, so the video keeps the session's pace. Readbacks that have
+ * completed move on to the encoder first, then this frame's readback is issued.
+ */
+void recordVideoFrame(double time) {
+    VideoRecorder &recorder = videoRecorder;
+    if (!recorder.active) return;
+
+    if (renderer.backend == BACKEND_OPENGL) while (resolveOldestReadback(false)) {}
+
+    if (!recorder.clockStarted) {
+        recorder.startTime = time;
+        recorder.clockStarted = true;
+    }
+    uint64_t periods = static_cast<uint64_t>(std::max(time - recorder.startTime, 0.0) * recordFps) + 1;
+    if (periods <= recorder.periodsCovered) return;
+    uint32_t gap = static_cast<uint32_t>(periods - recorder.periodsCovered - 1);
+
+    if (renderer.backend == BACKEND_SOFTWARE) {
+        if (queueFrame(softwareRenderer.color.data(), gap)) {
+            recorder.periodsCovered = periods;
+        } else {
+            recorder.droppedFrames++;
+        }
+        return;
+    }
+
+    if (recorder.pboCount == RECORD_PBO_COUNT) {
+        recorder.droppedFrames++;
+        return;
+    }
+
+    uint32_t index = recorder.pboHead;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, recorder.pbos[index]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, recorder.width, recorder.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    recorder.fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    recorder.pboGaps[index] = gap;
+    recorder.periodsCovered = periods;
+    recorder.pboHead = (recorder.pboHead + 1) % RECORD_PBO_COUNT;
+    recorder.pboCount++;
+}
+
+/**
+ * stopVideoRecording: Drain outstanding readbacks, finish encoding and report written and dropped frames
+ */
+void stopVideoRecording() {
+    VideoRecorder &recorder = videoRecorder;
+    if (!recorder.active) return;
+
+    // Frames still in flight are kept: wait for the encoder to free a slot for each of them
+    while (recorder.pboCount > 0) {
+        {
+            std::unique_lock<std::mutex> lock(recorder.mutex);
+            recorder.slotFreed.wait(lock, [&] { return !recorder.freeSlots.empty(); });
+        }
+        resolveOldestReadback(true);
+    }
+    for (GLuint pbo : recorder.pbos) releaseGpuMemory(GPU_BUFFER, pbo);
+    if (recorder.pbos[0]) glDeleteBuffers(RECORD_PBO_COUNT, recorder.pbos);
+
+    {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        recorder.stopping = true;
+    }
+    recorder.wake.notify_all();
+    recorder.encoder.join();
+    std::fclose(recorder.file);
+
+    std::cout << "Recording: " << recorder.framesWritten << " frames written ("
+              << recorder.bytesWritten / (1024 * 1024) << " MB, " << recorder.repeatedFrames
+              << " repeating the previous frame to keep real time), " << recorder.droppedFrames
+              << " dropped while the readback buffers and encoder were busy" << std::endl;
+    recorder.file = nullptr;
+    recorder.writeBuffer.clear();
+    recorder.clockStarted = false;
+    recorder.periodsCovered = 0;
+    std::fill(recorder.pbos, recorder.pbos + RECORD_PBO_COUNT, 0);
+    recorder.active = false;
+}
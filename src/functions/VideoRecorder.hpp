@@ -0,0 +1,63 @@
+#ifndef VIDEO_RECORDER_HPP
+#define VIDEO_RECORDER_HPP
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int RECORD_PBO_COUNT = 4;
+const int RECORD_SLOT_COUNT = 4;
+
+// Bottom-up RGBA copy of one frame waiting for the encoder thread, and how many recording periods went
+// by without a frame before it (the encoder repeats the previous frame for those)
+struct VideoFrameSlot {
+    std::vector<uint8_t> rgba;
+    uint32_t gapBefore = 0;
+};
+
+// Session recorder: a ring of pixel pack buffers feeds frame slots that a background thread converts
+// to Y4M (I420) and writes through a large stdio buffer. When the ring or the slots are all busy the
+// frame is dropped and counted; the render loop never waits for readback or disk. Frames are picked by
+// their presentation time, one per recording period, so the video plays back at the session's pace.
+struct VideoRecorder {
+    std::FILE *file = nullptr;
+    std::vector<char> writeBuffer;
+    int width = 0, height = 0;
+    GLuint pbos[RECORD_PBO_COUNT] = {};
+    GLsync fences[RECORD_PBO_COUNT] = {};
+    uint32_t pboHead = 0;
+    uint32_t pboCount = 0;
+    uint32_t pboGaps[RECORD_PBO_COUNT] = {};
+    bool clockStarted = false;
+    double startTime = 0.0;
+    uint64_t periodsCovered = 0;
+    VideoFrameSlot slots[RECORD_SLOT_COUNT];
+    std::vector<uint32_t> freeSlots;
+    // Slots waiting for the encoder, oldest at queueHead; a slot is queued at most once, so this never overflows
+    uint32_t queuedSlots[RECORD_SLOT_COUNT] = {};
+    uint32_t queueHead = 0;
+    uint32_t queuedCount = 0;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable slotFreed;
+    std::thread encoder;
+    bool stopping = false;
+    bool active = false;
+    uint64_t framesWritten = 0;
+    uint64_t droppedFrames = 0;
+    uint64_t repeatedFrames = 0;
+    uint64_t bytesWritten = 0;
+};
+
+extern VideoRecorder videoRecorder;
+
+bool startVideoRecording(const std::string &path, int width, int height);
+void recordVideoFrame(double time);
+void stopVideoRecording();
+
+#endif
@@ -0,0 +1,109 @@
+#include "WorldGen.hpp"
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const uint64_t goldenGamma = 0x9e3779b97f4a7c15ull;
+const uint32_t fieldsPerCube = 7;
+const uint32_t benchmarkCubesPerRegion = 4096;
+
+// SplitMix64 finalizer: a bijective mix, so distinct counters never collide within a key
+uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Uniform integer in [0, range) from the top 32 bits, without a division
+uint32_t randomBelow(uint64_t random, uint32_t range) {
+    return static_cast<uint32_t>(((random >> 32) * range) >> 32);
+}
+
+}
+
+/**
+ * regionKey: Pack a region's grid coordinates into the key worldRandom is indexed by
+ */
+uint64_t regionKey(int32_t regionX, int32_t regionZ) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(regionX)) << 32) | static_cast<uint32_t>(regionZ);
+}
+
+/**
+ * worldRandom: The counter-th 64-bit random value of a region for a world seed
+ */
+uint64_t worldRandom(uint32_t seed, uint64_t region, uint64_t counter) {
+    uint64_t key = mix64(mix64(seed + goldenGamma) ^ (region * goldenGamma));
+    return mix64(key + (counter + 1) * goldenGamma);
+}
+
+/**
+ * generateRegionCubes: Fill count cubes scattered over one square world region
+ * Positions keep the half-unit grid and colors the palette of the original rand() generator.
+ */
+void generateRegionCubes(uint32_t seed, int32_t regionX, int32_t regionZ, uint32_t count, Cube *cubes) {
+    uint64_t region = regionKey(regionX, regionZ);
+    float originX = regionX * WORLD_REGION_SIZE, originZ = regionZ * WORLD_REGION_SIZE;
+    uint32_t gridSteps = static_cast<uint32_t>(WORLD_REGION_SIZE * 2.0f);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t counter = static_cast<uint64_t>(i) * fieldsPerCube;
+        Cube &cube = cubes[i];
+        cube.x = originX + randomBelow(worldRandom(seed, region, counter + 0), gridSteps) * 0.5f;
+        cube.y = (randomBelow(worldRandom(seed, region, counter + 1), 40) + 2) * 0.3f;
+        cube.z = originZ + randomBelow(worldRandom(seed, region, counter + 2), gridSteps) * 0.5f;
+        cube.size = 0.3f + randomBelow(worldRandom(seed, region, counter + 3), 15) * 0.1f;
+        cube.r = 0.4f + randomBelow(worldRandom(seed, region, counter + 4), 60) * 0.01f;
+        cube.g = 0.4f + randomBelow(worldRandom(seed, region, counter + 5), 60) * 0.01f;
+        cube.b = 0.4f + randomBelow(worldRandom(seed, region, counter + 6), 60) * 0.01f;
+    }
+}
+
+/**
+ * generateRegionGrid: Generate the square of regions [minRegion, maxRegion]^2, one region per parallelFor job
+ * Cubes are stored region by region in row order, so the result does not depend on the thread count.
+ */
+void generateRegionGrid(uint32_t seed, int32_t minRegion, int32_t maxRegion, uint32_t cubesPerRegion,
+                        std::vector<Cube> &cubes) {
+    uint32_t side = static_cast<uint32_t>(maxRegion - minRegion + 1);
+    cubes.resize(static_cast<size_t>(side) * side * cubesPerRegion);
+    parallelFor(side * side, [&](uint32_t index) {
+        int32_t regionX = minRegion + static_cast<int32_t>(index % side);
+        int32_t regionZ = minRegion + static_cast<int32_t>(index / side);
+        generateRegionCubes(seed, regionX, regionZ, cubesPerRegion, cubes.data() + static_cast<size_t>(index) * cubesPerRegion);
+    });
+}
+
+/**
+ * runWorldGenBenchmark: Time generating cubeCount cubes on one thread and on the pool, and check they match
+ */
+void runWorldGenBenchmark(uint32_t seed, uint32_t cubeCount) {
+    uint32_t regions = (cubeCount + benchmarkCubesPerRegion - 1) / benchmarkCubesPerRegion;
+    int32_t side = static_cast<int32_t>(std::ceil(std::sqrt(static_cast<double>(regions))));
+    int32_t minRegion = -side / 2, maxRegion = minRegion + side - 1;
+    size_t total = static_cast<size_t>(side) * side * benchmarkCubesPerRegion;
+
+    std::vector<Cube> serial(total), parallel;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t index = 0; index < side * side; index++) {
+        generateRegionCubes(seed, minRegion + index % side, minRegion + index / side, benchmarkCubesPerRegion,
+                            serial.data() + static_cast<size_t>(index) * benchmarkCubesPerRegion);
+    }
+    double serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    generateRegionGrid(seed, minRegion, maxRegion, benchmarkCubesPerRegion, parallel);
+    double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bool identical = parallel.size() == serial.size()
+                  && std::memcmp(parallel.data(), serial.data(), total * sizeof(Cube)) == 0;
+    std::cout << "World generation: " << total << " cubes in " << side * side << " regions (seed " << seed << ")\n"
+              << "  1 thread:   " << serialMs << " ms (" << total / (serialMs * 1000.0) << " M cubes/s)\n"
+              << "  " << threadPoolSize() << " threads: " << parallelMs << " ms (" << total / (parallelMs * 1000.0)
+              << " M cubes/s)\n"
+              << "  parallel output " << (identical ? "identical to" : "DIFFERS from") << " the serial output"
+              << std::endl;
+}
@@ -0,0 +1,22 @@
+#ifndef WORLD_GEN_HPP
+#define WORLD_GEN_HPP
+
+#include <cstdint>
+#include <vector>
+#include "MainFunctions.hpp"
+
+const float WORLD_REGION_SIZE = 25.0f;
+const int32_t REFERENCE_REGION_MIN = -2;
+const int32_t REFERENCE_REGION_MAX = 1;
+const uint32_t REFERENCE_CUBES_PER_REGION = 5;
+
+// Counter-based world randomness: every value is a pure function of (seed, region, counter), so regions
+// can be generated in any order, on any thread, and always come out the same
+uint64_t regionKey(int32_t regionX, int32_t regionZ);
+uint64_t worldRandom(uint32_t seed, uint64_t region, uint64_t counter);
+void generateRegionCubes(uint32_t seed, int32_t regionX, int32_t regionZ, uint32_t count, Cube *cubes);
+void generateRegionGrid(uint32_t seed, int32_t minRegion, int32_t maxRegion, uint32_t cubesPerRegion,
+                        std::vector<Cube> &cubes);
+void runWorldGenBenchmark(uint32_t seed, uint32_t cubeCount);
+
+#endif
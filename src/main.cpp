@@ -1,89 +1,389 @@
-#include <GLFW/glfw3.h>
-#include <iostream>
 #include "functions/MainFunctions.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <future>
+#include <iostream>
+#include "functions/TextureCache.hpp"
+#include "functions/Mesh.hpp"
+#include "functions/Renderer.hpp"
+#include "functions/Stats.hpp"
+#include "functions/ThreadPool.hpp"
+#include "functions/SoftwareOcclusion.hpp"
+#include "functions/Options.hpp"
+#include "functions/Benchmark.hpp"
+#include "functions/Capture.hpp"
+#include "functions/VideoRecorder.hpp"
+#include "functions/FlightRecorder.hpp"
+#include "functions/Replay.hpp"
+#include "functions/Rewind.hpp"
+#include "functions/WorldGen.hpp"
+#include "functions/Startup.hpp"
+#include "functions/Log.hpp"
+#include "functions/FrameMemory.hpp"
+#include "functions/Terrain.hpp"
+#include "functions/AssetPack.hpp"
+#include "functions/HotReload.hpp"
+#include "functions/FramePacing.hpp"
 
-int main() {
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-        return -1;
+int main(int argc, char **argv) {
+    beginStartupTimeline();
+    if (!parseOptions(argc, argv, options)) return -1;
+    if (options.showHelp) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    startLogger();
+    spawnPlayerPlane();
+
+    if (options.worldGenBenchmark > 0) {
+        startThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        runWorldGenBenchmark(options.seedSet ? options.seed : BENCHMARK_WORLD_SEED, options.worldGenBenchmark);
+        stopThreadPool();
+        return 0;
+    }
+    if (options.ecsBenchmark > 0) {
+        startThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        runEcsBenchmark(options.ecsBenchmark);
+        stopThreadPool();
+        return 0;
     }
+    if (options.logBenchmark > 0) {
+        runLogBenchmark(options.logBenchmark);
+        return 0;
+    }
+    if (options.rewindCheck) {
+        startThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        bool passed = runRewindCheck(options.seedSet ? options.seed : BENCHMARK_WORLD_SEED);
+        stopThreadPool();
+        return passed ? 0 : 1;
+    }
+    if (!options.packAssetsPath.empty()) return buildAssetPack(options.packAssetsPath, assetRootDir) ? 0 : 1;
+    if (!options.assetPackPath.empty() && !openAssetPack(options.assetPackPath)) return -1;
+
+    // Replays load before any window opens; --no-render re-simulates without one
+    bool replaying = !options.replayPath.empty();
+    if (replaying) {
+        if (options.noRender) return runHeadlessReplay(options.replayPath, options.seekTick) ? 0 : 1;
+        if (!startFlightReplay(options.replayPath, options.seekTick)) return -1;
+    }
+
+    // The software backend runs headless: no window, no GL context, fixed time step
+    RenderBackend backend = options.softwareRenderer ? BACKEND_SOFTWARE : BACKEND_OPENGL;
+
+    // The flight model always steps at SIM_TICKS_PER_SECOND; fixedStep runs one tick per frame instead of
+    // following the clock, and scripted runs fly the benchmark path (a replay flies it if the recording did)
+    const float fixedDeltaTime = 1.0f / SIM_TICKS_PER_SECOND;
+    const uint32_t maxTicksPerFrame = 8;
+    bool fixedStep = options.benchmark || backend == BACKEND_SOFTWARE || !options.captureFrames.empty() || replaying;
+    bool scripted = replaying ? (flightReplay.info.flags & FLIGHT_LOG_SCRIPTED) != 0 : fixedStep;
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    unsigned worldSeed = replaying ? flightReplay.info.worldSeed
+                       : options.seedSet ? options.seed
+                       : fixedStep ? BENCHMARK_WORLD_SEED : static_cast<unsigned>(time(0));
 
-    GLFWwindow* window = createWindow(800, 800, "Flight Simulator");
+    startThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
 
-    if (!window) return -1;
+    // Mesh parsing, texture decoding and world generation run on their own threads while this thread
+    // creates the window and the renderer; the GPU uploads happen here as each job is joined.
+    // The world job is the only parallelFor user, and the only one creating entities, until it has been joined.
+    const std::string planePath = "src/assets/plane/plane.obj";
+    const std::string planeTexturePath = "src/assets/plane/11804_Airplane_diff.jpg";
+    std::future<MeshData> meshJob = std::async(std::launch::async, [&]() {
+        double start = startupElapsedMs();
+        MeshData mesh = buildMeshData(loadObj(planePath));
+        recordStartupPhase("parse plane mesh", "mesh", start);
+        return mesh;
+    });
+    bool textureLoaded = false, textureFromCache = false;
+    double textureLoadMs = 0.0;
+    std::future<CompressedTexture> textureJob = std::async(std::launch::async, [&]() {
+        double start = startupElapsedMs();
+        CompressedTexture texture;
+        textureLoaded = loadCompressedTexture(planeTexturePath, texture, textureFromCache);
+        textureLoadMs = startupElapsedMs() - start;
+        recordStartupPhase("load plane texture", "texture", start);
+        return texture;
+    });
+    std::future<void> worldJob = std::async(std::launch::async, [&]() {
+        double start = startupElapsedMs();
+        generateReferenceCubes(worldSeed);
+        recordStartupPhase("generate world", "world", start);
+    });
+    auto abandonStartup = [&]() {
+        if (meshJob.valid()) meshJob.wait();
+        if (textureJob.valid()) textureJob.wait();
+        if (worldJob.valid()) worldJob.wait();
+        stopThreadPool();
+    };
 
-    glfwSetKeyCallback(window, keyCallback);
-    glfwSetMouseButtonCallback(window, mouseButtonCallback);
-    glfwSetCursorPosCallback(window, cursorPosCallback);
+    GLFWwindow* window = nullptr;
+    if (backend == BACKEND_OPENGL) {
+        double start = startupElapsedMs();
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW" << std::endl;
+            abandonStartup();
+            return -1;
+        }
 
-    Model plane = loadObj("src/assets/plane/plane.obj");
+        applyContextHints();
 
-    if (plane.vertices.empty()) {
+        window = createWindow(options.width, options.height, "Flight Simulator");
+
+        if (!window) {
+            abandonStartup();
+            return -1;
+        }
+        recordStartupPhase("window + GL context", "main", start);
+    }
+
+    double rendererStart = startupElapsedMs();
+    if (!initRenderer(backend, options.width, options.height)) {
+        abandonStartup();
+        glfwTerminate();
+        return -1;
+    }
+
+    initSoftwareOcclusion();
+    recordStartupPhase("renderer setup", "main", rendererStart);
+
+    if (window) {
+        glfwSetKeyCallback(window, keyCallback);
+        glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetCursorPosCallback(window, cursorPosCallback);
+    }
+
+    MeshData planeMesh = meshJob.get();
+
+    if (planeMesh.vertices.empty()) {
         std::cerr << "Model is empty! Check if plane.obj exists." << std::endl;
+        abandonStartup();
+        shutdownRenderer();
         glfwTerminate();
         return -1;
     }
 
-    generateReferenceCubes();
+    double uploadStart = startupElapsedMs();
+    GpuMesh planeGpu = createRenderMesh(planeMesh, usePackedVertices);
+    if (backend == BACKEND_OPENGL) logMeshLayout(planeMesh, planeGpu);
+    recordStartupPhase("upload plane mesh", "main", uploadStart);
+
+    CompressedTexture planeTextureData = textureJob.get();
+    uploadStart = startupElapsedMs();
+    Texture planeTexture = textureLoaded
+                         ? createRenderTexture(planeTexturePath, planeTextureData, textureFromCache, textureLoadMs)
+                         : Texture();
+    planeTextureData = CompressedTexture();
+    recordStartupPhase("upload plane texture", "main", uploadStart);
+
+    worldJob.get();
+    // A rewind would send the flight log ticks it has already written, out of order, so logging turns it off
+    if (!replaying && !options.flightLogPath.empty()) {
+        LOG_INFO("Rewind: off while --flight-log records");
+    } else if (!replaying) {
+        initRewindBuffer(options.rewindMinutes, scripted);
+    }
+
+    uploadStart = startupElapsedMs();
+    buildStaticWorld(planeMesh, planeTexture, backend == BACKEND_OPENGL);
+    recordStartupPhase("build static world", "main", uploadStart);
+
+    Mat4 projection = mat4Ortho(-2, 2, -2, 2, 0.1f, 100);
+
+    uint32_t frameLimit = options.frames;
+    if (frameLimit == 0 && !options.captureFrames.empty()) {
+        uint32_t lastCapture = *std::max_element(options.captureFrames.begin(), options.captureFrames.end());
+        frameLimit = lastCapture >= options.seekTick ? lastCapture - options.seekTick + 1 : 1;
+    }
+    if (frameLimit == 0 && fixedStep && !replaying) frameLimit = 300;
+
+    if (options.hotReload) {
+        watchMeshAsset(planePath, planeMesh, planeGpu);
+        watchTextureAsset(planeTexturePath, planeTexture);
+    }
 
-    glEnable(GL_DEPTH_TEST);
+    int framebufferWidth = options.width, framebufferHeight = options.height;
+    if (window) glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    if (!initFrameCapture(options, framebufferWidth, framebufferHeight)
+        || (!options.recordPath.empty() && !startVideoRecording(options.recordPath, framebufferWidth, framebufferHeight))
+        || (!options.flightLogPath.empty()
+            && !startFlightRecorder(options.flightLogPath, {worldSeed, SIM_TICKS_PER_SECOND, scripted ? FLIGHT_LOG_SCRIPTED : 0}))
+        || (!options.terrainDir.empty()
+            && !initTerrain(options.terrainDir, options.terrainOriginSet, options.terrainLatitude,
+                            options.terrainLongitude, options.terrainScale))
+        || (options.hotReload && !startHotReload())) {
+        destroyTerrain();
+        stopVideoRecording();
+        stopFlightRecorder();
+        destroyStaticWorld();
+        destroyRenderMesh(planeGpu);
+        destroyRenderTexture(planeTexture);
+        shutdownRenderer();
+        stopThreadPool();
+        glfwTerminate();
+        return -1;
+    }
+    if (fixedStep) startBenchmark(backendName(backend), options.width, options.height, frameLimit);
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-2, 2, -2, 2, 0.1, 100);
-    glMatrixMode(GL_MODELVIEW);
+    // Scripted runs default to uncapped so the display never throttles them; --fps-limit alone implies limit
+    PacingMode pacingMode = fixedStep ? PACING_UNCAPPED : PACING_VSYNC;
+    if (!options.pacing.empty()) {
+        parsePacingMode(options.pacing, pacingMode);
+    } else if (options.fpsLimit > 0.0) {
+        pacingMode = PACING_LIMIT;
+    }
+    initFramePacing(pacingMode, options.fpsLimit, window);
 
-    double lastTime = glfwGetTime();
+    double lastTime = window ? glfwGetTime() : 0.0;
+    double simAccumulator = 0.0;
+    uint32_t tick = replaying ? options.seekTick : 0;
 
+    flushLog();
     std::cout << "\n=== Flight Simulator Controls ===" << std::endl;
     std::cout << "W/S: Increase/Decrease speed" << std::endl;
     std::cout << "A/D: Turn left/right (yaw)" << std::endl;
     std::cout << "Arrow Up/Down: Pitch up/down" << std::endl;
     std::cout << "Arrow Left/Right: Roll left/right" << std::endl;
     std::cout << "Mouse drag: Rotate view" << std::endl;
+    std::cout << "V: Toggle packed/float vertex format" << std::endl;
+    std::cout << "G: Toggle GPU/CPU static world culling" << std::endl;
+    std::cout << "O: Toggle occlusion culling (Hi-Z on the GPU, software depth on the CPU)" << std::endl;
+    std::cout << "F3: Toggle frame stats output" << std::endl;
     std::cout << "R: Reset camera and plane" << std::endl;
+    std::cout << "Backspace: Rewind " << REWIND_STEP_SECONDS << " seconds" << std::endl;
     std::cout << "ESC: Exit" << std::endl;
     std::cout << "================================\n" << std::endl;
 
-    while (!glfwWindowShouldClose(window)) {
-        double currentTime = glfwGetTime();
-        float deltaTime = static_cast<float>(currentTime - lastTime);
+    double firstFrameStart = startupElapsedMs();
+    for (uint32_t frame = 0; frameLimit == 0 || frame < frameLimit; frame++) {
+        // The limiter holds the frame before input is polled, so the simulation gets the freshest input
+        waitForFrameStart();
+        if (window) {
+            glfwPollEvents();
+            if (glfwWindowShouldClose(window)) break;
+        }
+        markInputSampled();
+
+        auto frameStart = std::chrono::steady_clock::now();
+        beginFrameMemory();
+        double currentTime = fixedStep ? frame * static_cast<double>(fixedDeltaTime) : glfwGetTime();
+        float deltaTime = fixedStep ? fixedDeltaTime : static_cast<float>(currentTime - lastTime);
         lastTime = currentTime;
 
-        updatePlaneControls(window, deltaTime);
+        resetFrameStats();
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+        // Interactive runs bank real time and spend it in whole ticks, dropping the backlog after a long stall
+        uint32_t ticks = 1;
+        if (!fixedStep) {
+            simAccumulator += deltaTime;
+            ticks = std::min(static_cast<uint32_t>(simAccumulator / fixedDeltaTime), maxTicksPerFrame);
+            simAccumulator = std::min(simAccumulator - ticks * fixedDeltaTime, static_cast<double>(fixedDeltaTime));
+        }
+        applyPendingRewind(tick);
+        bool replayEnded = false;
+        for (uint32_t i = 0; i < ticks; i++, tick++) {
+            uint32_t inputs = 0;
+            if (replaying) {
+                if (!nextReplayTick(tick, inputs)) {
+                    replayEnded = true;
+                    break;
+                }
+            } else {
+                inputs = readPlaneInputs(window);
+            }
+            recordRewindTick(tick, inputs);
+            if (scripted) scriptBenchmarkFrame(tick);
+            updatePlaneControls(inputs, fixedDeltaTime);
+            if (replaying) verifyReplayTick(planeState());
+            recordFlightTick(tick, inputs, planeState());
+        }
+        if (replayEnded) break;
 
-        glLoadIdentity();
-        glTranslatef(0.0f, 0.0f, -5.0f);
+        if (planeGpu.packed != usePackedVertices) {
+            destroyRenderMesh(planeGpu);
+            planeGpu = createRenderMesh(planeMesh, usePackedVertices);
+        }
+        if (applyAssetReloads()) updateStaticAircraft(planeMesh, planeTexture, backend == BACKEND_OPENGL);
 
         // Mouse Controls
-        glRotatef(camera.rotationX, 1.0f, 0.0f, 0.0f);
-        glRotatef(camera.rotationY, 0.0f, 1.0f, 0.0f);
+        Mat4 view = mat4Translate(0.0f, 0.0f, -5.0f)
+                  * mat4Rotate(camera.rotationX, 1.0f, 0.0f, 0.0f)
+                  * mat4Rotate(camera.rotationY, 0.0f, 1.0f, 0.0f);
+
+        beginFrame(projection, view);
+
+        // The static world is laid out in sector (0, 0, 0); one camera-relative origin places all of it
+        Mat4 worldOrigin = sectorToCamera(0, 0, 0);
+
+        renderGroundGrid(worldOrigin);
+
+        renderReferenceCubes(worldOrigin);
+
+        renderParkedAircraft(worldOrigin);
 
-        renderGroundGrid();
+        const PlaneState &plane = planeState();
+        modelStack.push();
+        modelStack.rotate(plane.rotX, 1.0f, 0.0f, 0.0f);
+        modelStack.rotate(plane.rotY, 0.0f, 1.0f, 0.0f);
+        modelStack.rotate(plane.rotZ, 0.0f, 0.0f, 1.0f);
 
-        renderReferenceCubes();
+        modelStack.rotate(-85.0f, 1.0f, 0.0f, 1.0f);
 
-        glRotatef(planeState.rotX, 1.0f, 0.0f, 0.0f);
-        glRotatef(planeState.rotY, 0.0f, 1.0f, 0.0f);
-        glRotatef(planeState.rotZ, 0.0f, 0.0f, 1.0f);
+        renderModel(planeGpu, planeTexture);
+        modelStack.pop();
 
-        glRotatef(-85.0f, 1.0f, 0.0f, 1.0f);
-        
-        glColor3f(1.0f, 1.0f, 1.0f);
-        
-        renderModel(plane);
+        endFrame();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Captures are numbered by sim tick, which is the frame number unless a replay seeked
+        if (fixedStep && captureRequested(tick - 1)) captureFrame(tick - 1);
+        recordVideoFrame(currentTime);
+
+        // Benchmark frames are timed up to finished rendering, excluding the swap and its vsync wait
+        if (fixedStep) {
+            if (window) glFinish();
+            recordBenchmarkFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+
+        processFrameCaptures(false);
+
+        endFrameMemory();
+        checkMemoryBudgets();
+        recordFrameStats(deltaTime * 1000.0);
+        reportStats(currentTime);
+
+        if (window) glfwSwapBuffers(window);
+        recordPresent();
+
+        if (frame == 0) {
+            recordStartupPhase("first frame", "main", firstFrameStart);
+            flushLog();
+            reportStartupTimeline();
+            logMemoryCheckpoint("first frame");
+        }
     }
 
+    reportSessionStats();
+    reportFramePacing();
+    reportRewindStats();
+    reportBenchmark();
+    bool allocationsOk = reportFrameMemory(options.allocCheck);
+    reportMemoryUsage();
+    if (!options.memoryReportPath.empty()) writeMemoryReport(options.memoryReportPath);
+    bool capturesMatch = finishFrameCapture();
+    stopVideoRecording();
+    stopFlightRecorder();
+    bool replayMatches = finishFlightReplay();
+
+    stopHotReload();
+    destroyTerrain();
+    destroyStaticWorld();
+    destroyRenderMesh(planeGpu);
+    destroyRenderTexture(planeTexture);
+    shutdownRenderer();
+    stopThreadPool();
     glfwTerminate();
+    closeAssetPack();
+    stopLogger();
 
-    return 0;
-}
\ No newline at end of file
+    return capturesMatch && replayMatches && allocationsOk ? 0 : 1;
+}